@@ -0,0 +1,37 @@
+#include "benchresults.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// every heap allocation in the benchmark goes through here, so they can be counted per ray
+// (operator new[] and the nothrow forms all call this one by default, and every form of operator delete is replaced to match)
+// this file has no code of its own that allocates, so GCC never inlines these into a container and pairs malloc and free with new and delete
+static std::atomic<uint64_t> allocationCount(0);
+
+void* operator new(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* pMemory = std::malloc((size > 0) ? size : 1);
+	if (pMemory == nullptr) throw std::bad_alloc();
+	return pMemory;
+}
+
+void operator delete(void* pMemory) noexcept {
+	std::free(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t) noexcept {
+	::operator delete(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept {
+	::operator delete(pMemory);
+}
+
+void operator delete[](void* pMemory, std::size_t) noexcept {
+	::operator delete(pMemory);
+}
+
+// function to return the number of heap allocations made so far
+uint64_t getAllocationCount() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
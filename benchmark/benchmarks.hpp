@@ -0,0 +1,21 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// BVH scaling, compares the hierarchy against a linear scan of every object
+void runBVHBenchmark();
+// primary ray throughput, compares packets of camera rays against casting them one at a time
+void runPacketBenchmark();
+// converting a 4K image for display, compares the old per-pixel conversion against the simd and multithreaded one
+void runDisplayBenchmark();
+// triangle meshes up to a million triangles, OBJ import and hierarchy build times and primary ray throughput
+void runMeshBenchmark();
+// instanced geometry, a forest of copies of one tree under a two level hierarchy
+void runInstanceBenchmark();
+// single functions in isolation: intersection tests, transforms, matrix inverses, camera rays and diffuse shading
+void runMicroBenchmark();
+// whole frames of standard scenes at several object counts, resolutions and thread counts
+void runFrameBenchmark();
+// depth of field and motion blur, the error against a converged frame at each sample count, with low discrepancy and with random samples
+void runConvergenceBenchmark();
+
+#endif
@@ -0,0 +1,82 @@
+#include "benchresults.hpp"
+#include <cstdio>
+#include "simd.hpp"
+#include "raypacket.hpp"
+#include "precision.hpp"
+
+// the results recorded so far
+static std::vector<benchresult> results;
+
+// function to keep a result
+void recordResult(const benchresult& result) {
+	results.push_back(result);
+}
+
+void recordResult(const char* benchmark, const std::string& name, const char* unit, const std::vector<std::pair<std::string, double>>& params, double nsPerOp) {
+	benchresult result;
+	result.m_benchmark = benchmark;
+	result.m_name = name;
+	result.m_unit = unit;
+	result.m_params = params;
+	result.m_nsPerOp = nsPerOp;
+	results.push_back(result);
+}
+
+// function to write a string as a JSON string (names are plain text, so only quotes and backslashes need escaping)
+static void writeString(FILE* pFile, const std::string& text) {
+	std::fputc('"', pFile);
+	for (char c : text) {
+		if ((c == '"') || (c == '\\')) std::fputc('\\', pFile);
+		std::fputc(c, pFile);
+	}
+	std::fputc('"', pFile);
+}
+
+// function to write every result to a JSON file
+bool writeResults(const std::string& fileName) {
+	FILE* pFile = std::fopen(fileName.c_str(), "w");
+	if (pFile == nullptr) return false;
+	// the build settings that change the numbers, so results from different builds aren't compared by mistake
+	std::fprintf(pFile, "{\n  \"format\": 1,\n  \"precision\": \"%s\",\n  \"simd_width\": %d,\n  \"packet_size\": %d,\n  \"results\": [", RT::getPrecisionName(), RT::simd4d::WIDTH, RT::PACKET_SIZE);
+	for (size_t i = 0; i < results.size(); i++) {
+		const benchresult& result = results[i];
+		std::fprintf(pFile, "%s\n    { \"benchmark\": ", (i > 0) ? "," : "");
+		writeString(pFile, result.m_benchmark);
+		std::fprintf(pFile, ", \"name\": ");
+		writeString(pFile, result.m_name);
+		std::fprintf(pFile, ", \"unit\": ");
+		writeString(pFile, result.m_unit);
+		std::fprintf(pFile, ", \"params\": {");
+		for (size_t j = 0; j < result.m_params.size(); j++) {
+			std::fprintf(pFile, "%s", (j > 0) ? ", " : " ");
+			writeString(pFile, result.m_params[j].first);
+			std::fprintf(pFile, ": %.17g", result.m_params[j].second);
+		}
+		std::fprintf(pFile, "%s}, \"ns_per_op\": %.6g, \"ops_per_sec\": %.6g, \"allocs_per_op\": ", result.m_params.empty() ? "" : " ", result.m_nsPerOp, (result.m_nsPerOp > 0.0) ? (1e9 / result.m_nsPerOp) : 0.0);
+		if (result.m_allocsPerOp < 0.0) std::fprintf(pFile, "null");
+		else std::fprintf(pFile, "%.6g", result.m_allocsPerOp);
+		if (result.m_error >= 0.0) std::fprintf(pFile, ", \"rms_error\": %.6g", result.m_error);
+		std::fprintf(pFile, " }");
+	}
+	std::fprintf(pFile, "\n  ]\n}\n");
+	return std::fclose(pFile) == 0;
+}
+
+// constructor
+benchtimer::benchtimer() {
+	m_startAllocations = getAllocationCount();
+	m_start = std::chrono::steady_clock::now();
+}
+
+// function to end the measurement
+void benchtimer::finish(int64_t numOps, benchresult& result) const {
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - m_start).count();
+	uint64_t allocations = getAllocationCount() - m_startAllocations;
+	result.m_nsPerOp = ns / static_cast<double>(numOps);
+	result.m_allocsPerOp = static_cast<double>(allocations) / static_cast<double>(numOps);
+}
+
+// function to return the time since the start
+double benchtimer::getSeconds() const {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+}
@@ -0,0 +1,49 @@
+#ifndef BENCHRESULTS_H
+#define BENCHRESULTS_H
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// one measurement, kept so that all of them can be written out as JSON at the end of the run
+struct benchresult {
+	// the benchmark that made it (as given on the command line) and what was measured
+	std::string m_benchmark;
+	std::string m_name;
+	// what one operation is ("ray", "call", "pixel", "frame", ...)
+	std::string m_unit;
+	// the settings it was measured with (object count, resolution, thread count, ...)
+	std::vector<std::pair<std::string, double>> m_params;
+	// nanoseconds per operation
+	double m_nsPerOp = 0.0;
+	// heap allocations per operation (negative if they weren't counted)
+	double m_allocsPerOp = -1.0;
+	// the rms difference of the image from a reference, for benchmarks of image quality (negative if it wasn't measured)
+	double m_error = -1.0;
+};
+
+// function to keep a result for writeResults
+void recordResult(const benchresult& result);
+// function to keep a result that was timed without counting allocations
+void recordResult(const char* benchmark, const std::string& name, const char* unit, const std::vector<std::pair<std::string, double>>& params, double nsPerOp);
+// function to write every result recorded so far to a JSON file, returns false if it can't be written
+bool writeResults(const std::string& fileName);
+// function to return the number of heap allocations made so far, in any thread (counted by the benchmark's operator new)
+uint64_t getAllocationCount();
+
+// measures the time and the heap allocations from its construction to finish()
+class benchtimer {
+	public:
+		// constructor, starts the measurement
+		benchtimer();
+		// function to end the measurement, and fill in the time and allocations per operation of result
+		void finish(int64_t numOps, benchresult& result) const;
+		// function to return the time since the start in seconds
+		double getSeconds() const;
+	private:
+		std::chrono::steady_clock::time_point m_start;
+		uint64_t m_startAllocations;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "benchmarks.hpp"
+#include "benchresults.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <memory>
+#include <vector>
+#include "bvh.hpp"
+#include "objsphere.hpp"
+
+// function to create numSpheres randomly placed spheres
+// the volume they fill is fixed and the radius shrinks with the count, so the fraction of space covered stays the same
+static std::vector<std::shared_ptr<RT::objectbase>> makeSpheres(int numSpheres, std::mt19937& rng) {
+	std::uniform_real_distribution<double> position(-10.0, 10.0);
+	RT::real radius = static_cast<RT::real>(10.0 * cbrt(0.05 / numSpheres));
+	std::vector<std::shared_ptr<RT::objectbase>> objectList;
+	for (int i = 0; i < numSpheres; i++) {
+		auto sphere = std::make_shared<RT::objsphere>();
+		RT::GTform sphereMatrix;
+		RT::real x = static_cast<RT::real>(position(rng));
+		RT::real y = static_cast<RT::real>(position(rng));
+		RT::real z = static_cast<RT::real>(position(rng));
+		sphereMatrix.setTransform(Vec3{ x, y, z }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ radius, radius, radius });
+		sphere->setTransformMatrix(sphereMatrix);
+		objectList.push_back(sphere);
+	}
+	return objectList;
+}
+
+// function to create rays from outside the volume towards random points inside it
+static std::vector<RT::ray> makeRays(int numRays, std::mt19937& rng) {
+	std::uniform_real_distribution<double> position(-10.0, 10.0);
+	std::uniform_real_distribution<double> angle(0.0, 6.283185307179586);
+	std::vector<RT::ray> rays;
+	for (int i = 0; i < numRays; i++) {
+		double theta = angle(rng);
+		Vec3 origin{ static_cast<RT::real>(30.0 * cos(theta)), static_cast<RT::real>(30.0 * sin(theta)), static_cast<RT::real>(position(rng)) };
+		RT::real x = static_cast<RT::real>(position(rng));
+		RT::real y = static_cast<RT::real>(position(rng));
+		RT::real z = static_cast<RT::real>(position(rng));
+		Vec3 target{ x, y, z };
+		rays.push_back(RT::ray(origin, target));
+	}
+	return rays;
+}
+
+// closest hit by testing every object, as scene::castRay did before the hierarchy existed
+static bool castLinear(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const RT::ray& castRay) {
+	Vec3 intPoint, localNormal, localColor;
+	double minDist = 1e6;
+	bool intersectionFound = false;
+	for (const auto& currentObject : objectList) {
+		if (currentObject->testIntersections(castRay, intPoint, localNormal, localColor)) {
+			double dist = (intPoint - castRay.m_point1).norm();
+			if (dist < minDist) {
+				minDist = dist;
+				intersectionFound = true;
+			}
+		}
+	}
+	return intersectionFound;
+}
+
+void runBVHBenchmark() {
+	const int numRays = 20000;
+	const int maxLinearObjects = 10000; // the linear scan takes too long beyond this
+	std::printf("%10s %10s %8s %6s %14s %14s %8s\n", "objects", "build ms", "nodes", "depth", "bvh ns/ray", "linear ns/ray", "hits");
+	for (int numObjects = 10; numObjects <= 100000; numObjects *= 10) {
+		std::mt19937 rng(1234);
+		auto objectList = makeSpheres(numObjects, rng);
+		auto rays = makeRays(numRays, rng);
+		// build
+		RT::bvh objectBVH;
+		auto start = std::chrono::steady_clock::now();
+		objectBVH.build(objectList);
+		double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		// trace with the hierarchy
+		std::shared_ptr<RT::objectbase> closestObject;
+		Vec3 intPoint, localNormal, localColor;
+		int bvhHits = 0;
+		start = std::chrono::steady_clock::now();
+		for (const auto& castRay : rays) {
+			if (objectBVH.castRay(castRay, nullptr, closestObject, intPoint, localNormal, localColor)) bvhHits++;
+		}
+		double bvhNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numRays;
+		// trace with a linear scan (and check that both agree on which rays hit something)
+		double linearNs = 0.0;
+		if (numObjects <= maxLinearObjects) {
+			int linearHits = 0;
+			start = std::chrono::steady_clock::now();
+			for (const auto& castRay : rays) {
+				if (castLinear(objectList, castRay)) linearHits++;
+			}
+			linearNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numRays;
+			if (linearHits != bvhHits) std::printf("warning: linear scan found %d hits, bvh found %d\n", linearHits, bvhHits);
+		}
+		recordResult("bvh", "bvh castRay", "ray", { { "objects", numObjects } }, bvhNs);
+		if (linearNs > 0.0) recordResult("bvh", "linear castRay", "ray", { { "objects", numObjects } }, linearNs);
+		std::printf("%10d %10.2f %8d %6d %14.1f ", numObjects, buildMs, objectBVH.getNodeCount(), objectBVH.getDepth(), bvhNs);
+		if (linearNs > 0.0) std::printf("%14.1f", linearNs);
+		else std::printf("%14s", "-");
+		std::printf(" %8d\n", bvhHits);
+	}
+}
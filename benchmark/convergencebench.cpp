@@ -0,0 +1,102 @@
+#include "benchmarks.hpp"
+#include "benchresults.hpp"
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include "image.hpp"
+#include "scene.hpp"
+
+// the size of the frames, and the number of samples per pixel of the reference they are compared with
+constexpr int CONVERGENCE_WIDTH = 128;
+constexpr int CONVERGENCE_HEIGHT = 72;
+constexpr int CONVERGENCE_REFERENCE_SAMPLES = 1024;
+
+// function to write the test scene with depth of field (focused on the middle sphere) and two spheres moving while the shutter is open
+static bool writeLensScene(const char* fileName) {
+	FILE* pFile = std::fopen(fileName, "w");
+	if (pFile == nullptr) return false;
+	std::fprintf(pFile, "camera position 0 -10 -1 lookat 0 0 0 up 0 0 1 horzsize 0.25 aspect 1.7777777777777777 aperture 0.15 focus 10.05 shutter 0 1\n");
+	std::fprintf(pFile, "material blue color 0.25 0.5 0.8 reflectivity 0.1 shininess 10\n");
+	std::fprintf(pFile, "material orange color 1.0 0.5 0.0 reflectivity 0.75 shininess 10\n");
+	std::fprintf(pFile, "material yellow color 1.0 0.8 0.0 reflectivity 0.25 shininess 10\n");
+	std::fprintf(pFile, "material floor color 1.0 1.0 1.0 reflectivity 0.5 shininess 0\n");
+	std::fprintf(pFile, "sphere translate -1.5 -2 0 scale 0.5 0.5 0.5 color 0.25 0.5 0.8 material yellow motion translate -1.5 -2 -0.4\n");
+	std::fprintf(pFile, "sphere translate 0 0 0 scale 0.5 0.5 0.5 color 1.0 0.5 0.0 material blue\n");
+	std::fprintf(pFile, "sphere translate 1.5 2 0 scale 0.5 0.5 0.5 color 1.0 0.8 0.0 material orange motion translate 2.0 2 0\n");
+	std::fprintf(pFile, "plane translate 0 0 0.75 scale 4 4 1 color 0.5 0.5 0.5 material floor\n");
+	std::fprintf(pFile, "pointlight position 5 -10 -5 color 0 0 1\npointlight position -5 -10 -5 color 1 0 0\npointlight position 0 -10 -5 color 0 1 0\n");
+	return std::fclose(pFile) == 0;
+}
+
+// function to render the scene with exactly numSamples samples in every pixel
+static void renderWithSamples(RT::scene& testScene, int numSamples, bool lowDiscrepancy, image& outputImage) {
+	RT::renderconfig config = testScene.getRenderConfig();
+	config.m_minSamples = numSamples;
+	config.m_maxSamples = numSamples;
+	config.m_varianceThreshold = 0.0;
+	config.m_lowDiscrepancy = lowDiscrepancy;
+	config.m_reportProgress = false;
+	testScene.setRenderConfig(config);
+	outputImage.initialize(CONVERGENCE_WIDTH, CONVERGENCE_HEIGHT);
+	testScene.render(outputImage);
+}
+
+// function to return the rms difference of the colors of two images of the same size
+static double rmsDifference(const image& rendered, const image& reference) {
+	double sumSquares = 0.0;
+	for (int y = 0; y < rendered.getYSize(); y++) {
+		const float* pRendered = rendered.getRow(y);
+		const float* pReference = reference.getRow(y);
+		for (int x = 0; x < rendered.getXSize(); x++) {
+			for (int c = 0; c < 3; c++) {
+				double diff = static_cast<double>(pRendered[(x * image::NUM_CHANNELS) + c]) - pReference[(x * image::NUM_CHANNELS) + c];
+				sumSquares += diff * diff;
+			}
+		}
+	}
+	return std::sqrt(sumSquares / (3.0 * rendered.getXSize() * rendered.getYSize()));
+}
+
+void runConvergenceBenchmark() {
+	const char* fileName = "convergencebench.scene";
+	if (!writeLensScene(fileName)) {
+		std::printf("could not write %s\n", fileName);
+		return;
+	}
+	RT::scene lensScene;
+	bool loaded = true;
+	try {
+		lensScene.loadFile(fileName);
+	}
+	catch (const std::exception& error) {
+		std::printf("%s\n", error.what());
+		loaded = false;
+	}
+	std::remove(fileName);
+	std::remove((std::string(fileName) + ".cache").c_str());
+	// without the lens and motion scene the default scene would be measured under this benchmark's name
+	if (!loaded) return;
+	std::printf("depth of field and motion blur at %d x %d, the error is the rms difference from %d samples per pixel\n", CONVERGENCE_WIDTH, CONVERGENCE_HEIGHT, CONVERGENCE_REFERENCE_SAMPLES);
+	image referenceImage;
+	renderWithSamples(lensScene, CONVERGENCE_REFERENCE_SAMPLES, true, referenceImage);
+	std::printf("%-10s %8s %12s %14s %12s\n", "sampler", "samples", "ms/frame", "ns/sample", "rms error");
+	// the sample counts are squares, as the first round of samples of each pixel is a square grid
+	for (int numSamples = 4; numSamples <= 256; numSamples *= 4) {
+		for (int lowDiscrepancy = 1; lowDiscrepancy >= 0; lowDiscrepancy--) {
+			image outputImage;
+			benchtimer timer;
+			renderWithSamples(lensScene, numSamples, lowDiscrepancy != 0, outputImage);
+			int64_t numPixelSamples = static_cast<int64_t>(CONVERGENCE_WIDTH) * CONVERGENCE_HEIGHT * numSamples;
+			benchresult result;
+			timer.finish(numPixelSamples, result);
+			result.m_benchmark = "convergence";
+			result.m_name = lowDiscrepancy ? "lens and motion sobol" : "lens and motion random";
+			result.m_unit = "sample";
+			result.m_params = { { "width", CONVERGENCE_WIDTH }, { "height", CONVERGENCE_HEIGHT }, { "samples", numSamples }, { "low discrepancy", lowDiscrepancy } };
+			result.m_error = rmsDifference(outputImage, referenceImage);
+			recordResult(result);
+			std::printf("%-10s %8d %12.1f %14.1f %12.6f\n", lowDiscrepancy ? "sobol" : "random", numSamples, result.m_nsPerOp * numPixelSamples / 1e6, result.m_nsPerOp, result.m_error);
+		}
+	}
+}
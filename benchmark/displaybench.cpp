@@ -0,0 +1,83 @@
+#include "benchmarks.hpp"
+#include "benchresults.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "image.hpp"
+#include "threadpool.hpp"
+
+// the conversion the viewer used to do: column-major double channels, the maximum found with bounds checked accesses,
+// and a freshly allocated pixel buffer filled one pixel at a time
+static void convertReference(const std::vector<std::vector<double>>& rChannel, const std::vector<std::vector<double>>& gChannel, const std::vector<std::vector<double>>& bChannel, int xSize, int ySize, std::vector<uint32_t>& output) {
+	double maxRed = 0.0, maxGreen = 0.0, maxBlue = 0.0, overallMax = 0.0;
+	for (int x = 0; x < xSize; x++) {
+		for (int y = 0; y < ySize; y++) {
+			if (rChannel.at(x).at(y) > maxRed) maxRed = rChannel.at(x).at(y);
+			if (gChannel.at(x).at(y) > maxGreen) maxGreen = gChannel.at(x).at(y);
+			if (bChannel.at(x).at(y) > maxBlue) maxBlue = bChannel.at(x).at(y);
+			if (maxRed > overallMax) overallMax = maxRed;
+			if (maxGreen > overallMax) overallMax = maxGreen;
+			if (maxBlue > overallMax) overallMax = maxBlue;
+		}
+	}
+	uint32_t* tempPixels = new uint32_t[xSize * ySize];
+	memset(tempPixels, 0, xSize * ySize * sizeof(uint32_t));
+	for (int x = 0; x < xSize; x++) {
+		for (int y = 0; y < ySize; y++) {
+			unsigned char r = static_cast<unsigned char>((rChannel.at(x).at(y) / overallMax) * 255.0);
+			unsigned char g = static_cast<unsigned char>((gChannel.at(x).at(y) / overallMax) * 255.0);
+			unsigned char b = static_cast<unsigned char>((bChannel.at(x).at(y) / overallMax) * 255.0);
+			tempPixels[(y * xSize) + x] = (255u << 24) + (r << 16) + (g << 8) + b;
+		}
+	}
+	std::memcpy(output.data(), tempPixels, xSize * ySize * sizeof(uint32_t));
+	delete[] tempPixels;
+}
+
+void runDisplayBenchmark() {
+	const int xSize = 3840;
+	const int ySize = 2160;
+	const int numFrames = 10;
+	// fill an image with random colors
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<double> value(0.0, 2.0);
+	image testImage;
+	testImage.initialize(xSize, ySize);
+	std::vector<std::vector<double>> rChannel(xSize, std::vector<double>(ySize));
+	std::vector<std::vector<double>> gChannel(xSize, std::vector<double>(ySize));
+	std::vector<std::vector<double>> bChannel(xSize, std::vector<double>(ySize));
+	for (int y = 0; y < ySize; y++) {
+		for (int x = 0; x < xSize; x++) {
+			double red = value(rng), green = value(rng), blue = value(rng);
+			testImage.setPixel(x, y, red, green, blue);
+			rChannel[x][y] = red;
+			gChannel[x][y] = green;
+			bChannel[x][y] = blue;
+		}
+	}
+	// the output stands in for the memory of a locked texture
+	std::vector<uint32_t> output(xSize * ySize);
+	std::printf("display conversion, %d x %d, %d frames\n", xSize, ySize, numFrames);
+	std::printf("%24s %12s\n", "method", "ms/frame");
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < numFrames; frame++) convertReference(rChannel, gChannel, bChannel, xSize, ySize, output);
+	double referenceMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / numFrames;
+	std::printf("%24s %12.2f\n", "per-pixel reference", referenceMs);
+	recordResult("display", "per-pixel reference", "frame", { { "width", xSize }, { "height", ySize }, { "threads", 1 } }, referenceMs * 1e6);
+	start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < numFrames; frame++) testImage.convertTo8Bit(reinterpret_cast<unsigned char*>(output.data()), xSize * 4, image::LAYOUT_BGRA8);
+	double simdMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / numFrames;
+	std::printf("%24s %12.2f\n", "simd, 1 thread", simdMs);
+	recordResult("display", "simd", "frame", { { "width", xSize }, { "height", ySize }, { "threads", 1 } }, simdMs * 1e6);
+	RT::threadpool threadPool(0);
+	start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < numFrames; frame++) testImage.convertTo8Bit(reinterpret_cast<unsigned char*>(output.data()), xSize * 4, image::LAYOUT_BGRA8, &threadPool);
+	double parallelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / numFrames;
+	char method[32];
+	std::snprintf(method, sizeof(method), "simd, %d threads", threadPool.getNumThreads());
+	std::printf("%24s %12.2f\n", method, parallelMs);
+	recordResult("display", "simd", "frame", { { "width", xSize }, { "height", ySize }, { "threads", threadPool.getNumThreads() } }, parallelMs * 1e6);
+}
@@ -0,0 +1,103 @@
+#include "benchmarks.hpp"
+#include "benchresults.hpp"
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "image.hpp"
+#include "scene.hpp"
+
+// function to write a scene file with a field of numSpheres randomly placed spheres above a reflective floor, in view of the default camera
+// a third of the spheres are reflective, so the frame includes secondary rays
+static bool writeSphereField(const char* fileName, int numSpheres) {
+	FILE* pFile = std::fopen(fileName, "w");
+	if (pFile == nullptr) return false;
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<double> position(-2.0, 2.0);
+	std::uniform_real_distribution<double> color(0.2, 1.0);
+	double radius = 2.0 * cbrt(0.05 / numSpheres);
+	std::fprintf(pFile, "camera position 0 -10 -1 lookat 0 0 0 up 0 0 1 horzsize 0.25 aspect 1.7777777777777777\n");
+	std::fprintf(pFile, "material shiny color 1.0 1.0 1.0 reflectivity 0.5 shininess 10\n");
+	std::fprintf(pFile, "material floor color 1.0 1.0 1.0 reflectivity 0.5 shininess 0\n");
+	for (int i = 0; i < numSpheres; i++) {
+		std::fprintf(pFile, "sphere translate %.9f %.9f %.9f scale %.9f %.9f %.9f color %.3f %.3f %.3f%s\n", position(rng) * 1.5, position(rng), (position(rng) * 0.3) - 0.2, radius, radius, radius, color(rng), color(rng), color(rng), ((i % 3) == 0) ? " material shiny" : "");
+	}
+	std::fprintf(pFile, "plane translate 0 0 0.75 scale 4 4 1 color 0.5 0.5 0.5 material floor\n");
+	std::fprintf(pFile, "pointlight position 5 -10 -5 color 0 0 1\npointlight position -5 -10 -5 color 1 0 0\npointlight position 0 -10 -5 color 0 1 0\n");
+	return std::fclose(pFile) == 0;
+}
+
+// function to render frames of a scene at each resolution and thread count, and record the time per camera ray
+// the large frames are also rendered with the wavefront integrator, which is meant for them
+static void benchmarkScene(RT::scene& testScene, const char* sceneName, int numObjects) {
+	const int resolutions[][2] = { { 320, 180 }, { 1280, 720 } };
+	// one thread, then one per hardware thread (when there is more than one)
+	std::vector<int> threadCounts{ 1 };
+	int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+	if (hardwareThreads > 1) threadCounts.push_back(hardwareThreads);
+	const double minSeconds = 0.5; // frames are repeated for at least this long, so small ones are timed reliably
+	for (const auto& resolution : resolutions) {
+		for (int numThreads : threadCounts) {
+			for (int wavefront = 0; wavefront <= ((resolution[0] >= 1280) ? 1 : 0); wavefront++) {
+				RT::renderconfig config = testScene.getRenderConfig();
+				config.m_numThreads = numThreads;
+				config.m_wavefront = wavefront != 0;
+				config.m_reportProgress = false;
+				testScene.setRenderConfig(config);
+				image outputImage;
+				outputImage.initialize(resolution[0], resolution[1]);
+				// one frame first, so the threads are started (and the hierarchy built) before the timing
+				testScene.render(outputImage);
+				int numFrames = 0;
+				benchtimer timer;
+				do {
+					testScene.render(outputImage);
+					numFrames++;
+				} while (timer.getSeconds() < minSeconds);
+				int64_t numPixels = static_cast<int64_t>(resolution[0]) * resolution[1];
+				benchresult result;
+				timer.finish(numFrames * numPixels, result);
+				result.m_benchmark = "frame";
+				result.m_name = std::string("render ") + sceneName + (wavefront ? " wavefront" : "");
+				result.m_unit = "camera ray";
+				result.m_params = { { "objects", numObjects }, { "width", resolution[0] }, { "height", resolution[1] }, { "threads", numThreads }, { "wavefront", wavefront } };
+				recordResult(result);
+				std::printf("%-10s %-10s %8d %6d x %-6d %8d %12.1f %14.0f %14.1f %12.4f\n", sceneName, wavefront ? "wavefront" : "recursive", numObjects, resolution[0], resolution[1], numThreads, result.m_nsPerOp * numPixels / 1e6, 1e9 / result.m_nsPerOp, result.m_nsPerOp, result.m_allocsPerOp);
+			}
+		}
+	}
+}
+
+void runFrameBenchmark() {
+	const char* fileName = "framebench.scene";
+	std::printf("whole frames at %s precision, times per camera ray include every secondary and shadow ray it leads to\n", RT::getPrecisionName());
+	std::printf("%-10s %-10s %8s %15s %8s %12s %14s %14s %12s\n", "scene", "integrator", "objects", "resolution", "threads", "ms/frame", "camera rays/s", "ns/camera ray", "allocs/ray");
+	// the built-in test scene
+	RT::scene builtinScene;
+	benchmarkScene(builtinScene, "builtin", 4);
+	// fields of spheres, loaded through the scene file parser as the headless renderer does
+	for (int numSpheres = 100; numSpheres <= 100000; numSpheres *= 10) {
+		if (!writeSphereField(fileName, numSpheres)) {
+			std::printf("could not write %s\n", fileName);
+			return;
+		}
+		RT::scene fieldScene;
+		bool loaded = true;
+		try {
+			fieldScene.loadFile(fileName);
+		}
+		catch (const std::exception& error) {
+			std::printf("%s\n", error.what());
+			loaded = false;
+		}
+		std::remove(fileName);
+		std::remove((std::string(fileName) + ".cache").c_str());
+		// without the field the default scene would be measured as one of this size
+		if (!loaded) continue;
+		benchmarkScene(fieldScene, "spheres", numSpheres + 1);
+	}
+}
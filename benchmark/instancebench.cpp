@@ -0,0 +1,130 @@
+#include "benchmarks.hpp"
+#include "benchresults.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "bvh.hpp"
+#include "camera.hpp"
+#include "meshdata.hpp"
+#include "objmesh.hpp"
+#include "objsphere.hpp"
+#include "objplane.hpp"
+#include "objgroup.hpp"
+#include "objinstance.hpp"
+
+// function to build a tree: a bumpy mesh crown of about 2 * rings * segments triangles on a sphere trunk, in a group
+static std::shared_ptr<RT::objgroup> makeTree(int rings, int segments, std::shared_ptr<RT::meshdata>& crown) {
+	const double pi = 3.141592653589793;
+	crown = std::make_shared<RT::meshdata>();
+	crown->reserve((rings + 1) * segments, 2 * rings * segments);
+	for (int j = 0; j <= rings; j++) {
+		double theta = pi * j / rings;
+		for (int i = 0; i < segments; i++) {
+			double phi = 2.0 * pi * i / segments;
+			double radius = 1.0 + (0.1 * sin(12.0 * theta) * sin(12.0 * phi));
+			crown->addVertex(Vec3{ static_cast<RT::real>(radius * sin(theta) * cos(phi)), static_cast<RT::real>(radius * sin(theta) * sin(phi)), static_cast<RT::real>((radius * cos(theta)) - 1.0) });
+		}
+	}
+	for (int j = 0; j < rings; j++) {
+		for (int i = 0; i < segments; i++) {
+			int a = (j * segments) + i;
+			int b = (j * segments) + ((i + 1) % segments);
+			crown->addTriangle(a, a + segments, b + segments);
+			crown->addTriangle(a, b + segments, b);
+		}
+	}
+	crown->build();
+	auto trunk = std::make_shared<RT::objsphere>();
+	RT::GTform trunkMatrix;
+	trunkMatrix.setTransform(Vec3{ 0.0, 0.0, 0.5 }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 0.2, 0.2, 0.8 });
+	trunk->setTransformMatrix(trunkMatrix);
+	std::vector<std::shared_ptr<RT::objectbase>> parts{ std::make_shared<RT::objmesh>(crown), trunk };
+	return std::make_shared<RT::objgroup>(parts);
+}
+
+void runInstanceBenchmark() {
+	const int xSize = 640;
+	const int ySize = 360;
+	const int rings = 64;
+	// a camera looking across the forest
+	RT::camera testCamera;
+	testCamera.setPosition(Vec3{ 0.0, -60.0, -6.0 });
+	testCamera.setLookAt(Vec3{ 0.0, 0.0, 0.0 });
+	testCamera.setUp(Vec3{ 0.0, 0.0, 1.0 });
+	testCamera.setHorzSize(0.5);
+	testCamera.setAspect(static_cast<double>(xSize) / static_cast<double>(ySize));
+	testCamera.updateCameraGeometry();
+	std::vector<RT::ray> rays(xSize * ySize);
+	for (int y = 0; y < ySize; y++) {
+		for (int x = 0; x < xSize; x++) {
+			double normX = (static_cast<double>(x) / (xSize / 2.0)) - 1.0;
+			double normY = (static_cast<double>(y) / (ySize / 2.0)) - 1.0;
+			testCamera.generateRay(normX, normY, rays[(y * xSize) + x]);
+		}
+	}
+	int numRays = static_cast<int>(rays.size());
+	// the shared tree, and an estimate of the memory it takes (positions, indices and hierarchy nodes)
+	std::shared_ptr<RT::meshdata> crown;
+	auto tree = makeTree(rings, 2 * rings, crown);
+	size_t treeBytes = (static_cast<size_t>(crown->getNumVertices()) * 3 * sizeof(double)) + (static_cast<size_t>(crown->getNumTriangles()) * 3 * sizeof(int)) + (static_cast<size_t>(crown->getNodeCount()) * sizeof(RT::bvh::node));
+	std::printf("instanced forest, %d triangles and a sphere per tree (about %.1f MB shared), %d bytes per instance, primary rays %d x %d\n", crown->getNumTriangles(), treeBytes / 1e6, static_cast<int>(sizeof(RT::objinstance)), xSize, ySize);
+	std::printf("%10s %14s %12s %14s %14s\n", "instances", "triangles", "build ms", "scalar ns/ray", "packet ns/ray");
+	for (int side = 10; side <= 100; side *= 10) {
+		// a side x side grid of trees, each one turned, scaled and jittered on its own
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<double> jitter(-0.3, 0.3);
+		std::uniform_real_distribution<double> angle(0.0, 6.283185307179586);
+		std::uniform_real_distribution<double> size(0.7, 1.3);
+		double spacing = 100.0 / side;
+		auto start = std::chrono::steady_clock::now();
+		std::vector<std::shared_ptr<RT::objectbase>> objectList;
+		for (int j = 0; j < side; j++) {
+			for (int i = 0; i < side; i++) {
+				auto instance = std::make_shared<RT::objinstance>(tree);
+				double scale = size(rng) * spacing * 0.3;
+				Vec3 position{ static_cast<RT::real>(((i + 0.5 + jitter(rng)) * spacing) - 50.0), static_cast<RT::real>(((j + 0.5 + jitter(rng)) * spacing) - 40.0), static_cast<RT::real>(1.0 - (1.3 * scale)) };
+				RT::real rotation = static_cast<RT::real>(angle(rng));
+				RT::real instanceScale = static_cast<RT::real>(scale);
+				RT::GTform instanceMatrix;
+				instanceMatrix.setTransform(position, Vec3{ 0.0, 0.0, rotation }, Vec3{ instanceScale, instanceScale, instanceScale });
+				instance->setTransformMatrix(instanceMatrix);
+				objectList.push_back(instance);
+			}
+		}
+		auto floor = std::make_shared<RT::objplane>();
+		RT::GTform floorMatrix;
+		floorMatrix.setTransform(Vec3{ 0.0, 0.0, 1.0 }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 100.0, 100.0, 1.0 });
+		floor->setTransformMatrix(floorMatrix);
+		objectList.push_back(floor);
+		RT::bvh objectBVH;
+		objectBVH.build(objectList);
+		double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		// closest hits with shading data, one ray at a time
+		std::shared_ptr<RT::objectbase> closestObject;
+		Vec3 intPoint, localNormal, localColor;
+		int scalarHits = 0;
+		start = std::chrono::steady_clock::now();
+		for (const auto& castRay : rays) {
+			if (objectBVH.castRay(castRay, nullptr, closestObject, intPoint, localNormal, localColor)) scalarHits++;
+		}
+		double scalarNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numRays;
+		// closest hits only, in packets
+		RT::raypacket packet;
+		RT::packethit hits;
+		int packetHits = 0;
+		start = std::chrono::steady_clock::now();
+		for (int first = 0; first < numRays; first += RT::PACKET_SIZE) {
+			packet.setRays(&rays[first], RT::PACKET_SIZE);
+			int hitMask = objectBVH.castPacket(packet, hits);
+			for (; hitMask != 0; hitMask &= hitMask - 1) packetHits++;
+		}
+		double packetNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numRays;
+		if (packetHits != scalarHits) std::printf("warning: packets found %d hits, scalar found %d\n", packetHits, scalarHits);
+		recordResult("instance", "scalar castRay", "ray", { { "instances", side * side } }, scalarNs);
+		recordResult("instance", "castPacket", "ray", { { "instances", side * side } }, packetNs);
+		std::printf("%10d %14.0f %12.1f %14.1f %14.1f\n", side * side, static_cast<double>(side) * side * crown->getNumTriangles(), buildMs, scalarNs, packetNs);
+	}
+}
@@ -0,0 +1,81 @@
+#include "benchmarks.hpp"
+#include "benchresults.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// runs the benchmarks and prints a table for each one
+// usage: benchmark [--json FILE] [name ...], with no names every benchmark is run
+// with --json every result is also written to FILE, so that runs of different versions can be compared
+
+// the benchmarks, by the name used to pick them on the command line
+struct benchmarkEntry {
+	const char* m_name;
+	void (*m_function)();
+};
+
+static const benchmarkEntry benchmarkList[] = {
+	{ "micro", runMicroBenchmark },
+	{ "bvh", runBVHBenchmark },
+	{ "packet", runPacketBenchmark },
+	{ "display", runDisplayBenchmark },
+	{ "mesh", runMeshBenchmark },
+	{ "instance", runInstanceBenchmark },
+	{ "frame", runFrameBenchmark },
+	{ "convergence", runConvergenceBenchmark },
+};
+
+// function to print the command line options
+static void printUsage(const char* programName) {
+	std::printf("usage: %s [--json FILE] [name ...]\n", programName);
+	std::printf("  --json FILE    also write the results to FILE as JSON\n");
+	std::printf("  name           run only the named benchmarks, from:");
+	for (const auto& entry : benchmarkList) std::printf(" %s", entry.m_name);
+	std::printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+	std::string jsonFile;
+	std::vector<const benchmarkEntry*> selected;
+	for (int i = 1; i < argc; i++) {
+		std::string option = argv[i];
+		if ((option == "--help") || (option == "-h")) {
+			printUsage(argv[0]);
+			return 0;
+		}
+		if (option == "--json") {
+			if (i + 1 >= argc) {
+				printUsage(argv[0]);
+				return 1;
+			}
+			jsonFile = argv[++i];
+			continue;
+		}
+		const benchmarkEntry* pEntry = nullptr;
+		for (const auto& entry : benchmarkList) {
+			if (option == entry.m_name) pEntry = &entry;
+		}
+		if (pEntry == nullptr) {
+			std::printf("unknown benchmark %s\n", option.c_str());
+			printUsage(argv[0]);
+			return 1;
+		}
+		selected.push_back(pEntry);
+	}
+	if (selected.empty()) {
+		for (const auto& entry : benchmarkList) selected.push_back(&entry);
+	}
+	for (const benchmarkEntry* pEntry : selected) {
+		std::printf("\n[%s]\n", pEntry->m_name);
+		pEntry->m_function();
+	}
+	if (!jsonFile.empty()) {
+		if (!writeResults(jsonFile)) {
+			std::printf("could not write %s\n", jsonFile.c_str());
+			return 1;
+		}
+		std::printf("\nwrote %s\n", jsonFile.c_str());
+	}
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "benchmarks.hpp"
+#include "benchresults.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "bvh.hpp"
+#include "camera.hpp"
+#include "objmesh.hpp"
+#include "objloader.hpp"
+
+// function to write a bumpy sphere of about 2 * rings * segments triangles as an OBJ file, with vertex normals
+static bool writeBumpySphere(const char* fileName, int rings, int segments) {
+	FILE* pFile = std::fopen(fileName, "w");
+	if (pFile == nullptr) return false;
+	const double pi = 3.141592653589793;
+	for (int j = 0; j <= rings; j++) {
+		double theta = pi * j / rings;
+		for (int i = 0; i < segments; i++) {
+			double phi = 2.0 * pi * i / segments;
+			double radius = 1.0 + (0.05 * sin(24.0 * theta) * sin(24.0 * phi));
+			Vec3 direction{ static_cast<RT::real>(sin(theta) * cos(phi)), static_cast<RT::real>(sin(theta) * sin(phi)), static_cast<RT::real>(cos(theta)) };
+			std::fprintf(pFile, "v %.9f %.9f %.9f\nvn %.6f %.6f %.6f\n", radius * direction[0], radius * direction[1], radius * direction[2], direction[0], direction[1], direction[2]);
+		}
+	}
+	for (int j = 0; j < rings; j++) {
+		for (int i = 0; i < segments; i++) {
+			int a = (j * segments) + i + 1;
+			int b = (j * segments) + ((i + 1) % segments) + 1;
+			int c = a + segments;
+			int d = b + segments;
+			std::fprintf(pFile, "f %d//%d %d//%d %d//%d\nf %d//%d %d//%d %d//%d\n", a, a, c, c, d, d, a, a, d, d, b, b);
+		}
+	}
+	return std::fclose(pFile) == 0;
+}
+
+void runMeshBenchmark() {
+	const char* fileName = "meshbench.obj";
+	const int xSize = 640;
+	const int ySize = 360;
+	// a camera looking at the mesh from below, as in the default scene
+	RT::camera testCamera;
+	testCamera.setPosition(Vec3{ 0.0, -10.0, 0.0 });
+	testCamera.setLookAt(Vec3{ 0.0, 0.0, 0.0 });
+	testCamera.setUp(Vec3{ 0.0, 0.0, 1.0 });
+	testCamera.setHorzSize(0.25);
+	testCamera.setAspect(static_cast<double>(xSize) / static_cast<double>(ySize));
+	testCamera.updateCameraGeometry();
+	std::vector<RT::ray> rays(xSize * ySize);
+	for (int y = 0; y < ySize; y++) {
+		for (int x = 0; x < xSize; x++) {
+			double normX = (static_cast<double>(x) / (xSize / 2.0)) - 1.0;
+			double normY = (static_cast<double>(y) / (ySize / 2.0)) - 1.0;
+			testCamera.generateRay(normX, normY, rays[(y * xSize) + x]);
+		}
+	}
+	int numRays = static_cast<int>(rays.size());
+	std::printf("triangle meshes, primary rays %d x %d\n", xSize, ySize);
+	std::printf("%10s %12s %12s %12s %14s %14s\n", "triangles", "load ms", "(build ms)", "nodes", "scalar ns/ray", "packet ns/ray");
+	for (int rings = 32; rings <= 1024; rings *= 4) {
+		int segments = 2 * rings;
+		if (!writeBumpySphere(fileName, rings, segments)) {
+			std::printf("could not write %s\n", fileName);
+			return;
+		}
+		// loadOBJ parses the file and builds the hierarchy, building again gives the share of the load time spent on the hierarchy
+		auto start = std::chrono::steady_clock::now();
+		std::shared_ptr<RT::meshdata> meshData;
+		try {
+			meshData = RT::loadOBJ(fileName);
+		}
+		catch (const std::exception& error) {
+			std::printf("%s\n", error.what());
+			std::remove(fileName);
+			return;
+		}
+		double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		start = std::chrono::steady_clock::now();
+		meshData->build();
+		double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::remove(fileName);
+		// a single mesh object in the scene hierarchy, scaled up to fill the view
+		auto mesh = std::make_shared<RT::objmesh>(meshData);
+		RT::GTform meshMatrix;
+		meshMatrix.setTransform(Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 0.3, 0.0, 0.5 }, Vec3{ 1.2, 1.2, 1.2 });
+		mesh->setTransformMatrix(meshMatrix);
+		std::vector<std::shared_ptr<RT::objectbase>> objectList{ mesh };
+		RT::bvh objectBVH;
+		objectBVH.build(objectList);
+		// closest hits with shading data, one ray at a time
+		std::shared_ptr<RT::objectbase> closestObject;
+		Vec3 intPoint, localNormal, localColor;
+		int scalarHits = 0;
+		start = std::chrono::steady_clock::now();
+		for (const auto& castRay : rays) {
+			if (objectBVH.castRay(castRay, nullptr, closestObject, intPoint, localNormal, localColor)) scalarHits++;
+		}
+		double scalarNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numRays;
+		// closest hits only, in packets
+		RT::raypacket packet;
+		RT::packethit hits;
+		int packetHits = 0;
+		start = std::chrono::steady_clock::now();
+		for (int first = 0; first < numRays; first += RT::PACKET_SIZE) {
+			packet.setRays(&rays[first], RT::PACKET_SIZE);
+			int hitMask = objectBVH.castPacket(packet, hits);
+			for (; hitMask != 0; hitMask &= hitMask - 1) packetHits++;
+		}
+		double packetNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numRays;
+		if (packetHits != scalarHits) std::printf("warning: packets found %d hits, scalar found %d\n", packetHits, scalarHits);
+		recordResult("mesh", "loadOBJ", "mesh", { { "triangles", meshData->getNumTriangles() } }, loadMs * 1e6);
+		recordResult("mesh", "meshdata::build", "mesh", { { "triangles", meshData->getNumTriangles() } }, buildMs * 1e6);
+		recordResult("mesh", "scalar castRay", "ray", { { "triangles", meshData->getNumTriangles() } }, scalarNs);
+		recordResult("mesh", "castPacket", "ray", { { "triangles", meshData->getNumTriangles() } }, packetNs);
+		std::printf("%10d %12.1f %12.1f %12d %14.1f %14.1f\n", meshData->getNumTriangles(), loadMs, buildMs, meshData->getNodeCount(), scalarNs, packetNs);
+	}
+}
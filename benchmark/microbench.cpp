@@ -0,0 +1,208 @@
+#include "benchmarks.hpp"
+#include "benchresults.hpp"
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "bvh.hpp"
+#include "camera.hpp"
+#include "materialbase.hpp"
+#include "matrix.hpp"
+#include "objsphere.hpp"
+#include "objplane.hpp"
+#include "pointlight.hpp"
+
+// the number of calls timed for each function
+constexpr int MICRO_NUM_CALLS = 1000000;
+
+// function to record and print one microbenchmark
+static void report(const char* name, const benchtimer& timer, int64_t numCalls, double checksum) {
+	benchresult result;
+	timer.finish(numCalls, result);
+	result.m_benchmark = "micro";
+	result.m_name = name;
+	result.m_unit = "call";
+	// the checksum is printed so the compiler can't drop the work being timed
+	std::printf("%-42s %10.1f %12.3f %14.6g\n", name, result.m_nsPerOp, result.m_allocsPerOp, checksum);
+	recordResult(result);
+}
+
+// function to create rays from in front of the unit sphere towards random points near it (roughly half hit it)
+static std::vector<RT::ray> makeRays(int numRays, std::mt19937& rng) {
+	std::uniform_real_distribution<double> offset(-1.5, 1.5);
+	std::vector<RT::ray> rays;
+	for (int i = 0; i < numRays; i++) {
+		RT::real originX = static_cast<RT::real>(offset(rng));
+		RT::real originZ = static_cast<RT::real>(offset(rng));
+		RT::real targetX = static_cast<RT::real>(offset(rng));
+		RT::real targetZ = static_cast<RT::real>(offset(rng));
+		Vec3 origin{ originX, -10.0, originZ };
+		Vec3 target{ targetX, 0.0, targetZ };
+		rays.push_back(RT::ray(origin, target));
+	}
+	return rays;
+}
+
+void runMicroBenchmark() {
+	const int numRays = 4096; // reused across the calls, small enough to stay in cache
+	std::mt19937 rng(1234);
+	auto rays = makeRays(numRays, rng);
+	std::printf("%-42s %10s %12s %14s\n", "function", "ns/call", "allocs/call", "checksum");
+	// a transformed sphere and plane, as they are placed in a scene
+	RT::objsphere sphere;
+	RT::GTform sphereMatrix;
+	sphereMatrix.setTransform(Vec3{ 0.1, 0.0, -0.2 }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 1.0, 1.0, 1.0 });
+	sphere.setTransformMatrix(sphereMatrix);
+	// the same sphere stretched, so it takes the general path through local coordinates
+	RT::objsphere stretchedSphere;
+	RT::GTform stretchedMatrix;
+	stretchedMatrix.setTransform(Vec3{ 0.1, 0.0, -0.2 }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 1.0, 0.5, 1.0 });
+	stretchedSphere.setTransformMatrix(stretchedMatrix);
+	RT::objplane plane;
+	RT::GTform planeMatrix;
+	planeMatrix.setTransform(Vec3{ 0.0, 0.0, 0.0 }, Vec3{ -1.2, 0.0, 0.0 }, Vec3{ 1.0, 1.0, 1.0 });
+	plane.setTransformMatrix(planeMatrix);
+	Vec3 intPoint, localNormal, localColor;
+	// objsphere::testIntersections
+	{
+		int hits = 0;
+		benchtimer timer;
+		for (int i = 0; i < MICRO_NUM_CALLS; i++) {
+			if (sphere.testIntersections(rays[i % numRays], intPoint, localNormal, localColor)) hits++;
+		}
+		report("objsphere::testIntersections", timer, MICRO_NUM_CALLS, hits);
+	}
+	// objsphere::testIntersections, with a transform that isn't a similarity
+	{
+		int hits = 0;
+		benchtimer timer;
+		for (int i = 0; i < MICRO_NUM_CALLS; i++) {
+			if (stretchedSphere.testIntersections(rays[i % numRays], intPoint, localNormal, localColor)) hits++;
+		}
+		report("objsphere::testIntersections (stretched)", timer, MICRO_NUM_CALLS, hits);
+	}
+	// objplane::testIntersections
+	{
+		int hits = 0;
+		benchtimer timer;
+		for (int i = 0; i < MICRO_NUM_CALLS; i++) {
+			if (plane.testIntersections(rays[i % numRays], intPoint, localNormal, localColor)) hits++;
+		}
+		report("objplane::testIntersections", timer, MICRO_NUM_CALLS, hits);
+	}
+	// GTform::apply to a ray, as every object does to bring the ray into its local coordinates
+	{
+		double sum = 0.0;
+		benchtimer timer;
+		for (int i = 0; i < MICRO_NUM_CALLS; i++) {
+			RT::ray localRay = sphereMatrix.apply(rays[i % numRays], RT::BCKTFM);
+			sum += localRay.m_lab.getElement(0);
+		}
+		report("GTform::apply (ray)", timer, MICRO_NUM_CALLS, sum);
+	}
+	// GTform::apply to a point
+	{
+		double sum = 0.0;
+		benchtimer timer;
+		for (int i = 0; i < MICRO_NUM_CALLS; i++) {
+			Vec3 point = sphereMatrix.apply(rays[i % numRays].m_point1, RT::FWDTFM);
+			sum += point.getElement(0);
+		}
+		report("GTform::apply (point)", timer, MICRO_NUM_CALLS, sum);
+	}
+	// matrix<double>::inverse of a 4 x 4 transform, inverted in place so every other call undoes the last
+	{
+		matrix<double> testMatrix(4, 4);
+		Affine4 forward = sphereMatrix.getForward();
+		for (int row = 0; row < 3; row++) {
+			for (int col = 0; col < 4; col++) testMatrix.setElement(row, col, forward.getElement(row, col) + ((row == col) ? 1.0 : 0.1 * (row + col)));
+		}
+		testMatrix.setElement(3, 3, 1.0);
+		const int numCalls = MICRO_NUM_CALLS / 10; // gauss-jordan elimination is slow
+		int inverted = 0;
+		benchtimer timer;
+		for (int i = 0; i < numCalls; i++) {
+			if (testMatrix.inverse()) inverted++;
+		}
+		report("matrix<double>::inverse (4 x 4)", timer, numCalls, testMatrix.getElement(0, 0) + inverted);
+	}
+	// Affine4::inverse, the closed form GTform uses
+	{
+		Affine4 testMatrix = sphereMatrix.getForward();
+		int inverted = 0;
+		benchtimer timer;
+		for (int i = 0; i < MICRO_NUM_CALLS; i++) {
+			if (testMatrix.inverse()) inverted++;
+		}
+		report("Affine4::inverse", timer, MICRO_NUM_CALLS, testMatrix.getElement(0, 0) + inverted);
+	}
+	// camera::generateRay across a 1024 x 1024 grid of screen positions
+	{
+		RT::camera testCamera;
+		testCamera.setPosition(Vec3{ 0.0, -10.0, -1.0 });
+		testCamera.setLookAt(Vec3{ 0.0, 0.0, 0.0 });
+		testCamera.setUp(Vec3{ 0.0, 0.0, 1.0 });
+		testCamera.setHorzSize(0.25);
+		testCamera.setAspect(16.0 / 9.0);
+		testCamera.updateCameraGeometry();
+		RT::ray cameraRay;
+		double sum = 0.0;
+		benchtimer timer;
+		for (int i = 0; i < MICRO_NUM_CALLS; i++) {
+			float normX = static_cast<float>(i & 1023) / 512.0f - 1.0f;
+			float normY = static_cast<float>((i >> 10) & 1023) / 512.0f - 1.0f;
+			testCamera.generateRay(normX, normY, cameraRay);
+			sum += cameraRay.m_lab.getElement(0);
+		}
+		report("camera::generateRay", timer, MICRO_NUM_CALLS, sum);
+		// camera::generateRays over the same grid, in 16 x 16 tiles (per ray)
+		RT::camerarays cameraRays;
+		int numRays = 0;
+		sum = 0.0;
+		benchtimer batchTimer;
+		for (int tile = 0; numRays < MICRO_NUM_CALLS; tile++) {
+			int x0 = (tile & 63) * 16;
+			int y0 = ((tile >> 6) & 63) * 16;
+			testCamera.generateRays(x0, y0, x0 + 16, y0 + 16, 1, 1.0 / 512.0, 1.0 / 512.0, nullptr, cameraRays);
+			sum += cameraRays.m_point2X[0];
+			numRays += cameraRays.size();
+		}
+		report("camera::generateRays (16 x 16 tiles)", batchTimer, numRays, sum);
+	}
+	// materialbase::computeDiffuseColor for points on the sphere, lit by three lights with a floor plane for shadows
+	{
+		auto litSphere = std::make_shared<RT::objsphere>();
+		litSphere->setTransformMatrix(sphereMatrix);
+		auto floor = std::make_shared<RT::objplane>();
+		RT::GTform floorMatrix;
+		floorMatrix.setTransform(Vec3{ 0.0, 0.0, 1.0 }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 4.0, 4.0, 1.0 });
+		floor->setTransformMatrix(floorMatrix);
+		std::vector<std::shared_ptr<RT::objectbase>> objectList{ litSphere, floor };
+		RT::bvh objectBVH;
+		objectBVH.build(objectList);
+		std::vector<std::shared_ptr<RT::lightbase>> lightList;
+		for (int i = 0; i < 3; i++) {
+			auto light = std::make_shared<RT::pointlight>();
+			light->m_location = Vec3{ static_cast<RT::real>(5.0 * (i - 1)), -10.0, -5.0 };
+			lightList.push_back(light);
+		}
+		// the hit points are found up front, so only the shading is timed
+		std::vector<Vec3> intPoints, localNormals;
+		for (const auto& castRay : rays) {
+			if (litSphere->testIntersections(castRay, intPoint, localNormal, localColor)) {
+				intPoints.push_back(intPoint);
+				localNormals.push_back(localNormal);
+			}
+		}
+		int numPoints = static_cast<int>(intPoints.size());
+		const int numCalls = MICRO_NUM_CALLS / 4;
+		Vec3 baseColor{ 1.0, 0.5, 0.0 };
+		double sum = 0.0;
+		benchtimer timer;
+		for (int i = 0; i < numCalls; i++) {
+			Vec3 color = RT::materialbase::computeDiffuseColor(objectBVH, lightList, objectList[0], intPoints[i % numPoints], localNormals[i % numPoints], baseColor, 0.0);
+			sum += color.getElement(0);
+		}
+		report("materialbase::computeDiffuseColor", timer, numCalls, sum);
+	}
+}
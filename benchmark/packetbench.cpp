@@ -0,0 +1,100 @@
+#include "benchmarks.hpp"
+#include "benchresults.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <memory>
+#include <vector>
+#include "bvh.hpp"
+#include "camera.hpp"
+#include "objsphere.hpp"
+#include "objplane.hpp"
+
+// function to create a field of numSpheres randomly placed spheres above a floor plane, all in view of the camera below
+static std::vector<std::shared_ptr<RT::objectbase>> makeField(int numSpheres, std::mt19937& rng) {
+	std::uniform_real_distribution<double> position(-4.0, 4.0);
+	RT::real radius = static_cast<RT::real>(4.0 * cbrt(0.05 / numSpheres));
+	std::vector<std::shared_ptr<RT::objectbase>> objectList;
+	for (int i = 0; i < numSpheres; i++) {
+		auto sphere = std::make_shared<RT::objsphere>();
+		RT::GTform sphereMatrix;
+		RT::real x = static_cast<RT::real>(position(rng));
+		RT::real y = static_cast<RT::real>(position(rng));
+		RT::real z = static_cast<RT::real>(position(rng) - 4.0);
+		sphereMatrix.setTransform(Vec3{ x, y, z }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ radius, radius, radius });
+		sphere->setTransformMatrix(sphereMatrix);
+		objectList.push_back(sphere);
+	}
+	auto floor = std::make_shared<RT::objplane>();
+	RT::GTform floorMatrix;
+	floorMatrix.setTransform(Vec3{ 0.0, 0.0, 1.0 }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 20.0, 20.0, 1.0 });
+	floor->setTransformMatrix(floorMatrix);
+	objectList.push_back(floor);
+	return objectList;
+}
+
+void runPacketBenchmark() {
+	const int xSize = 640;
+	const int ySize = 360;
+	// a camera set up as in the default scene
+	RT::camera testCamera;
+	testCamera.setPosition(Vec3{ 0.0, -10.0, -1.0 });
+	testCamera.setLookAt(Vec3{ 0.0, 0.0, -1.0 });
+	testCamera.setUp(Vec3{ 0.0, 0.0, 1.0 });
+	testCamera.setHorzSize(0.5);
+	testCamera.setAspect(static_cast<double>(xSize) / static_cast<double>(ySize));
+	testCamera.updateCameraGeometry();
+	// the camera rays, in rows so that every packet holds neighbouring pixels
+	std::vector<RT::ray> rays(xSize * ySize);
+	for (int y = 0; y < ySize; y++) {
+		for (int x = 0; x < xSize; x++) {
+			double normX = (static_cast<double>(x) / (xSize / 2.0)) - 1.0;
+			double normY = (static_cast<double>(y) / (ySize / 2.0)) - 1.0;
+			testCamera.generateRay(normX, normY, rays[(y * xSize) + x]);
+		}
+	}
+	int numRays = static_cast<int>(rays.size());
+	std::printf("primary rays, %d x %d, simd4d lanes %d, packet size %d\n", xSize, ySize, RT::simd4d::WIDTH, RT::PACKET_SIZE);
+	std::printf("%10s %16s %16s %16s %8s\n", "objects", "scalar ns/ray", "packet ns/ray", "+ shading data", "speedup");
+	for (int numObjects = 10; numObjects <= 10000; numObjects *= 10) {
+		std::mt19937 rng(1234);
+		auto objectList = makeField(numObjects, rng);
+		RT::bvh objectBVH;
+		objectBVH.build(objectList);
+		// one ray at a time, as scene::castRay
+		std::shared_ptr<RT::objectbase> closestObject;
+		Vec3 intPoint, localNormal, localColor;
+		int scalarHits = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (const auto& castRay : rays) {
+			if (objectBVH.castRay(castRay, nullptr, closestObject, intPoint, localNormal, localColor)) scalarHits++;
+		}
+		double scalarNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numRays;
+		// packets, closest object only
+		RT::raypacket packet;
+		RT::packethit hits;
+		int packetHits = 0;
+		start = std::chrono::steady_clock::now();
+		for (int first = 0; first < numRays; first += RT::PACKET_SIZE) {
+			packet.setRays(&rays[first], RT::PACKET_SIZE);
+			int hitMask = objectBVH.castPacket(packet, hits);
+			for (; hitMask != 0; hitMask &= hitMask - 1) packetHits++;
+		}
+		double packetNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numRays;
+		// packets, then the intersection details for the closest object (what scene::castRayPacket does)
+		start = std::chrono::steady_clock::now();
+		for (int first = 0; first < numRays; first += RT::PACKET_SIZE) {
+			packet.setRays(&rays[first], RT::PACKET_SIZE);
+			int hitMask = objectBVH.castPacket(packet, hits);
+			for (int i = 0; i < RT::PACKET_SIZE; i++) {
+				if (hitMask & (1 << i)) objectList[hits.m_index[i]]->testIntersections(rays[first + i], intPoint, localNormal, localColor);
+			}
+		}
+		double shadedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numRays;
+		if (packetHits != scalarHits) std::printf("warning: packets found %d hits, scalar found %d\n", packetHits, scalarHits);
+		recordResult("packet", "scalar castRay", "ray", { { "objects", numObjects + 1 } }, scalarNs);
+		recordResult("packet", "castPacket", "ray", { { "objects", numObjects + 1 } }, packetNs);
+		recordResult("packet", "castPacket with shading data", "ray", { { "objects", numObjects + 1 } }, shadedNs);
+		std::printf("%10d %16.1f %16.1f %16.1f %7.2fx\n", numObjects + 1, scalarNs, packetNs, shadedNs, scalarNs / shadedNs);
+	}
+}
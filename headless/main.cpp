@@ -0,0 +1,215 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "image.hpp"
+#include "scene.hpp"
+#include "renderstats.hpp"
+#include "precision.hpp"
+
+// renders the scene without a window and writes the result to a file
+// usage: headless [--width N] [--height N] [--threads N] [--scene file] [--output file.(ppm|pfm|png)] [--costmap name]
+//        [--samples N] [--min-samples N] [--threshold X] [--integrator recursive|wavefront] [--sampler sobol|random] [--compare reference.pfm]
+
+// function to print the command line options
+static void printUsage(const char* programName) {
+	std::cout << "usage: " << programName << " [options]" << std::endl;
+	std::cout << "  --width N      width of the image in pixels (default 1280)" << std::endl;
+	std::cout << "  --height N     height of the image in pixels (default 720)" << std::endl;
+	std::cout << "  --threads N    number of render threads, 0 for one per hardware thread (default 0)" << std::endl;
+	std::cout << "  --scene FILE   scene file to render (default the built-in test scene)" << std::endl;
+	std::cout << "  --output FILE  output file, the format is taken from the extension: .ppm, .pfm or .png (default render.png)" << std::endl;
+	std::cout << "  --costmap NAME also record the cost of each pixel, written to NAME.png (time, in false colour) and NAME.pfm (rays, tests, ns)" << std::endl;
+	std::cout << "                 with --samples above 1, also NAME-samples.png (samples taken for each pixel)" << std::endl;
+	std::cout << "  --samples N    anti-aliasing, at most N samples per pixel, 1 for a single ray per pixel (default 1)" << std::endl;
+	std::cout << "  --min-samples N samples every pixel starts with, rounded to a square (default 4)" << std::endl;
+	std::cout << "  --threshold X  a pixel gets more samples while the variance of its mean luminance is above X (default 1e-4)" << std::endl;
+	std::cout << "  --integrator I recursive (each path followed to its end) or wavefront (every ray of a tile one stage at a time), the image is the same (default recursive)" << std::endl;
+	std::cout << "  --sampler S    lens and shutter samples, for scenes with depth of field or motion blur: sobol (low discrepancy) or random (default sobol)" << std::endl;
+	std::cout << "  --compare FILE report how far the render is from a reference .pfm of the same size (such as one rendered at the other precision)" << std::endl;
+}
+
+// function to parse a positive integer argument, returns false if it isn't one
+static bool parseInt(const std::string& text, int minValue, int& value) {
+	char* end = nullptr;
+	long parsed = std::strtol(text.c_str(), &end, 10);
+	if ((end == text.c_str()) || (*end != '\0') || (parsed < minValue) || (parsed > 65536)) return false;
+	value = static_cast<int>(parsed);
+	return true;
+}
+
+// function to parse a non-negative number argument, returns false if it isn't one
+static bool parseDouble(const std::string& text, double& value) {
+	char* end = nullptr;
+	double parsed = std::strtod(text.c_str(), &end);
+	if ((end == text.c_str()) || (*end != '\0') || !(parsed >= 0.0)) return false;
+	value = parsed;
+	return true;
+}
+
+// function to print how far an image is from a reference image of the same size, returns false if the sizes differ
+static bool compareImages(image& rendered, image& reference) {
+	if ((rendered.getXSize() != reference.getXSize()) || (rendered.getYSize() != reference.getYSize())) return false;
+	// the differences of the unscaled colours
+	double maxDiff = 0.0;
+	double sumSquares = 0.0;
+	double maxValue = 0.0;
+	for (int y = 0; y < rendered.getYSize(); y++) {
+		const float* pRendered = rendered.getRow(y);
+		const float* pReference = reference.getRow(y);
+		for (int x = 0; x < rendered.getXSize(); x++) {
+			for (int c = 0; c < 3; c++) {
+				double diff = std::fabs(static_cast<double>(pRendered[(x * image::NUM_CHANNELS) + c]) - pReference[(x * image::NUM_CHANNELS) + c]);
+				maxDiff = std::max(maxDiff, diff);
+				sumSquares += diff * diff;
+				maxValue = std::max(maxValue, static_cast<double>(pReference[(x * image::NUM_CHANNELS) + c]));
+			}
+		}
+	}
+	double rms = std::sqrt(sumSquares / (3.0 * rendered.getXSize() * rendered.getYSize()));
+	// the pixels that differ once both are converted for display
+	std::vector<unsigned char> renderedRGB, referenceRGB;
+	rendered.convertToRGB8(renderedRGB);
+	reference.convertToRGB8(referenceRGB);
+	int changedPixels = 0;
+	int maxStep = 0;
+	for (size_t i = 0; i < renderedRGB.size(); i += 3) {
+		int step = 0;
+		for (int c = 0; c < 3; c++) step = std::max(step, std::abs(static_cast<int>(renderedRGB[i + c]) - static_cast<int>(referenceRGB[i + c])));
+		if (step > 0) changedPixels++;
+		maxStep = std::max(maxStep, step);
+	}
+	std::cout << "compared with the reference: max difference " << maxDiff << ", rms " << rms;
+	if (rms > 0.0) std::cout << ", psnr " << 20.0 * std::log10(maxValue / rms) << " dB";
+	else std::cout << ", identical";
+	std::cout << std::endl;
+	std::cout << "8 bit pixels that differ: " << changedPixels << " of " << rendered.getXSize() * rendered.getYSize() << " (by up to " << maxStep << ")" << std::endl;
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	int xSize = 1280;
+	int ySize = 720;
+	int numThreads = 0;
+	std::string sceneFile;
+	std::string outputFile = "render.png";
+	std::string costMapName;
+	std::string compareFile;
+	RT::renderconfig defaults;
+	int maxSamples = defaults.m_maxSamples;
+	int minSamples = defaults.m_minSamples;
+	double varianceThreshold = defaults.m_varianceThreshold;
+	bool wavefront = defaults.m_wavefront;
+	bool lowDiscrepancy = defaults.m_lowDiscrepancy;
+	// read the arguments
+	for (int i = 1; i < argc; i++) {
+		std::string option = argv[i];
+		if ((option == "--help") || (option == "-h")) {
+			printUsage(argv[0]);
+			return 0;
+		}
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << option << std::endl;
+			printUsage(argv[0]);
+			return 1;
+		}
+		std::string value = argv[++i];
+		bool valid = true;
+		if (option == "--width") valid = parseInt(value, 1, xSize);
+		else if (option == "--height") valid = parseInt(value, 1, ySize);
+		else if (option == "--threads") valid = parseInt(value, 0, numThreads);
+		else if (option == "--scene") sceneFile = value;
+		else if (option == "--output") outputFile = value;
+		else if (option == "--costmap") costMapName = value;
+		else if (option == "--samples") valid = parseInt(value, 1, maxSamples);
+		else if (option == "--min-samples") valid = parseInt(value, 1, minSamples);
+		else if (option == "--threshold") valid = parseDouble(value, varianceThreshold);
+		else if (option == "--compare") compareFile = value;
+		else if (option == "--integrator") {
+			valid = (value == "recursive") || (value == "wavefront");
+			wavefront = value == "wavefront";
+		}
+		else if (option == "--sampler") {
+			valid = (value == "sobol") || (value == "random");
+			lowDiscrepancy = value == "sobol";
+		}
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			printUsage(argv[0]);
+			return 1;
+		}
+		if (!valid) {
+			std::cerr << "invalid value for " << option << ": " << value << std::endl;
+			return 1;
+		}
+	}
+	// read the reference first, so a missing one is reported before rendering
+	image referenceImage;
+	if (!compareFile.empty() && !referenceImage.loadPFM(compareFile)) {
+		std::cerr << "could not read the reference image " << compareFile << std::endl;
+		return 1;
+	}
+	// render
+	image outputImage;
+	outputImage.initialize(xSize, ySize);
+	RT::scene testScene;
+	if (!sceneFile.empty()) {
+		auto loadStart = std::chrono::steady_clock::now();
+		try {
+			testScene.loadFile(sceneFile);
+		}
+		catch (const std::exception& error) {
+			std::cerr << error.what() << std::endl;
+			return 1;
+		}
+		double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+		std::cout << "loaded " << sceneFile << " in " << loadSeconds << " s" << std::endl;
+	}
+	RT::renderconfig config = testScene.getRenderConfig();
+	config.m_numThreads = numThreads;
+	config.m_maxSamples = maxSamples;
+	config.m_minSamples = minSamples;
+	config.m_varianceThreshold = varianceThreshold;
+	config.m_wavefront = wavefront;
+	config.m_lowDiscrepancy = lowDiscrepancy;
+	testScene.setRenderConfig(config);
+	RT::costmap costMap;
+	if (!costMapName.empty()) costMap.initialize(xSize, ySize);
+	auto start = std::chrono::steady_clock::now();
+	testScene.render(outputImage, costMapName.empty() ? nullptr : &costMap);
+	double renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "rendered " << xSize << " x " << ySize << " in " << renderSeconds << " s at " << RT::getPrecisionName() << " precision" << std::endl;
+	// write the result
+	if (!outputImage.save(outputFile)) {
+		std::cerr << "could not write " << outputFile << " (the extension must be .ppm, .pfm or .png)" << std::endl;
+		return 1;
+	}
+	std::cout << "wrote " << outputFile << std::endl;
+	if (!costMapName.empty()) {
+		if (!costMap.saveHeatmap(costMapName + ".png") || !costMap.saveRaw(costMapName + ".pfm")) {
+			std::cerr << "could not write the cost map " << costMapName << ".png/.pfm" << std::endl;
+			return 1;
+		}
+		std::cout << "wrote " << costMapName << ".png and " << costMapName << ".pfm" << std::endl;
+		if (maxSamples > 1) {
+			if (!costMap.saveHeatmap(costMapName + "-samples.png", RT::costmap::COST_SAMPLES)) {
+				std::cerr << "could not write " << costMapName << "-samples.png" << std::endl;
+				return 1;
+			}
+			std::cout << "wrote " << costMapName << "-samples.png" << std::endl;
+		}
+	}
+	if (!compareFile.empty() && !compareImages(outputImage, referenceImage)) {
+		std::cerr << "the reference image " << compareFile << " is not " << xSize << " x " << ySize << std::endl;
+		return 1;
+	}
+#if defined(RT_STATS)
+	// what was counted after the render's own summary (converting the image for the output file)
+	std::cout << "output stats: " << RT::renderstats::toJSON(RT::renderstats::collect()) << std::endl;
+#endif
+	return 0;
+}
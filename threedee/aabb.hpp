@@ -0,0 +1,127 @@
+#ifndef AABB_H
+#define AABB_H
+#include <limits>
+#include <algorithm>
+#include "vecn.hpp"
+#include "affine4.hpp"
+
+namespace RT {
+	// axis-aligned bounding box
+	// the small member functions are defined inline as they sit on the hot path of every acceleration structure query
+	class aabb {
+		public:
+			// default constructor, creates an empty box (growing it by any point gives a box around that point)
+			aabb();
+			// construct from the minimum and maximum corners
+			aabb(const Vec3& minPoint, const Vec3& maxPoint);
+			// function to return a box that contains everything (used for unbounded objects)
+			static aabb infinite();
+			// functions to grow the box to contain a point or another box
+			void grow(const Vec3& point);
+			void grow(const aabb& box);
+			// function to return the box containing this box after an affine transform
+			aabb transformed(const Affine4& tfm) const;
+			// functions to query the box
+			bool isEmpty() const;
+			bool isInfinite() const;
+			Vec3 centroid() const;
+			Vec3 extent() const;
+			real surfaceArea() const;
+			int largestAxis() const;
+			// slab test against a ray given as origin + t * direction, with invDir = 1 / direction
+			// on success tNear holds the parametric distance at which the ray enters the box
+			bool intersect(const Vec3& origin, const Vec3& invDir, real tMin, real tMax, real& tNear) const;
+			// variables
+			Vec3 m_min;
+			Vec3 m_max;
+	};
+
+	inline aabb::aabb() {
+		real inf = std::numeric_limits<real>::infinity();
+		m_min = Vec3{ inf, inf, inf };
+		m_max = Vec3{ -inf, -inf, -inf };
+	}
+
+	inline aabb::aabb(const Vec3& minPoint, const Vec3& maxPoint) {
+		m_min = minPoint;
+		m_max = maxPoint;
+	}
+
+	inline aabb aabb::infinite() {
+		real inf = std::numeric_limits<real>::infinity();
+		return aabb(Vec3{ -inf, -inf, -inf }, Vec3{ inf, inf, inf });
+	}
+
+	inline void aabb::grow(const Vec3& point) {
+		for (int i = 0; i < 3; i++) {
+			m_min[i] = std::min(m_min[i], point[i]);
+			m_max[i] = std::max(m_max[i], point[i]);
+		}
+	}
+
+	inline void aabb::grow(const aabb& box) {
+		for (int i = 0; i < 3; i++) {
+			m_min[i] = std::min(m_min[i], box.m_min[i]);
+			m_max[i] = std::max(m_max[i], box.m_max[i]);
+		}
+	}
+
+	inline aabb aabb::transformed(const Affine4& tfm) const {
+		if (isEmpty() || isInfinite()) return *this;
+		// transform all eight corners and bound the result
+		aabb result;
+		for (int corner = 0; corner < 8; corner++) {
+			Vec3 point{ (corner & 1) ? m_max[0] : m_min[0], (corner & 2) ? m_max[1] : m_min[1], (corner & 4) ? m_max[2] : m_min[2] };
+			result.grow(tfm.transformPoint(point));
+		}
+		return result;
+	}
+
+	inline bool aabb::isEmpty() const {
+		return (m_min[0] > m_max[0]) || (m_min[1] > m_max[1]) || (m_min[2] > m_max[2]);
+	}
+
+	inline bool aabb::isInfinite() const {
+		for (int i = 0; i < 3; i++) {
+			if ((m_min[i] == -std::numeric_limits<real>::infinity()) || (m_max[i] == std::numeric_limits<real>::infinity())) return true;
+		}
+		return false;
+	}
+
+	inline Vec3 aabb::centroid() const {
+		return (m_min + m_max) * 0.5;
+	}
+
+	inline Vec3 aabb::extent() const {
+		return m_max - m_min;
+	}
+
+	inline real aabb::surfaceArea() const {
+		if (isEmpty()) return 0.0;
+		Vec3 e = extent();
+		return 2.0 * ((e[0] * e[1]) + (e[1] * e[2]) + (e[2] * e[0]));
+	}
+
+	inline int aabb::largestAxis() const {
+		Vec3 e = extent();
+		if ((e[0] >= e[1]) && (e[0] >= e[2])) return 0;
+		else if (e[1] >= e[2]) return 1;
+		else return 2;
+	}
+
+	inline bool aabb::intersect(const Vec3& origin, const Vec3& invDir, real tMin, real tMax, real& tNear) const {
+		for (int i = 0; i < 3; i++) {
+			real t0 = (m_min[i] - origin[i]) * invDir[i];
+			real t1 = (m_max[i] - origin[i]) * invDir[i];
+			if (invDir[i] < 0.0) std::swap(t0, t1);
+			// written so that a NaN (zero direction component with the origin on a slab plane) does not reject the box
+			tMin = (t0 > tMin) ? t0 : tMin;
+			tMax = (t1 < tMax) ? t1 : tMax;
+			if (tMax < tMin) return false;
+		}
+		tNear = tMin;
+		return true;
+	}
+}
+
+#endif
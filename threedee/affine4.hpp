@@ -0,0 +1,217 @@
+#ifndef AFFINE4_H
+#define AFFINE4_H
+#include <math.h>
+#include "vecn.hpp"
+
+// 4 x 4 homogeneous matrix restricted to affine transforms
+// the bottom row is always (0, 0, 0, 1), so only the top three rows are stored (inline, no heap allocation)
+template <class T>
+class affine4 {
+	public:
+		// default constructor, creates the identity transform
+		constexpr affine4();
+		// construct from a row-major 3 x 4 array (the top three rows of the homogeneous matrix), of any scalar type
+		template <class U>
+		constexpr explicit affine4(const U* inputData);
+		// factory functions for the elementary transforms
+		static affine4<T> translation(const vecn<T, 3>& offset);
+		static affine4<T> scale(const vecn<T, 3>& factors);
+		static affine4<T> rotationX(T angle);
+		static affine4<T> rotationY(T angle);
+		static affine4<T> rotationZ(T angle);
+		// configuration methods
+		constexpr void setToIdentity();
+		// element access methods (rows 0 to 3, the bottom row is implied)
+		constexpr T getElement(int row, int col) const;
+		constexpr void setElement(int row, int col, T elementValue);
+		// compute the inverse in place (closed form), returns false if the transform is singular
+		bool inverse();
+		// return the determinant of the linear (upper-left 3 x 3) part
+		constexpr T determinant() const;
+		// transform a point (w = 1, translation applied)
+		constexpr vecn<T, 3> transformPoint(const vecn<T, 3>& point) const;
+		// transform a direction (w = 0, translation ignored)
+		constexpr vecn<T, 3> transformDirection(const vecn<T, 3>& direction) const;
+		// transform a direction by the transpose of the linear part (used to carry normals with the inverse matrix)
+		constexpr vecn<T, 3> transformTransposed(const vecn<T, 3>& direction) const;
+		// overloaded operators
+		template <class U> friend constexpr affine4<U> operator* (const affine4<U>& lhs, const affine4<U>& rhs);
+	private:
+		T m_data[12];
+};
+
+// the affine transform type used throughout the renderer
+typedef affine4<RT::real> Affine4;
+
+// default constructor
+template <class T>
+constexpr affine4<T>::affine4() : m_data{} {
+	setToIdentity();
+}
+
+// construct from a row-major 3 x 4 array
+template <class T>
+template <class U>
+constexpr affine4<T>::affine4(const U* inputData) : m_data{} {
+	for (int i = 0; i < 12; i++) m_data[i] = static_cast<T>(inputData[i]);
+}
+
+// factory functions
+template <class T>
+affine4<T> affine4<T>::translation(const vecn<T, 3>& offset) {
+	affine4<T> result;
+	result.m_data[3] = offset.getElement(0);
+	result.m_data[7] = offset.getElement(1);
+	result.m_data[11] = offset.getElement(2);
+	return result;
+}
+
+template <class T>
+affine4<T> affine4<T>::scale(const vecn<T, 3>& factors) {
+	affine4<T> result;
+	result.m_data[0] = factors.getElement(0);
+	result.m_data[5] = factors.getElement(1);
+	result.m_data[10] = factors.getElement(2);
+	return result;
+}
+
+// note: the rotation matrices follow the sign convention GTform has always used
+template <class T>
+affine4<T> affine4<T>::rotationX(T angle) {
+	affine4<T> result;
+	result.m_data[5] = cos(angle);
+	result.m_data[6] = sin(angle);
+	result.m_data[9] = -sin(angle);
+	result.m_data[10] = cos(angle);
+	return result;
+}
+
+template <class T>
+affine4<T> affine4<T>::rotationY(T angle) {
+	affine4<T> result;
+	result.m_data[0] = cos(angle);
+	result.m_data[2] = -sin(angle);
+	result.m_data[8] = sin(angle);
+	result.m_data[10] = cos(angle);
+	return result;
+}
+
+template <class T>
+affine4<T> affine4<T>::rotationZ(T angle) {
+	affine4<T> result;
+	result.m_data[0] = cos(angle);
+	result.m_data[1] = sin(angle);
+	result.m_data[4] = -sin(angle);
+	result.m_data[5] = cos(angle);
+	return result;
+}
+
+// function to convert the existing matrix into an identity matrix
+template <class T>
+constexpr void affine4<T>::setToIdentity() {
+	for (int i = 0; i < 12; i++) m_data[i] = static_cast<T>(0.0);
+	m_data[0] = static_cast<T>(1.0);
+	m_data[5] = static_cast<T>(1.0);
+	m_data[10] = static_cast<T>(1.0);
+}
+
+// function to get element
+template <class T>
+constexpr T affine4<T>::getElement(int row, int col) const {
+	if (row < 3) return m_data[(row * 4) + col];
+	// the implied bottom row
+	else return (col == 3) ? static_cast<T>(1.0) : static_cast<T>(0.0);
+}
+
+// function to set element (the bottom row cannot be changed)
+template <class T>
+constexpr void affine4<T>::setElement(int row, int col, T elementValue) {
+	if (row < 3) m_data[(row * 4) + col] = elementValue;
+}
+
+// compute the inverse in closed form
+// for M = [A | t], the inverse is [A^-1 | -A^-1 t], and A^-1 is the adjugate of A divided by its determinant
+template <class T>
+bool affine4<T>::inverse() {
+	const T* m = m_data;
+	T det = determinant();
+	if (fabs(det) < 1e-12) return false;
+	T invDet = static_cast<T>(1.0) / det;
+	// cofactors of the linear part
+	T a00 = (m[5] * m[10] - m[6] * m[9]) * invDet;
+	T a01 = (m[2] * m[9] - m[1] * m[10]) * invDet;
+	T a02 = (m[1] * m[6] - m[2] * m[5]) * invDet;
+	T a10 = (m[6] * m[8] - m[4] * m[10]) * invDet;
+	T a11 = (m[0] * m[10] - m[2] * m[8]) * invDet;
+	T a12 = (m[2] * m[4] - m[0] * m[6]) * invDet;
+	T a20 = (m[4] * m[9] - m[5] * m[8]) * invDet;
+	T a21 = (m[1] * m[8] - m[0] * m[9]) * invDet;
+	T a22 = (m[0] * m[5] - m[1] * m[4]) * invDet;
+	// the translation part
+	T tx = m[3];
+	T ty = m[7];
+	T tz = m[11];
+	T inv[12] = {
+		a00, a01, a02, -(a00 * tx + a01 * ty + a02 * tz),
+		a10, a11, a12, -(a10 * tx + a11 * ty + a12 * tz),
+		a20, a21, a22, -(a20 * tx + a21 * ty + a22 * tz)
+	};
+	for (int i = 0; i < 12; i++) m_data[i] = inv[i];
+	return true;
+}
+
+// return the determinant of the linear part
+template <class T>
+constexpr T affine4<T>::determinant() const {
+	const T* m = m_data;
+	return m[0] * (m[5] * m[10] - m[6] * m[9]) - m[1] * (m[4] * m[10] - m[6] * m[8]) + m[2] * (m[4] * m[9] - m[5] * m[8]);
+}
+
+// transform a point
+template <class T>
+constexpr vecn<T, 3> affine4<T>::transformPoint(const vecn<T, 3>& point) const {
+	const T* m = m_data;
+	return vecn<T, 3>{
+		m[0] * point[0] + m[1] * point[1] + m[2] * point[2] + m[3],
+		m[4] * point[0] + m[5] * point[1] + m[6] * point[2] + m[7],
+		m[8] * point[0] + m[9] * point[1] + m[10] * point[2] + m[11] };
+}
+
+// transform a direction
+template <class T>
+constexpr vecn<T, 3> affine4<T>::transformDirection(const vecn<T, 3>& direction) const {
+	const T* m = m_data;
+	return vecn<T, 3>{
+		m[0] * direction[0] + m[1] * direction[1] + m[2] * direction[2],
+		m[4] * direction[0] + m[5] * direction[1] + m[6] * direction[2],
+		m[8] * direction[0] + m[9] * direction[1] + m[10] * direction[2] };
+}
+
+// transform a direction by the transpose of the linear part
+template <class T>
+constexpr vecn<T, 3> affine4<T>::transformTransposed(const vecn<T, 3>& direction) const {
+	const T* m = m_data;
+	return vecn<T, 3>{
+		m[0] * direction[0] + m[4] * direction[1] + m[8] * direction[2],
+		m[1] * direction[0] + m[5] * direction[1] + m[9] * direction[2],
+		m[2] * direction[0] + m[6] * direction[1] + m[10] * direction[2] };
+}
+
+// function for affine * affine
+template <class T>
+constexpr affine4<T> operator* (const affine4<T>& lhs, const affine4<T>& rhs) {
+	const T* a = lhs.m_data;
+	const T* b = rhs.m_data;
+	affine4<T> result;
+	for (int row = 0; row < 3; row++) {
+		for (int col = 0; col < 4; col++) {
+			T elementResult = (a[row * 4] * b[col]) + (a[(row * 4) + 1] * b[4 + col]) + (a[(row * 4) + 2] * b[8 + col]);
+			// the implied bottom row of the rhs contributes only to the translation column
+			if (col == 3) elementResult += a[(row * 4) + 3];
+			result.m_data[(row * 4) + col] = elementResult;
+		}
+	}
+	return result;
+}
+
+#endif
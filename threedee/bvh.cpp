@@ -0,0 +1,504 @@
+#include "bvh.hpp"
+#include "renderstats.hpp"
+#include "objsphere.hpp"
+#include "objplane.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// build parameters
+constexpr int BVH_NUM_BINS = 12; // number of bins used when evaluating SAH splits
+constexpr int BVH_MAX_LEAF_SIZE = 4; // nodes larger than this are always split when possible
+constexpr double BVH_TRAVERSAL_COST = 0.125; // cost of visiting a node relative to testing an object
+
+// entry on the traversal stack, the node index and the distance at which the ray enters its box
+struct bvhStackEntry {
+	int m_node;
+	double m_tNear;
+};
+
+// constructor
+RT::bvh::bvh() {
+	m_depth = 0;
+}
+
+// destructor
+RT::bvh::~bvh() {
+
+}
+
+// function to build the hierarchy
+void RT::bvh::build(const std::vector<std::shared_ptr<RT::objectbase>>& objectList) {
+	RT_STAT_PHASE(PHASE_BVH_BUILD);
+	m_objectList = objectList;
+	m_objects.clear();
+	m_nodes.clear();
+	m_primIndices.clear();
+	m_unbounded.clear();
+	m_depth = 0;
+	// compute the world space bounds of every object once
+	int numObjects = static_cast<int>(objectList.size());
+	std::vector<RT::aabb> primBounds(numObjects);
+	for (int i = 0; i < numObjects; i++) {
+		m_objects.push_back(objectList[i].get());
+		RT::aabb bounds = objectList[i]->getWorldBounds();
+		// objects that can't be bounded are kept out of the hierarchy and tested separately
+		if (bounds.isInfinite() || bounds.isEmpty()) {
+			m_unbounded.push_back(i);
+		}
+		else {
+			primBounds[i] = bounds;
+			m_primIndices.push_back(i);
+		}
+	}
+	classifyObjects();
+	// build the hierarchy over the bounded objects
+	m_depth = buildHierarchy(primBounds, m_primIndices, m_nodes);
+}
+
+// function to sort the objects into the arrays for their types
+void RT::bvh::classifyObjects() {
+	m_primRefs.clear();
+	m_spheres.clear();
+	m_planes.clear();
+	for (int i = 0; i < static_cast<int>(m_objects.size()); i++) {
+		RT::objectbase* object = m_objects[i];
+		primref ref{ object->getWorldBounds(), object->getPrimitiveType(), i };
+		switch (ref.m_type) {
+			case RT::PRIMITIVE_SPHERE:
+				ref.m_slot = static_cast<int>(m_spheres.size());
+				m_spheres.push_back(static_cast<RT::objsphere*>(object));
+				break;
+			case RT::PRIMITIVE_PLANE:
+				ref.m_slot = static_cast<int>(m_planes.size());
+				m_planes.push_back(static_cast<RT::objplane*>(object));
+				break;
+			default:
+				ref.m_type = RT::PRIMITIVE_OTHER;
+				break;
+		}
+		m_primRefs.push_back(ref);
+	}
+}
+
+// functions to test a single object
+// the sphere and plane classes are final, so these calls are resolved at compile time
+inline bool RT::bvh::intersectPrimitive(int objIndex, const RT::ray& castRay, RT::real tMax, RT::hitrecord& hit) const {
+	const primref& ref = m_primRefs[objIndex];
+	switch (ref.m_type) {
+		case RT::PRIMITIVE_SPHERE: return m_spheres[ref.m_slot]->intersect(castRay, tMax, hit);
+		case RT::PRIMITIVE_PLANE: return m_planes[ref.m_slot]->intersect(castRay, tMax, hit);
+		default: return m_objects[ref.m_slot]->intersect(castRay, tMax, hit);
+	}
+}
+
+inline bool RT::bvh::occludedPrimitive(int objIndex, const RT::ray& castRay, RT::real tMax) const {
+	const primref& ref = m_primRefs[objIndex];
+	switch (ref.m_type) {
+		case RT::PRIMITIVE_SPHERE: return m_spheres[ref.m_slot]->occluded(castRay, tMax);
+		case RT::PRIMITIVE_PLANE: return m_planes[ref.m_slot]->occluded(castRay, tMax);
+		default: return m_objects[ref.m_slot]->occluded(castRay, tMax);
+	}
+}
+
+inline int RT::bvh::intersectPrimitivePacket(int objIndex, const RT::raypacket& rays, double* tHit) const {
+	const primref& ref = m_primRefs[objIndex];
+	switch (ref.m_type) {
+		case RT::PRIMITIVE_SPHERE: return m_spheres[ref.m_slot]->intersectPacket(rays, tHit);
+		case RT::PRIMITIVE_PLANE: return m_planes[ref.m_slot]->intersectPacket(rays, tHit);
+		default: return m_objects[ref.m_slot]->intersectPacket(rays, tHit);
+	}
+}
+
+// function to build a hierarchy over a set of bounded primitives
+int RT::bvh::buildHierarchy(const std::vector<RT::aabb>& primBounds, std::vector<int>& primIndices, std::vector<node>& nodes) {
+	nodes.clear();
+	int numPrims = static_cast<int>(primIndices.size());
+	if (numPrims == 0) return 0;
+	std::vector<Vec3> primCentroids(primBounds.size());
+	for (int index : primIndices) primCentroids[index] = primBounds[index].centroid();
+	nodes.reserve(2 * numPrims);
+	int maxDepth = 0;
+	buildNode(primBounds, primCentroids, 0, numPrims, 1, primIndices, nodes, maxDepth);
+	return maxDepth;
+}
+
+// function to build the subtree over primIndices[first, first + count)
+int RT::bvh::buildNode(const std::vector<RT::aabb>& primBounds, const std::vector<Vec3>& primCentroids, int first, int count, int depth, std::vector<int>& primIndices, std::vector<node>& nodes, int& maxDepth) {
+	maxDepth = std::max(maxDepth, depth);
+	// create the node (its children are appended after it, so only refer to it by index from here on)
+	int nodeIndex = static_cast<int>(nodes.size());
+	nodes.push_back(node());
+	// compute the bounds of the objects and of their centroids
+	RT::aabb bounds;
+	RT::aabb centroidBounds;
+	for (int i = first; i < first + count; i++) {
+		bounds.grow(primBounds[primIndices[i]]);
+		centroidBounds.grow(primCentroids[primIndices[i]]);
+	}
+	nodes[nodeIndex].m_bounds = bounds;
+	nodes[nodeIndex].m_index = first;
+	nodes[nodeIndex].m_count = count;
+	// small nodes, and nodes at the depth limit, become leaves
+	if ((count <= 2) || (depth >= BVH_MAX_DEPTH)) return nodeIndex;
+	// find the cheapest split by binning the centroids along each axis
+	double bestCost = std::numeric_limits<double>::infinity();
+	int bestAxis = -1;
+	int bestSplit = -1;
+	for (int axis = 0; axis < 3; axis++) {
+		double cMin = centroidBounds.m_min[axis];
+		double cMax = centroidBounds.m_max[axis];
+		if (cMax <= cMin) continue;
+		// place each object into a bin
+		RT::aabb binBounds[BVH_NUM_BINS];
+		int binCounts[BVH_NUM_BINS] = { 0 };
+		double binScale = BVH_NUM_BINS / (cMax - cMin);
+		for (int i = first; i < first + count; i++) {
+			int bin = std::min(BVH_NUM_BINS - 1, static_cast<int>((primCentroids[primIndices[i]][axis] - cMin) * binScale));
+			binCounts[bin]++;
+			binBounds[bin].grow(primBounds[primIndices[i]]);
+		}
+		// sweep from the left to get the area and count to the left of each split plane
+		double leftArea[BVH_NUM_BINS - 1];
+		int leftCount[BVH_NUM_BINS - 1];
+		RT::aabb leftBox;
+		int leftSum = 0;
+		for (int i = 0; i < BVH_NUM_BINS - 1; i++) {
+			leftBox.grow(binBounds[i]);
+			leftSum += binCounts[i];
+			leftArea[i] = leftBox.surfaceArea();
+			leftCount[i] = leftSum;
+		}
+		// sweep from the right and evaluate the SAH cost of each split plane
+		RT::aabb rightBox;
+		int rightSum = 0;
+		for (int i = BVH_NUM_BINS - 1; i > 0; i--) {
+			rightBox.grow(binBounds[i]);
+			rightSum += binCounts[i];
+			if ((leftCount[i - 1] == 0) || (rightSum == 0)) continue;
+			double cost = (leftCount[i - 1] * leftArea[i - 1]) + (rightSum * rightBox.surfaceArea());
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = i;
+			}
+		}
+	}
+	// partition the objects
+	int mid;
+	if (bestAxis == -1) {
+		// all of the centroids coincide, so no plane separates them
+		if (count <= BVH_MAX_LEAF_SIZE) return nodeIndex;
+		mid = first + (count / 2);
+	}
+	else {
+		// compare against the cost of not splitting at all (both relative to the area of this node)
+		double splitCost = (BVH_TRAVERSAL_COST * bounds.surfaceArea()) + bestCost;
+		double leafCost = count * bounds.surfaceArea();
+		if ((count <= BVH_MAX_LEAF_SIZE) && (leafCost <= splitCost)) return nodeIndex;
+		double cMin = centroidBounds.m_min[bestAxis];
+		double binScale = BVH_NUM_BINS / (centroidBounds.m_max[bestAxis] - cMin);
+		auto midIter = std::partition(primIndices.begin() + first, primIndices.begin() + first + count, [&](int index) {
+			int bin = std::min(BVH_NUM_BINS - 1, static_cast<int>((primCentroids[index][bestAxis] - cMin) * binScale));
+			return bin < bestSplit;
+		});
+		mid = static_cast<int>(midIter - primIndices.begin());
+		if ((mid == first) || (mid == first + count)) mid = first + (count / 2);
+	}
+	// build the children, the first child directly follows this node
+	buildNode(primBounds, primCentroids, first, mid - first, depth + 1, primIndices, nodes, maxDepth);
+	int secondChild = buildNode(primBounds, primCentroids, mid, first + count - mid, depth + 1, primIndices, nodes, maxDepth);
+	nodes[nodeIndex].m_index = secondChild;
+	nodes[nodeIndex].m_count = 0;
+	return nodeIndex;
+}
+
+// function to restore a saved hierarchy
+// the nodes refer to objects by their index, so this is only valid for the list of objects the hierarchy was built over
+bool RT::bvh::restore(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const node* nodes, int numNodes, const int* primIndices, int numPrimIndices, const int* unbounded, int numUnbounded) {
+	m_objectList.clear();
+	m_objects.clear();
+	m_primRefs.clear();
+	m_spheres.clear();
+	m_planes.clear();
+	m_nodes.clear();
+	m_primIndices.clear();
+	m_unbounded.clear();
+	m_depth = 0;
+	// check every index before using any of them, the traversal doesn't check anything
+	int numObjects = static_cast<int>(objectList.size());
+	for (int i = 0; i < numPrimIndices; i++) {
+		if ((primIndices[i] < 0) || (primIndices[i] >= numObjects)) return false;
+	}
+	for (int i = 0; i < numUnbounded; i++) {
+		if ((unbounded[i] < 0) || (unbounded[i] >= numObjects)) return false;
+	}
+	// children always come after their parent, so the depth of every node is known by the time it is reached
+	// (this also rules out cycles, and trees too deep for the traversal stack)
+	std::vector<int> nodeDepths(numNodes, 0);
+	if (numNodes > 0) nodeDepths[0] = 1;
+	int maxDepth = 0;
+	for (int i = 0; i < numNodes; i++) {
+		if ((nodeDepths[i] == 0) || (nodeDepths[i] > BVH_MAX_DEPTH)) return false;
+		maxDepth = std::max(maxDepth, nodeDepths[i]);
+		if (nodes[i].m_count > 0) {
+			if ((nodes[i].m_index < 0) || (nodes[i].m_index > numPrimIndices - nodes[i].m_count)) return false;
+		}
+		else {
+			if ((nodes[i].m_count < 0) || (i + 1 >= numNodes) || (nodes[i].m_index <= i + 1) || (nodes[i].m_index >= numNodes)) return false;
+			nodeDepths[i + 1] = std::max(nodeDepths[i + 1], nodeDepths[i] + 1);
+			nodeDepths[nodes[i].m_index] = std::max(nodeDepths[nodes[i].m_index], nodeDepths[i] + 1);
+		}
+	}
+	m_objectList = objectList;
+	m_objects.reserve(objectList.size());
+	for (const auto& object : objectList) m_objects.push_back(object.get());
+	classifyObjects();
+	m_nodes.assign(nodes, nodes + numNodes);
+	m_primIndices.assign(primIndices, primIndices + numPrimIndices);
+	m_unbounded.assign(unbounded, unbounded + numUnbounded);
+	m_depth = maxDepth;
+	return true;
+}
+
+// functions to return the flattened hierarchy
+const std::vector<RT::bvh::node>& RT::bvh::getNodes() const {
+	return m_nodes;
+}
+
+const std::vector<int>& RT::bvh::getPrimIndices() const {
+	return m_primIndices;
+}
+
+const std::vector<int>& RT::bvh::getUnbounded() const {
+	return m_unbounded;
+}
+
+// function to return the list of objects
+const std::vector<std::shared_ptr<RT::objectbase>>& RT::bvh::getObjectList() const {
+	return m_objectList;
+}
+
+// function to find the closest object hit by a ray before tMax
+// each object only reports a hit closer than the closest so far, so the search limit shrinks as hits are found
+int RT::bvh::intersect(const RT::ray& castRay, RT::real tMax, const RT::objectbase* skipObject, RT::hitrecord& hit) const {
+	int closestIndex = -1;
+	RT::real tBest = tMax;
+	const Vec3& origin = castRay.m_point1;
+	Vec3 invDir = castRay.m_lab.reciprocal();
+	// function to test a single object and keep it if it is the closest so far
+	RT::hitrecord objectHit;
+	auto testObject = [&](int objIndex) {
+		RT::real tNear;
+		if ((m_objects[objIndex] == skipObject) || !m_primRefs[objIndex].m_bounds.intersect(origin, invDir, 0.0, tBest, tNear)) return;
+		objectHit.m_groupPath = 0;
+		if (intersectPrimitive(objIndex, castRay, tBest, objectHit)) {
+			tBest = objectHit.m_t;
+			closestIndex = objIndex;
+			hit = objectHit;
+		}
+	};
+	// objects without bounds have to be tested every time
+	for (int objIndex : m_unbounded) testObject(objIndex);
+	// traverse the hierarchy front to back, skipping any node that starts beyond the closest hit found so far
+	if (!m_nodes.empty()) {
+		bvhStackEntry stack[BVH_MAX_DEPTH + 4];
+		int stackSize = 0;
+		RT::real tNear;
+		if (m_nodes[0].m_bounds.intersect(origin, invDir, 0.0, tBest, tNear)) stack[stackSize++] = bvhStackEntry{ 0, tNear };
+		while (stackSize > 0) {
+			bvhStackEntry entry = stack[--stackSize];
+			if (entry.m_tNear > tBest) continue;
+			RT_STAT_COUNT(STAT_BVH_NODES);
+			const node& currentNode = m_nodes[entry.m_node];
+			if (currentNode.m_count > 0) {
+				// leaf, test the objects
+				for (int i = currentNode.m_index; i < currentNode.m_index + currentNode.m_count; i++) testObject(m_primIndices[i]);
+			}
+			else {
+				// interior node, test both children and visit the nearer one first
+				int childA = entry.m_node + 1;
+				int childB = currentNode.m_index;
+				RT::real tA = 0.0, tB = 0.0;
+				bool hitA = m_nodes[childA].m_bounds.intersect(origin, invDir, 0.0, tBest, tA);
+				bool hitB = m_nodes[childB].m_bounds.intersect(origin, invDir, 0.0, tBest, tB);
+				if (hitA && hitB) {
+					if (tA <= tB) {
+						stack[stackSize++] = bvhStackEntry{ childB, tB };
+						stack[stackSize++] = bvhStackEntry{ childA, tA };
+					}
+					else {
+						stack[stackSize++] = bvhStackEntry{ childA, tA };
+						stack[stackSize++] = bvhStackEntry{ childB, tB };
+					}
+				}
+				else if (hitA) stack[stackSize++] = bvhStackEntry{ childA, tA };
+				else if (hitB) stack[stackSize++] = bvhStackEntry{ childB, tB };
+			}
+		}
+	}
+	return closestIndex;
+}
+
+// function to find the closest object hit by a ray and compute the shading data of the hit
+bool RT::bvh::castRay(const RT::ray& castRay, const std::shared_ptr<RT::objectbase>& thisObject, std::shared_ptr<RT::objectbase>& closestObject, Vec3& closestIntPoint, Vec3& closestLocalNormal, Vec3& closestLocalColor) const {
+	int closestIndex = this->castRay(castRay, thisObject.get(), closestIntPoint, closestLocalNormal, closestLocalColor);
+	if (closestIndex < 0) return false;
+	closestObject = m_objectList[closestIndex];
+	return true;
+}
+
+int RT::bvh::castRay(const RT::ray& castRay, const RT::objectbase* thisObject, Vec3& closestIntPoint, Vec3& closestLocalNormal, Vec3& closestLocalColor) const {
+	RT::hitrecord hit;
+	const RT::objectbase* skipObject = ((thisObject != nullptr) && !thisObject->canHitItself()) ? thisObject : nullptr;
+	int closestIndex = intersect(castRay, std::numeric_limits<RT::real>::infinity(), skipObject, hit);
+	if (closestIndex >= 0) m_objects[closestIndex]->computeHitData(castRay, hit, closestIntPoint, closestLocalNormal, closestLocalColor);
+	return closestIndex;
+}
+
+// function to find the closest object hit by each lane of a packet
+int RT::bvh::castPacket(const RT::raypacket& rays, RT::packethit& hits) const {
+	// the search is unlimited, as for castRay
+	for (int i = 0; i < RT::PACKET_SIZE; i++) {
+		hits.m_t[i] = std::numeric_limits<double>::infinity();
+		hits.m_index[i] = -1;
+	}
+	tracePacket(rays, hits);
+	int hitMask = 0;
+	for (int i = 0; i < rays.m_numRays; i++) {
+		if (hits.m_index[i] >= 0) hitMask |= 1 << i;
+	}
+	return hitMask;
+}
+
+// function to carry on a packet search from the limits in hits.m_t
+int RT::bvh::tracePacket(const RT::raypacket& rays, RT::packethit& hits) const {
+	int updatedMask = 0;
+	// function to test a single object against the whole packet and record the lanes for which it is now the closest
+	double tNear;
+	auto testObject = [&](int objIndex) {
+		if (intersectBox(m_primRefs[objIndex].m_bounds, rays, hits, tNear) == 0) return;
+		int hitMask = intersectPrimitivePacket(objIndex, rays, hits.m_t);
+		updatedMask |= hitMask;
+		for (int i = 0; hitMask != 0; i++, hitMask >>= 1) {
+			if (hitMask & 1) hits.m_index[i] = objIndex;
+		}
+	};
+	// objects without bounds have to be tested every time
+	for (int objIndex : m_unbounded) testObject(objIndex);
+	// traverse the hierarchy as for castRay, a node is visited if any lane enters it before that lane's closest hit
+	if (!m_nodes.empty()) {
+		bvhStackEntry stack[BVH_MAX_DEPTH + 4];
+		int stackSize = 0;
+		if (intersectBox(m_nodes[0].m_bounds, rays, hits, tNear)) stack[stackSize++] = bvhStackEntry{ 0, tNear };
+		while (stackSize > 0) {
+			bvhStackEntry entry = stack[--stackSize];
+			// skip the node if every lane has already found something closer
+			double tFar = hits.m_t[0];
+			for (int i = 1; i < rays.m_numRays; i++) tFar = std::max(tFar, hits.m_t[i]);
+			if (entry.m_tNear > tFar) continue;
+			RT_STAT_COUNT(STAT_BVH_NODES);
+			const node& currentNode = m_nodes[entry.m_node];
+			if (currentNode.m_count > 0) {
+				for (int i = currentNode.m_index; i < currentNode.m_index + currentNode.m_count; i++) testObject(m_primIndices[i]);
+			}
+			else {
+				// visit the child that the packet enters first before the other one
+				int childA = entry.m_node + 1;
+				int childB = currentNode.m_index;
+				double tA, tB;
+				bool hitA = intersectBox(m_nodes[childA].m_bounds, rays, hits, tA) != 0;
+				bool hitB = intersectBox(m_nodes[childB].m_bounds, rays, hits, tB) != 0;
+				if (hitA && hitB) {
+					if (tA <= tB) {
+						stack[stackSize++] = bvhStackEntry{ childB, tB };
+						stack[stackSize++] = bvhStackEntry{ childA, tA };
+					}
+					else {
+						stack[stackSize++] = bvhStackEntry{ childA, tA };
+						stack[stackSize++] = bvhStackEntry{ childB, tB };
+					}
+				}
+				else if (hitA) stack[stackSize++] = bvhStackEntry{ childA, tA };
+				else if (hitB) stack[stackSize++] = bvhStackEntry{ childB, tB };
+			}
+		}
+	}
+	return updatedMask;
+}
+
+// function to test a box against a packet, four lanes at a time
+int RT::bvh::intersectBox(const RT::aabb& box, const RT::raypacket& rays, const RT::packethit& hits, double& tNear) const {
+	int hitMask = 0;
+	alignas(32) double laneNear[RT::PACKET_SIZE];
+	for (int first = 0; first < RT::PACKET_SIZE; first += RT::simd4d::WIDTH) {
+		RT::simdvec3 origin = RT::loadOrigins(rays, first);
+		RT::simdvec3 invDir{ RT::simd4d::load(rays.m_invDirX + first), RT::simd4d::load(rays.m_invDirY + first), RT::simd4d::load(rays.m_invDirZ + first) };
+		RT::simd4d tMin(0.0);
+		RT::simd4d tMax = RT::simd4d::load(hits.m_t + first);
+		// slab test on each axis, written as in aabb::intersect so that a NaN leaves tMin and tMax unchanged
+		RT::simd4d t0 = (RT::simd4d(box.m_min[0]) - origin.m_x) * invDir.m_x;
+		RT::simd4d t1 = (RT::simd4d(box.m_max[0]) - origin.m_x) * invDir.m_x;
+		tMin = RT::simd4d::max(RT::simd4d::min(t0, t1), tMin);
+		tMax = RT::simd4d::min(RT::simd4d::max(t0, t1), tMax);
+		t0 = (RT::simd4d(box.m_min[1]) - origin.m_y) * invDir.m_y;
+		t1 = (RT::simd4d(box.m_max[1]) - origin.m_y) * invDir.m_y;
+		tMin = RT::simd4d::max(RT::simd4d::min(t0, t1), tMin);
+		tMax = RT::simd4d::min(RT::simd4d::max(t0, t1), tMax);
+		t0 = (RT::simd4d(box.m_min[2]) - origin.m_z) * invDir.m_z;
+		t1 = (RT::simd4d(box.m_max[2]) - origin.m_z) * invDir.m_z;
+		tMin = RT::simd4d::max(RT::simd4d::min(t0, t1), tMin);
+		tMax = RT::simd4d::min(RT::simd4d::max(t0, t1), tMax);
+		hitMask |= (tMin <= tMax).movemask() << first;
+		tMin.store(laneNear + first);
+	}
+	hitMask &= (1 << rays.m_numRays) - 1;
+	// the nearest point at which any lane enters the box
+	tNear = std::numeric_limits<double>::infinity();
+	for (int i = 0; i < rays.m_numRays; i++) {
+		if (hitMask & (1 << i)) tNear = std::min(tNear, laneNear[i]);
+	}
+	return hitMask;
+}
+
+// function to test whether any object is hit before tMax
+bool RT::bvh::occluded(const RT::ray& castRay, RT::real tMax, const RT::objectbase* thisObject) const {
+	const RT::objectbase* skipObject = ((thisObject != nullptr) && !thisObject->canHitItself()) ? thisObject : nullptr;
+	for (int objIndex : m_unbounded) {
+		if ((m_objects[objIndex] != skipObject) && occludedPrimitive(objIndex, castRay, tMax)) return true;
+	}
+	if (m_nodes.empty()) return false;
+	// any hit will do, so the traversal order doesn't matter
+	const Vec3& origin = castRay.m_point1;
+	Vec3 invDir = castRay.m_lab.reciprocal();
+	int stack[BVH_MAX_DEPTH + 4];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		int nodeIndex = stack[--stackSize];
+		const node& currentNode = m_nodes[nodeIndex];
+		RT_STAT_COUNT(STAT_BVH_NODES);
+		RT::real tNear;
+		if (!currentNode.m_bounds.intersect(origin, invDir, 0.0, tMax, tNear)) continue;
+		if (currentNode.m_count > 0) {
+			for (int i = currentNode.m_index; i < currentNode.m_index + currentNode.m_count; i++) {
+				int objIndex = m_primIndices[i];
+				if ((m_objects[objIndex] != skipObject) && m_primRefs[objIndex].m_bounds.intersect(origin, invDir, 0.0, tMax, tNear) && occludedPrimitive(objIndex, castRay, tMax)) return true;
+			}
+		}
+		else {
+			stack[stackSize++] = currentNode.m_index;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+	return false;
+}
+
+// functions to return information about the hierarchy
+int RT::bvh::getNodeCount() const {
+	return static_cast<int>(m_nodes.size());
+}
+
+int RT::bvh::getDepth() const {
+	return m_depth;
+}
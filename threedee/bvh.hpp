@@ -0,0 +1,105 @@
+#ifndef BVH_H
+#define BVH_H
+#include <memory>
+#include <vector>
+#include "vecn.hpp"
+#include "ray.hpp"
+#include "aabb.hpp"
+#include "raypacket.hpp"
+#include "objectbase.hpp"
+
+namespace RT {
+	// the object types that are tested directly rather than through a virtual call
+	class objsphere;
+	class objplane;
+
+	// depth limit when building a hierarchy (traversal stacks are sized from this)
+	constexpr int BVH_MAX_DEPTH = 60;
+
+	// bounding volume hierarchy over the objects in a scene
+	// built with binned SAH splits and stored as a flat array of nodes in depth-first order
+	// (the first child of an interior node always directly follows it)
+	// each object in a leaf is only tested once the ray has passed the slab test against its own world bounds
+	// the objects are also sorted by concrete type (see objectbase::getPrimitiveType), so spheres and planes are tested with direct calls
+	// and only other types go through the virtual functions
+	class bvh {
+		public:
+			// constructor and destructor
+			bvh();
+			~bvh();
+			// function to build the hierarchy over a list of objects
+			void build(const std::vector<std::shared_ptr<RT::objectbase>>& objectList);
+			// function to return the list of objects the hierarchy was built over
+			const std::vector<std::shared_ptr<RT::objectbase>>& getObjectList() const;
+			// function to find the closest object hit by a ray at a parameter t < tMax, skipObject (if set) is skipped
+			// returns the index of the object in getObjectList() (-1 if nothing is hit), no shading data is computed
+			int intersect(const RT::ray& castRay, real tMax, const RT::objectbase* skipObject, RT::hitrecord& hit) const;
+			// function to find the closest object hit by a ray and compute the shading data of that hit only, thisObject (if set) is skipped if the ray can't hit it again (see objectbase::canHitItself)
+			bool castRay(const RT::ray& castRay, const std::shared_ptr<RT::objectbase>& thisObject, std::shared_ptr<RT::objectbase>& closestObject, Vec3& closestIntPoint, Vec3& closestLocalNormal, Vec3& closestLocalColor) const;
+			// the same without shared pointers (so no reference count is touched), returns the index of the object in getObjectList() (-1 if nothing is hit)
+			int castRay(const RT::ray& castRay, const RT::objectbase* thisObject, Vec3& closestIntPoint, Vec3& closestLocalNormal, Vec3& closestLocalColor) const;
+			// function to find the closest object hit by each lane of a packet, returns a bitmask of the lanes that hit something
+			// hits.m_index[lane] is the index of the object in getObjectList(), shading data is left to the caller
+			int castPacket(const RT::raypacket& rays, RT::packethit& hits) const;
+			// function to carry on a packet search from the limits already in hits.m_t (for lanes that find nothing closer, hits is left alone)
+			// returns a bitmask of the lanes that found something closer, used by objects that hold a hierarchy of their own
+			int tracePacket(const RT::raypacket& rays, RT::packethit& hits) const;
+			// function to test whether any object is hit at a ray parameter t < tMax, thisObject is skipped as for castRay
+			// (the ray is m_point1 + t * m_lab, so tMax = 1 tests the segment from m_point1 to m_point2)
+			bool occluded(const RT::ray& castRay, real tMax, const RT::objectbase* thisObject) const;
+			// a node of the hierarchy
+			// for a leaf, m_index is the first entry in m_primIndices and m_count is the number of objects
+			// for an interior node, m_index is the second child and m_count is zero
+			struct node {
+				RT::aabb m_bounds;
+				int m_index;
+				int m_count;
+			};
+			// function to build a hierarchy over the primitives listed in primIndices, whose bounds are primBounds[index] (they must all be finite)
+			// on return primIndices is in leaf order, and the depth of the hierarchy is returned
+			// (this is the builder behind build(), and is shared with the per-mesh hierarchies in meshdata)
+			static int buildHierarchy(const std::vector<RT::aabb>& primBounds, std::vector<int>& primIndices, std::vector<node>& nodes);
+			// function to restore a hierarchy saved from getNodes(), getPrimIndices() and getUnbounded() after building over the same list of objects
+			// returns false (leaving the hierarchy empty) if the arrays don't describe a valid hierarchy over objectList
+			bool restore(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const node* nodes, int numNodes, const int* primIndices, int numPrimIndices, const int* unbounded, int numUnbounded);
+			// functions to return the flattened hierarchy
+			const std::vector<node>& getNodes() const;
+			const std::vector<int>& getPrimIndices() const;
+			const std::vector<int>& getUnbounded() const;
+			// functions to return information about the hierarchy
+			int getNodeCount() const;
+			int getDepth() const;
+		private:
+			// function to test a box against a packet, returns a bitmask of the lanes that enter it before hits.m_t and the nearest entry point
+			int intersectBox(const RT::aabb& box, const RT::raypacket& rays, const RT::packethit& hits, double& tNear) const;
+			// function to build the subtree over primIndices[first, first + count), returns the node index
+			static int buildNode(const std::vector<RT::aabb>& primBounds, const std::vector<Vec3>& primCentroids, int first, int count, int depth, std::vector<int>& primIndices, std::vector<node>& nodes, int& maxDepth);
+			// function to sort m_objects into the arrays for their types
+			void classifyObjects();
+			// functions to test object objIndex, calling the function of its concrete type directly when that is known
+			bool intersectPrimitive(int objIndex, const RT::ray& castRay, real tMax, RT::hitrecord& hit) const;
+			bool occludedPrimitive(int objIndex, const RT::ray& castRay, real tMax) const;
+			int intersectPrimitivePacket(int objIndex, const RT::raypacket& rays, double* tHit) const;
+			// the list of objects (shared pointers are only copied when returning the closest object)
+			std::vector<std::shared_ptr<RT::objectbase>> m_objectList;
+			std::vector<RT::objectbase*> m_objects;
+			// the type of each object and its position in the array for that type (m_objects for PRIMITIVE_OTHER)
+			// along with a copy of its world bounds, so the slab test before each object doesn't touch the object itself
+			struct primref {
+				RT::aabb m_bounds;
+				RT::primitivetype m_type;
+				int m_slot;
+			};
+			std::vector<primref> m_primRefs;
+			std::vector<RT::objsphere*> m_spheres;
+			std::vector<RT::objplane*> m_planes;
+			// the flattened hierarchy
+			std::vector<node> m_nodes;
+			std::vector<int> m_primIndices;
+			// objects without finite bounds (tested against every ray)
+			std::vector<int> m_unbounded;
+			int m_depth;
+	};
+}
+
+#endif
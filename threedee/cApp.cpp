@@ -1,5 +1,5 @@
 #include "cApp.h"
-#include "vector.hpp"
+#include "vecn.hpp"
 
 // default constructor
 cApp::cApp() {
@@ -18,14 +18,15 @@ bool cApp::onInit() {
 		// create renderer
 		pRenderer = SDL_CreateRenderer(pWindow, -1, 0);
 		// initialize the image instance
-		m_image.initialize(1280, 720, pRenderer);
+		m_image.initialize(1280, 720);
+		m_display.initialize(1280, 720, pRenderer);
 		// set the background color to white
 		SDL_SetRenderDrawColor(pRenderer, 255, 255, 255, 255);
 		SDL_RenderClear(pRenderer);
 		// render the scene
 		m_scene.render(m_image);
 		// display the image
-		m_image.display();
+		m_display.display(m_image, m_scene.getThreadPool());
 		// show the result
 		SDL_RenderPresent(pRenderer);
 	}
@@ -78,7 +79,7 @@ void cApp::onExit() {
 }
 
 // debugging
-void cApp::printVector(const vector<double> &inputVector) {
+void cApp::printVector(const Vec3 &inputVector) {
 	int nRows = inputVector.getNumDims();
 	for (int row = 0; row < nRows; row++) {
 		std::cout << std::fixed << std::setprecision(3) << inputVector.getElement(row) << std::endl;
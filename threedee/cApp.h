@@ -4,6 +4,7 @@
 // for efficiency, makes sure cApp.h is not defined/compiled more than once
 #include <SDL.h>
 #include "image.hpp"
+#include "sdldisplay.hpp"
 #include "scene.hpp"
 #include "camera.hpp"
 
@@ -19,9 +20,11 @@ class cApp {
 
 	private:
 		// for debugging, prints the values of the vector to the terminal
-		void printVector(const vector<double>& inputVector);
+		void printVector(const Vec3& inputVector);
 		// an instance of the image class to store the image
 		image m_image;
+		// shows m_image in the window
+		sdldisplay m_display;
 		// an instance of the scene class
 		RT::scene m_scene;
 		// stuff to make SDL2 work
@@ -1,83 +1,126 @@
 #include "camera.hpp"
 #include "ray.hpp"
+#include "sampler.hpp"
 #include <math.h>
 
 // default constructor
 RT::camera::camera() {
-	m_cameraPosition = vector<double>{ std::vector<double> {0.0, -10.0, 0.0} };
-	m_cameraLookAt = vector<double>{ std::vector<double> {0.0, 0.0, 0.0} }; // currently looking at origin
-	m_cameraUp = vector<double>{ std::vector<double> {0.0, 0.0, 1.0} }; // specifies direction of up
+	m_cameraPosition = Vec3{ 0.0, -10.0, 0.0 };
+	m_cameraLookAt = Vec3{ 0.0, 0.0, 0.0 }; // currently looking at origin
+	m_cameraUp = Vec3{ 0.0, 0.0, 1.0 }; // specifies direction of up
 	m_cameraLength = 1.0;
 	m_cameraHorzSize = 1.0;
 	m_cameraAspectRatio = 1.0;
+	m_cameraAperture = 0.0;
+	m_cameraFocusDistance = 0.0;
+	m_shutterOpen = 0.0;
+	m_shutterClose = 0.0;
+	m_focusRatio = 1.0;
 }
 
-void RT::camera::setPosition(const vector<double>& newPosition) {
+void RT::camera::setPosition(const Vec3& newPosition) {
 	m_cameraPosition = newPosition;
 }
 
-void RT::camera::setLookAt(const vector<double>& newLookAt) {
+void RT::camera::setLookAt(const Vec3& newLookAt) {
 	m_cameraLookAt = newLookAt;
 }
 
-void RT::camera::setUp(const vector<double>& upVector) {
+void RT::camera::setUp(const Vec3& upVector) {
 	m_cameraUp = upVector;
 }
 
-void RT::camera::setLength(double newLength) {
+void RT::camera::setLength(RT::real newLength) {
 	m_cameraLength = newLength;
 }
 
-void RT::camera::setHorzSize(double newHorzSize) {
+void RT::camera::setHorzSize(RT::real newHorzSize) {
 	m_cameraHorzSize = newHorzSize;
 }
 
-void RT::camera::setAspect(double newAspect) {
+void RT::camera::setAspect(RT::real newAspect) {
 	m_cameraAspectRatio = newAspect;
 }
 
+void RT::camera::setAperture(RT::real newAperture) {
+	m_cameraAperture = newAperture;
+}
+
+void RT::camera::setFocusDistance(RT::real newDistance) {
+	m_cameraFocusDistance = newDistance;
+}
+
+void RT::camera::setShutter(RT::real openTime, RT::real closeTime) {
+	m_shutterOpen = openTime;
+	m_shutterClose = closeTime;
+}
+
 // return the position of the camera
-vector<double> RT::camera::getPosition() {
+Vec3 RT::camera::getPosition() {
 	return m_cameraPosition;
 }
 
 // return the lookAt of the camera
-vector<double> RT::camera::getLookAt() {
+Vec3 RT::camera::getLookAt() {
 	return m_cameraLookAt;
 }
 
 // return the up vector of the camera
-vector<double> RT::camera::getUp() {
+Vec3 RT::camera::getUp() {
 	return m_cameraUp;
 }
 
 // return the length of the camera
-double RT::camera::getLength() {
+RT::real RT::camera::getLength() {
 	return m_cameraLength;
 }
 
 // return the horizontal size
-double RT::camera::getHorzSize() {
+RT::real RT::camera::getHorzSize() {
 	return m_cameraHorzSize;
 }
 
 // return the camera aspect ratio
-double RT::camera::getAspect() {
+RT::real RT::camera::getAspect() {
 	return m_cameraAspectRatio;
 }
 
+// return the radius of the aperture
+RT::real RT::camera::getAperture() {
+	return m_cameraAperture;
+}
+
+// return the focus distance
+RT::real RT::camera::getFocusDistance() {
+	return m_cameraFocusDistance;
+}
+
+// return the shutter interval
+RT::real RT::camera::getShutterOpen() {
+	return m_shutterOpen;
+}
+
+RT::real RT::camera::getShutterClose() {
+	return m_shutterClose;
+}
+
+// test whether the rays need lens or shutter samples
+bool RT::camera::needsSamples() const {
+	return (m_cameraAperture > 0.0) || (m_shutterOpen != 0.0) || (m_shutterClose != 0.0);
+}
+
 // return the U vector
-vector<double> RT::camera::getU() {
+Vec3 RT::camera::getU() {
 	return m_projectionScreenU;
 }
 
 // return the V vector
-vector<double> RT::camera::getV() {
+Vec3 RT::camera::getV() {
 	return m_projectionScreenV;
 }
 
 // return the projection screen center
-vector<double> RT::camera::getScreenCenter() {
+Vec3 RT::camera::getScreenCenter() {
 	return m_projectionScreenCenter;
 }
 
@@ -88,24 +131,114 @@ void RT::camera::updateCameraGeometry() {
 	// normalize this to get direction
 	m_alignmentVector.normalize();
 	// second, compute the U and V vectors
-	m_projectionScreenU = vector<double>::cross(m_alignmentVector, m_cameraUp);
+	m_projectionScreenU = Vec3::cross(m_alignmentVector, m_cameraUp);
 	m_projectionScreenU.normalize();
-	m_projectionScreenV = vector<double>::cross(m_projectionScreenU, m_alignmentVector);
+	m_projectionScreenV = Vec3::cross(m_projectionScreenU, m_alignmentVector);
 	m_projectionScreenV.normalize();
 	// thirdly, compute the postion of the center point of the screen
 	m_projectionScreenCenter = m_cameraPosition + (m_cameraLength * m_alignmentVector);
 	// modify the U and V vectors to match the size and aspect ratio
 	m_projectionScreenU = m_projectionScreenU * m_cameraHorzSize;
 	m_projectionScreenV = m_projectionScreenV * (m_cameraHorzSize / m_cameraAspectRatio);
+	// finally, the lens (focused on the lookAt point unless a focus distance is given)
+	m_lensU = m_projectionScreenU.normalized() * m_cameraAperture;
+	m_lensV = m_projectionScreenV.normalized() * m_cameraAperture;
+	RT::real focusDistance = (m_cameraFocusDistance > 0.0) ? m_cameraFocusDistance : Vec3::dot(m_cameraLookAt - m_cameraPosition, m_alignmentVector);
+	m_focusRatio = focusDistance / m_cameraLength;
 }
 
-bool RT::camera::generateRay(float proScreenX, float proScreenY, RT::ray &cameraRay) { 
+bool RT::camera::generateRay(RT::real proScreenX, RT::real proScreenY, RT::ray &cameraRay) const { 
 	// compute the location of the screen point in world coordinates
-	vector<double> screenWorldPart1 = m_projectionScreenCenter + (m_projectionScreenU * proScreenX);
-	vector<double> screenWorldCoordinate = screenWorldPart1 + (m_projectionScreenV * proScreenY);
+	Vec3 screenWorldPart1 = m_projectionScreenCenter + (m_projectionScreenU * proScreenX);
+	Vec3 screenWorldCoordinate = screenWorldPart1 + (m_projectionScreenV * proScreenY);
 	// use this point along with the camera position to compute the ray
 	cameraRay.m_point1 = m_cameraPosition;
 	cameraRay.m_point2 = screenWorldCoordinate;
 	cameraRay.m_lab = screenWorldCoordinate - m_cameraPosition;
+	cameraRay.m_time = m_shutterOpen;
 	return true;
-}
\ No newline at end of file
+}
+
+// function to generate the rays of a block of pixels
+void RT::camera::generateRays(int x0, int y0, int x1, int y1, int samplesPerPixel, double xFact, double yFact, const RT::camerasamples* pSamples, RT::camerarays& rays) const {
+	rays.resize((x1 - x0) * (y1 - y0) * samplesPerPixel);
+	int i = 0;
+	if (pSamples == nullptr) {
+		// the screen point of each column is worked out once for the block, then each row only adds its own offset
+		// (these are the sums generateRay does, in the same order, so the rays are exactly the same)
+		rays.m_columns.resize(x1 - x0);
+		for (int x = x0; x < x1; x++) rays.m_columns[x - x0] = m_projectionScreenCenter + (m_projectionScreenU * static_cast<RT::real>((static_cast<double>(x) * xFact) - 1.0));
+		for (int y = y0; y < y1; y++) {
+			Vec3 rowOffset = m_projectionScreenV * static_cast<RT::real>((static_cast<double>(y) * yFact) - 1.0);
+			for (int x = x0; x < x1; x++) {
+				Vec3 screenWorldCoordinate = rays.m_columns[x - x0] + rowOffset;
+				for (int sample = 0; sample < samplesPerPixel; sample++) rays.setRay(i++, m_cameraPosition, screenWorldCoordinate, m_shutterOpen);
+			}
+		}
+	}
+	else {
+		// every ray goes through a point of its own
+		const RT::camerasamples& samples = *pSamples;
+		for (int y = y0; y < y1; y++) {
+			for (int x = x0; x < x1; x++) {
+				for (int sample = 0; sample < samplesPerPixel; sample++, i++) {
+					RT::real proScreenX = static_cast<RT::real>(((x + samples.m_pixelX[i]) * xFact) - 1.0);
+					RT::real proScreenY = static_cast<RT::real>(((y + samples.m_pixelY[i]) * yFact) - 1.0);
+					Vec3 screenWorldPart1 = m_projectionScreenCenter + (m_projectionScreenU * proScreenX);
+					Vec3 screenWorldCoordinate = screenWorldPart1 + (m_projectionScreenV * proScreenY);
+					RT::real time = static_cast<RT::real>(m_shutterOpen + ((m_shutterClose - m_shutterOpen) * samples.m_time[i]));
+					if (m_cameraAperture <= 0.0) {
+						rays.setRay(i, m_cameraPosition, screenWorldCoordinate, time);
+						continue;
+					}
+					// the ray from the point on the lens towards the point in focus along the pinhole ray, ending (like the pinhole ray) at the depth of the screen
+					double lensX, lensY;
+					RT::concentricDisk(samples.m_lensU[i], samples.m_lensV[i], lensX, lensY);
+					Vec3 lensPoint = m_cameraPosition + (m_lensU * static_cast<RT::real>(lensX)) + (m_lensV * static_cast<RT::real>(lensY));
+					Vec3 focusPoint = m_cameraPosition + ((screenWorldCoordinate - m_cameraPosition) * m_focusRatio);
+					rays.setRay(i, lensPoint, lensPoint + ((focusPoint - lensPoint) * static_cast<RT::real>(1.0 / m_focusRatio)), time);
+				}
+			}
+		}
+	}
+}
+
+// functions for the samples of a block of pixels
+void RT::camerasamples::resize(int numSamples) {
+	m_pixelX.resize(numSamples);
+	m_pixelY.resize(numSamples);
+	m_lensU.resize(numSamples);
+	m_lensV.resize(numSamples);
+	m_time.resize(numSamples);
+}
+
+// functions for the rays of a block of pixels
+void RT::camerarays::resize(int numRays) {
+	m_point1X.resize(numRays);
+	m_point1Y.resize(numRays);
+	m_point1Z.resize(numRays);
+	m_point2X.resize(numRays);
+	m_point2Y.resize(numRays);
+	m_point2Z.resize(numRays);
+	m_time.resize(numRays);
+}
+
+void RT::camerarays::setRay(int i, const Vec3& point1, const Vec3& point2, RT::real time) {
+	m_point1X[i] = point1[0];
+	m_point1Y[i] = point1[1];
+	m_point1Z[i] = point1[2];
+	m_point2X[i] = point2[0];
+	m_point2Y[i] = point2[1];
+	m_point2Z[i] = point2[2];
+	m_time[i] = time;
+}
+
+RT::ray RT::camerarays::getRay(int i) const {
+	RT::ray cameraRay(Vec3{ m_point1X[i], m_point1Y[i], m_point1Z[i] }, Vec3{ m_point2X[i], m_point2Y[i], m_point2Z[i] });
+	cameraRay.m_time = m_time[i];
+	return cameraRay;
+}
+
+int RT::camerarays::size() const {
+	return static_cast<int>(m_point1X.size());
+}
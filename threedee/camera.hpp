@@ -1,45 +1,98 @@
 #ifndef CAMERA_H
 #define CAMERA_H
-#include "vector.hpp"
+#include <vector>
+#include "vecn.hpp"
 #include "ray.hpp"
 
 namespace RT {
+	// where each camera ray of a block of pixels samples its pixel, the lens and the shutter interval (in the same order as the rays, see camera::generateRays)
+	// the pixel offsets are from -0.5 to 0.5, across and down the pixel around the point its single ray goes through (x, y)
+	// the rest are from 0 to 1: across and up the square that is mapped onto the aperture, and from the shutter opening to it closing
+	struct camerasamples {
+		// function to size the arrays for numSamples samples (keeping their storage)
+		void resize(int numSamples);
+		// variables
+		std::vector<double> m_pixelX, m_pixelY;
+		std::vector<double> m_lensU, m_lensV;
+		std::vector<double> m_time;
+	};
+
+	// the camera rays of a block of pixels, stored as a structure of arrays
+	// the pixels are in row-major order with the samples of each pixel together, and each ray runs from point 1 (on the lens) to point 2 (on the screen)
+	struct camerarays {
+		// function to size the arrays for numRays rays (keeping their storage)
+		void resize(int numRays);
+		// function to set ray i
+		void setRay(int i, const Vec3& point1, const Vec3& point2, real time);
+		// function to return ray i, exactly as generateRay gives it for the same point on the screen (for a pinhole camera)
+		RT::ray getRay(int i) const;
+		int size() const;
+		// variables
+		std::vector<real> m_point1X, m_point1Y, m_point1Z;
+		std::vector<real> m_point2X, m_point2Y, m_point2Z;
+		std::vector<real> m_time;
+		// scratch space for generateRays (the screen point of each column of the block, before the row is added)
+		std::vector<Vec3> m_columns;
+	};
+
 	class camera {
 		public: 
 			// default constructor
 			camera();
 			// functions to set camera parameters
-			void setPosition(const vector<double>& newPosition);
-			void setLookAt(const vector<double>& newLookAt);
-			void setUp(const vector<double>& upVector);
-			void setLength(double newLength); // dist between pinhole and screen in camera
-			void setHorzSize(double newSize);
-			void setAspect(double newAspect);
+			void setPosition(const Vec3& newPosition);
+			void setLookAt(const Vec3& newLookAt);
+			void setUp(const Vec3& upVector);
+			void setLength(real newLength); // dist between pinhole and screen in camera
+			void setHorzSize(real newSize);
+			void setAspect(real newAspect);
+			void setAperture(real newAperture); // radius of the lens, 0 for a pinhole camera
+			void setFocusDistance(real newDistance); // distance along the view direction that is in focus, 0 to focus on the lookAt point
+			void setShutter(real openTime, real closeTime); // the interval the shutter is open for, rays are spread evenly over it
 			// functions to return camera parameters
-			vector<double> getPosition();
-			vector<double> getLookAt();
-			vector<double> getUp();
-			vector<double> getU();
-			vector<double> getV();
-			vector<double> getScreenCenter();
-			double getLength();
-			double getHorzSize();
-			double getAspect();
-			// function to generate a ray
-			bool generateRay(float proScreenX, float proScreenY, RT::ray &cameraRay);
+			Vec3 getPosition();
+			Vec3 getLookAt();
+			Vec3 getUp();
+			Vec3 getU();
+			Vec3 getV();
+			Vec3 getScreenCenter();
+			real getLength();
+			real getHorzSize();
+			real getAspect();
+			real getAperture();
+			real getFocusDistance();
+			real getShutterOpen();
+			real getShutterClose();
+			// function to test whether the rays need samples on the lens or over the shutter interval
+			// a pinhole camera with the shutter at time 0 doesn't, and its rays are those of generateRay (so they can be traced in packets)
+			bool needsSamples() const;
+			// function to generate a ray (through the center of the lens, at the time the shutter opens)
+			bool generateRay(real proScreenX, real proScreenY, RT::ray &cameraRay) const;
+			// function to generate samplesPerPixel rays for each pixel of the block [x0, x1) x [y0, y1), where xFact and yFact are 2 / the image size
+			// without samples, every ray of a pixel goes through its corner (x * xFact - 1, y * yFact - 1), as generateRay does for the same coordinates
+			// otherwise ray i goes through (x + m_pixelX[i], y + m_pixelY[i]) on the screen, from its own point on the lens and at its own time
+			void generateRays(int x0, int y0, int x1, int y1, int samplesPerPixel, double xFact, double yFact, const RT::camerasamples* pSamples, RT::camerarays& rays) const;
 			// function to update the camera geometry
 			void updateCameraGeometry();
 		private:
-			vector<double> m_cameraPosition{ 3 };
-			vector<double> m_cameraLookAt{ 3 };
-			vector<double> m_cameraUp{ 3 };
-			double m_cameraLength;
-			double m_cameraHorzSize;
-			double m_cameraAspectRatio;
-			vector<double> m_alignmentVector{ 3 }; // principle axes of camera
-			vector<double> m_projectionScreenU{ 3 };
-			vector<double> m_projectionScreenV{ 3 };
-			vector<double> m_projectionScreenCenter{ 3 };
+			Vec3 m_cameraPosition;
+			Vec3 m_cameraLookAt;
+			Vec3 m_cameraUp;
+			real m_cameraLength;
+			real m_cameraHorzSize;
+			real m_cameraAspectRatio;
+			Vec3 m_alignmentVector; // principle axes of camera
+			Vec3 m_projectionScreenU;
+			Vec3 m_projectionScreenV;
+			Vec3 m_projectionScreenCenter;
+			// the thin lens, the rays through a point on the screen all meet on the plane in focus
+			real m_cameraAperture;
+			real m_cameraFocusDistance;
+			real m_shutterOpen;
+			real m_shutterClose;
+			Vec3 m_lensU; // the directions of U and V, as long as the radius of the aperture
+			Vec3 m_lensV;
+			real m_focusRatio; // the distance to the plane in focus over the distance to the screen
 	};
 }
 
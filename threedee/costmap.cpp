@@ -0,0 +1,70 @@
+#include "costmap.hpp"
+#include <algorithm>
+#include <vector>
+
+// the fraction of pixels that are shown as the most expensive, so that a few outliers (e.g. a thread being preempted) don't darken the rest
+constexpr double COSTMAP_CLIP_FRACTION = 0.002;
+
+// function to initialize
+void RT::costmap::initialize(int xSize, int ySize) {
+	m_costs.initialize(xSize, ySize);
+}
+
+// function to return the costs
+const image& RT::costmap::getCosts() const {
+	return m_costs;
+}
+
+// function to write the raw costs
+bool RT::costmap::saveRaw(const std::string& fileName) {
+	return m_costs.savePFM(fileName);
+}
+
+// function to map a value from 0 to 1 onto the false colour ramp
+static void rampColor(double value, double& red, double& green, double& blue) {
+	static const double stops[5][3] = { { 0.0, 0.0, 0.0 }, { 0.4, 0.0, 0.6 }, { 0.9, 0.1, 0.1 }, { 1.0, 0.9, 0.0 }, { 1.0, 1.0, 1.0 } };
+	double position = std::min(std::max(value, 0.0), 1.0) * 4.0;
+	int stop = std::min(static_cast<int>(position), 3);
+	double fraction = position - stop;
+	red = stops[stop][0] + ((stops[stop + 1][0] - stops[stop][0]) * fraction);
+	green = stops[stop][1] + ((stops[stop + 1][1] - stops[stop][1]) * fraction);
+	blue = stops[stop][2] + ((stops[stop + 1][2] - stops[stop][2]) * fraction);
+}
+
+// function to write one quantity as a false colour image
+bool RT::costmap::saveHeatmap(const std::string& fileName, costchannel channel) const {
+	int xSize = m_costs.getXSize();
+	int ySize = m_costs.getYSize();
+	// find the value that the top of the ramp stands for
+	std::vector<float> values;
+	values.reserve(xSize * ySize);
+	for (int y = 0; y < ySize; y++) {
+		const float* pRow = m_costs.getRow(y);
+		for (int x = 0; x < xSize; x++) values.push_back(pRow[(x * image::NUM_CHANNELS) + channel]);
+	}
+	if (values.empty()) return false;
+	size_t clipIndex = std::min(values.size() - 1, static_cast<size_t>(values.size() * (1.0 - COSTMAP_CLIP_FRACTION)));
+	std::nth_element(values.begin(), values.begin() + clipIndex, values.end());
+	double scale = (values[clipIndex] > 0.0f) ? (1.0 / values[clipIndex]) : 0.0;
+	// the top of the ramp is white, so image::save doesn't rescale the colors
+	image heatmap;
+	heatmap.initialize(xSize, ySize);
+	for (int y = 0; y < ySize; y++) {
+		const float* pRow = m_costs.getRow(y);
+		for (int x = 0; x < xSize; x++) {
+			double red, green, blue;
+			rampColor(pRow[(x * image::NUM_CHANNELS) + channel] * scale, red, green, blue);
+			heatmap.setPixel(x, y, red, green, blue);
+		}
+	}
+	return heatmap.save(fileName);
+}
+
+// functions to return the dimensions
+int RT::costmap::getXSize() const {
+	return m_costs.getXSize();
+}
+
+int RT::costmap::getYSize() const {
+	return m_costs.getYSize();
+}
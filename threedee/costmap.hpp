@@ -0,0 +1,38 @@
+#ifndef COSTMAP_H
+#define COSTMAP_H
+#include <string>
+#include "image.hpp"
+
+namespace RT {
+	// the cost of rendering each pixel of an image, recorded by scene::render when one is passed to it
+	// each pixel holds the rays cast for it, the primitives tested, the nanoseconds spent on it, and the samples taken for it
+	// the ray and test counts come from the render statistics, so they are only recorded when RT_STATS is defined (they are 0 otherwise)
+	class costmap {
+		public:
+			// the quantities recorded for each pixel
+			enum costchannel { COST_RAYS = 0, COST_TESTS = 1, COST_TIME = 2, COST_SAMPLES = 3 };
+			// function to initialize (all costs are set to 0)
+			void initialize(int xSize, int ySize);
+			// function to set the costs of a pixel (render threads set disjoint pixels, so no synchronisation is needed)
+			void setPixel(int x, int y, double rays, double tests, double nanoseconds, int samples);
+			// function to return the costs, as an image with one channel per quantity (red: rays, green: tests, blue: nanoseconds, and samples in the fourth)
+			const image& getCosts() const;
+			// function to write the raw costs as a PFM file, red, green and blue as for getCosts (PFM has no room for the samples)
+			bool saveRaw(const std::string& fileName);
+			// function to write one quantity as a false colour image (black, through purple, red and yellow to white at the most expensive pixels)
+			// the format is picked from the extension as for image::save, returns false if the file can't be written
+			bool saveHeatmap(const std::string& fileName, costchannel channel = COST_TIME) const;
+			// functions to return the dimensions
+			int getXSize() const;
+			int getYSize() const;
+		private:
+			image m_costs;
+	};
+
+	inline void costmap::setPixel(int x, int y, double rays, double tests, double nanoseconds, int samples) {
+		m_costs.setPixel(x, y, rays, tests, nanoseconds);
+		m_costs.getRow(y)[(x * image::NUM_CHANNELS) + COST_SAMPLES] = static_cast<float>(samples);
+	}
+}
+
+#endif
@@ -13,99 +13,68 @@ RT::GTform::~GTform() {
 }
 
 // construct from a pair of matrices
+RT::GTform::GTform(const Affine4 &fwd, const Affine4 &bck) {
+	m_fwdtfm = fwd;
+	m_bcktfm = bck;
+}
+
 RT::GTform::GTform(const matrix<double> &fwd, const matrix<double> &bck) {
 	// verify that the inputs are 4 x b
 	if ((fwd.getNumRows() != 4) || (fwd.getNumCols() != 4) || (bck.getNumRows() != 4) || (bck.getNumCols() != 4)) throw std::invalid_argument("cannot construct GTform, inputs are not all 4 x 4");
-	m_fwdtfm = fwd;
-	m_bcktfm = bck;
+	// only the top three rows are kept, the bottom row of an affine transform is always (0, 0, 0, 1)
+	for (int row = 0; row < 3; row++) {
+		for (int col = 0; col < 4; col++) {
+			m_fwdtfm.setElement(row, col, fwd.getElement(row, col));
+			m_bcktfm.setElement(row, col, bck.getElement(row, col));
+		}
+	}
 }
 
 // function to set the transformation
-void RT::GTform::setTransform(const vector<double> &translation, const vector<double> &rotation, const vector <double> &scale) {
-	// define a matrix for each component of the transform
-	matrix<double> translationMatrix{ 4, 4 };
-	matrix<double> rotationMatrixX{ 4, 4 };
-	matrix<double> rotationMatrixY{ 4, 4 };
-	matrix<double> rotationMatrixZ{ 4, 4 };
-	matrix<double> scaleMatrix{ 4, 4 };
-	// set these to identity
-	translationMatrix.setToIdentity();
-	rotationMatrixX.setToIdentity();
-	rotationMatrixY.setToIdentity();
-	rotationMatrixZ.setToIdentity();
-	scaleMatrix.setToIdentity();
-	// populate these with the appropriate values
-	// first the translation matrix
-	translationMatrix.setElement(0, 3, translation.getElement(0));
-	translationMatrix.setElement(1, 3, translation.getElement(1));
-	translationMatrix.setElement(2, 3, translation.getElement(2));
-	// rotation matrices, z
-	rotationMatrixZ.setElement(0, 0, cos(rotation.getElement(2)));
-	rotationMatrixZ.setElement(0, 1, sin(rotation.getElement(2)));
-	rotationMatrixZ.setElement(1, 0, -sin(rotation.getElement(2)));
-	rotationMatrixZ.setElement(1, 1, cos(rotation.getElement(2)));
-	// y
-	rotationMatrixY.setElement(0, 0, cos(rotation.getElement(1)));
-	rotationMatrixY.setElement(0, 2, -sin(rotation.getElement(1)));
-	rotationMatrixY.setElement(2, 0, sin(rotation.getElement(1)));
-	rotationMatrixY.setElement(2, 2, cos(rotation.getElement(1)));
-	// x
-	rotationMatrixX.setElement(1, 1, cos(rotation.getElement(0)));
-	rotationMatrixX.setElement(1, 2, sin(rotation.getElement(0)));
-	rotationMatrixX.setElement(2, 1, -sin(rotation.getElement(0)));
-	rotationMatrixX.setElement(2, 2, cos(rotation.getElement(0)));
-	// scale matrix
-	scaleMatrix.setElement(0, 0, scale.getElement(0));
-	scaleMatrix.setElement(1, 1, scale.getElement(1));
-	scaleMatrix.setElement(2, 2, scale.getElement(2));
-	// combine to give the final forward transform matrix
-	m_fwdtfm = translationMatrix * scaleMatrix * rotationMatrixX * rotationMatrixY * rotationMatrixZ; // if compilation fails, try adding different overload cases for the * operator for matrices
-	// compute the backwards transform
+void RT::GTform::setTransform(const Vec3 &translation, const Vec3 &rotation, const Vec3 &scale) {
+	// combine the elementary transforms to give the final forward transform matrix
+	m_fwdtfm = Affine4::translation(translation) * Affine4::scale(scale) * Affine4::rotationX(rotation.getElement(0)) * Affine4::rotationY(rotation.getElement(1)) * Affine4::rotationZ(rotation.getElement(2));
+	// compute the backwards transform (closed form, no elimination required)
 	m_bcktfm = m_fwdtfm;
-	m_bcktfm.inverse();
+	if (!m_bcktfm.inverse()) throw std::invalid_argument("cannot set GTform, the transform is singular");
+}
+
+// function to set the transformation part of the way between two
+void RT::GTform::setTransform(const RT::gtfmparts& start, const RT::gtfmparts& end, RT::real weight) {
+	Vec3 translation = start.m_translation + ((end.m_translation - start.m_translation) * weight);
+	Vec3 rotation = start.m_rotation + ((end.m_rotation - start.m_rotation) * weight);
+	Vec3 scale = start.m_scale + ((end.m_scale - start.m_scale) * weight);
+	setTransform(translation, rotation, scale);
 }
 
 // functions to return the transformation matrices
-matrix<double> RT::GTform::getForward() { return m_fwdtfm; }
+Affine4 RT::GTform::getForward() const { return m_fwdtfm; }
 
-matrix<double> RT::GTform::getBackward() { return m_bcktfm; }
+Affine4 RT::GTform::getBackward() const { return m_bcktfm; }
 
 // function to apply the transform
-RT::ray RT::GTform::apply(const RT::ray& inputRay, bool dirFlag) {
+RT::ray RT::GTform::apply(const RT::ray& inputRay, bool dirFlag) const {
+	// select the transform to apply
+	const Affine4& tfm = dirFlag ? m_fwdtfm : m_bcktfm;
 	// create an output object
 	RT::ray outputRay;
-	if (dirFlag) {
-		// apply the forward transform
-		outputRay.m_point1 = this->apply(inputRay.m_point1, RT::FWDTFM);
-		outputRay.m_point2 = this->apply(inputRay.m_point2, RT::FWDTFM);
-		outputRay.m_lab = outputRay.m_point2 - outputRay.m_point1;
-	}
-	else {
-		// apply the backward transform
-		outputRay.m_point1 = this->apply(inputRay.m_point1, RT::BCKTFM);
-		outputRay.m_point2 = this->apply(inputRay.m_point2, RT::BCKTFM);
-		outputRay.m_lab = outputRay.m_point2 - outputRay.m_point1;
-	}
+	outputRay.m_point1 = tfm.transformPoint(inputRay.m_point1);
+	outputRay.m_point2 = tfm.transformPoint(inputRay.m_point2);
+	outputRay.m_lab = tfm.transformDirection(inputRay.m_lab);
+	outputRay.m_time = inputRay.m_time;
 	return outputRay;
 }
 
-vector<double> RT::GTform::apply(const vector<double>& inputVector, bool dirFlag) {
-	// convert inputVector to a 4-element vector
-	std::vector<double> tempData{ inputVector.getElement(0), inputVector.getElement(1), inputVector.getElement(2), 1.0 };
-	vector<double> tempVector{ tempData };
-	// create a vector for the result
-	vector<double> resultVector;
-	if (dirFlag) {
-		// apply the forward transform
-		resultVector = m_fwdtfm * tempVector;
-	}
-	else {
-		// apply the backward transform
-		resultVector = m_bcktfm * tempVector;
-	}
-	// reform the output as a 3-element vector
-	vector<double> outputVector { std::vector<double> { resultVector.getElement(0), resultVector.getElement(1), resultVector.getElement(2) } };
-	return outputVector;
+Vec3 RT::GTform::apply(const Vec3& inputVector, bool dirFlag) const {
+	// treat inputVector as a homogeneous point (w = 1)
+	if (dirFlag) return m_fwdtfm.transformPoint(inputVector);
+	else return m_bcktfm.transformPoint(inputVector);
+}
+
+Vec3 RT::GTform::applyDirection(const Vec3& inputVector, bool dirFlag) const {
+	// treat inputVector as a homogeneous direction (w = 0)
+	if (dirFlag) return m_fwdtfm.transformDirection(inputVector);
+	else return m_bcktfm.transformDirection(inputVector);
 }
 
 // function to overload * operator
@@ -113,10 +82,9 @@ vector<double> RT::GTform::apply(const vector<double>& inputVector, bool dirFlag
 namespace RT {
 	RT::GTform operator* (const RT::GTform& lhs, const RT::GTform& rhs) {
 		// form the product of the two forward transforms
-		matrix<double> fwdResult = lhs.m_fwdtfm; // since this is defined as friend, you can access private variables
-		// compute the backward transform as the inverse of the forward transform
-		matrix<double> bckResult = fwdResult;
-		bckResult.inverse();
+		Affine4 fwdResult = lhs.m_fwdtfm * rhs.m_fwdtfm; // since this is defined as friend, you can access private variables
+		// the backward transform is the product of the inverses in reverse order
+		Affine4 bckResult = rhs.m_bcktfm * lhs.m_bcktfm;
 		// form the final result
 		RT::GTform finalResult(fwdResult, bckResult);
 		return finalResult;
@@ -144,9 +112,9 @@ void RT::GTform::printMatrix(bool dirFlag) {
 }
 
 // function to print matrices
-void RT::GTform::print(const matrix<double>& matrix) {
-	int rows = matrix.getNumRows();
-	int cols = matrix.getNumCols();
+void RT::GTform::print(const Affine4& matrix) {
+	int rows = 4;
+	int cols = 4;
 	for (int row = 0; row < rows; row++) {
 		for (int col = 0; col < cols; col++) std::cout << std::fixed << std::setprecision(3) << matrix.getElement(row, col) << " ";
 		std::cout << std::endl;
@@ -154,7 +122,7 @@ void RT::GTform::print(const matrix<double>& matrix) {
 }
 
 // function to print vectors
-void RT::GTform::printVector(const vector<double>& inputVector) {
+void RT::GTform::printVector(const Vec3& inputVector) {
 	int rows = inputVector.getNumDims();
 	for (int row = 0; row < rows; row++) std::cout << std::fixed << std::setprecision(3) << inputVector.getElement(row) << std::endl;
 }
\ No newline at end of file
@@ -1,7 +1,8 @@
 #ifndef GTFM_H
 #define GTFM_H
-#include "vector.hpp"
+#include "vecn.hpp"
 #include "matrix.hpp"
+#include "affine4.hpp"
 #include "ray.hpp"
 
 namespace RT {
@@ -9,21 +10,35 @@ namespace RT {
 	constexpr bool FWDTFM = true; // forward transform
 	constexpr bool BCKTFM = false; // backward transform
 
+	// the translation, rotation and scale a transform is made from (see GTform::setTransform)
+	// moving objects keep these for both ends of their motion, as interpolating them (rather than the matrices) keeps every transform in between a rotation and a scale
+	struct gtfmparts {
+		Vec3 m_translation{ 0.0, 0.0, 0.0 };
+		Vec3 m_rotation{ 0.0, 0.0, 0.0 };
+		Vec3 m_scale{ 1.0, 1.0, 1.0 };
+	};
+
 	class GTform {
 		public:
 			// constructor and destructor
 			GTform();
 			~GTform();
 			// construct from a pair of matrices
+			GTform(const Affine4& fwd, const Affine4& bck);
 			GTform(const matrix<double>& fwd, const matrix<double>& bck);
 			// function to set translation, rotation and scale components
-			void setTransform(const vector<double>& translation, const vector<double>& rotation, const vector<double>& scale);
+			void setTransform(const Vec3& translation, const Vec3& rotation, const Vec3& scale);
+			// function to set the transform a fraction weight of the way from start to end, where the translation, rotation angles and scale are each interpolated linearly
+			// the scale mustn't change sign on the way, or the transform passes through a singular one (and this throws)
+			void setTransform(const RT::gtfmparts& start, const RT::gtfmparts& end, real weight);
 			// functions to return the transform matrices
-			matrix<double> getForward();
-			matrix<double> getBackward();
+			Affine4 getForward() const;
+			Affine4 getBackward() const;
 			// function to apply the transform (want to apply this to vectors *and* members of the ray class)
-			RT::ray apply(const RT::ray& inputRay, bool dirFlag); // dirFlag can be set to FWDTFORM or BCKTFORM
-			vector<double> apply(const vector<double>& inputVector, bool dirFlag);
+			RT::ray apply(const RT::ray& inputRay, bool dirFlag) const; // dirFlag can be set to FWDTFORM or BCKTFORM
+			Vec3 apply(const Vec3& inputVector, bool dirFlag) const;
+			// function to apply the transform to a direction (translation is ignored)
+			Vec3 applyDirection(const Vec3& inputVector, bool dirFlag) const;
 			// overload operators
 			friend GTform operator* (const RT::GTform &lhs, const RT::GTform &rhs); // has access to the class's private members
 			// overload assignment operator
@@ -31,12 +46,12 @@ namespace RT {
 			// function to print transform matrix to STDOUT
 			void printMatrix(bool dirFlag);
 			// function to allow printing of vectors
-			static void printVector(const vector<double> &vector);
+			static void printVector(const Vec3 &vector);
 		private:
-			void print(const matrix<double>& matrix);
-			matrix<double> m_fwdtfm{ 4, 4 }; // homogeneous coordinates, 4 x 4 matrix
-			matrix<double> m_bcktfm{ 4, 4 }; // also homogeneous
+			void print(const Affine4& matrix);
+			Affine4 m_fwdtfm; // homogeneous coordinates, 4 x 4 matrix (bottom row implied)
+			Affine4 m_bcktfm; // also homogeneous
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,133 +1,292 @@
 #include "image.hpp"
+#include "pngencoder.hpp"
+#include "threadpool.hpp"
+#include "simd.hpp"
+#include "renderstats.hpp"
+#include <fstream>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+// alignment of the start of every row, in bytes (a cache line)
+constexpr int IMAGE_ROW_ALIGNMENT = 64;
+// number of rows in each band that the 8 bit conversion is shared out in
+constexpr int IMAGE_BAND_ROWS = 16;
 
 // default constructor
 image::image() {
 	m_xSize = 0;
 	m_ySize = 0;
-	m_pTexture = NULL;
+	m_rowStride = 0;
+	m_pPixels = nullptr;
+	m_numBands = 0;
 }
 
 // destructor
 image::~image() {
-	// destroy only if it hasn't been destroyed yet
-	if (m_pTexture != NULL) SDL_DestroyTexture(m_pTexture);
+
 }
 
 // function to initialize
-void image::initialize(const int xSize, const int ySize, SDL_Renderer* pRenderer) {
-	// resize image arrays
-	m_rChannel.resize(xSize, std::vector<double>(ySize, 0.0));
-	m_gChannel.resize(xSize, std::vector<double>(ySize, 0.0));
-	m_bChannel.resize(xSize, std::vector<double>(ySize, 0.0));
-	// store dimensions
+void image::initialize(const int xSize, const int ySize) {
+	// store dimensions, rounding the length of each row up so that every row starts on an aligned boundary
+	const int floatsPerLine = IMAGE_ROW_ALIGNMENT / sizeof(float);
 	m_xSize = xSize;
 	m_ySize = ySize;
-	// store the pointer to the renderer
-	m_pRenderer = pRenderer;
-	// initialize the texture
-	initTexture();
+	m_rowStride = (((xSize * NUM_CHANNELS) + floatsPerLine - 1) / floatsPerLine) * floatsPerLine;
+	// allocate the buffer with enough slack to align its start, and clear it to black
+	m_storage.assign((static_cast<size_t>(m_rowStride) * ySize) + floatsPerLine, 0.0f);
+	uintptr_t address = reinterpret_cast<uintptr_t>(m_storage.data());
+	uintptr_t aligned = (address + IMAGE_ROW_ALIGNMENT - 1) & ~static_cast<uintptr_t>(IMAGE_ROW_ALIGNMENT - 1);
+	m_pPixels = m_storage.data() + ((aligned - address) / sizeof(float));
+	// room for the maximum of each channel in each band of rows
+	m_numBands = (ySize + IMAGE_BAND_ROWS - 1) / IMAGE_BAND_ROWS;
+	m_bandMax.assign(m_numBands * NUM_CHANNELS, 0.0f);
+}
+
+// function to write a block of pixels
+void image::writeTile(const int x0, const int y0, const int tileWidth, const int tileHeight, const float* tileData) {
+	for (int y = 0; y < tileHeight; y++) {
+		std::memcpy(getRow(y0 + y) + (x0 * NUM_CHANNELS), tileData + (y * tileWidth * NUM_CHANNELS), tileWidth * NUM_CHANNELS * sizeof(float));
+	}
 }
 
-// function to set pixels
-void image::setPixel(const int x, const int y, const double red, const double green, const double blue) {
-	m_rChannel.at(x).at(y) = red;
-	m_gChannel.at(x).at(y) = green;
-	m_bChannel.at(x).at(y) = blue;
+// function to return the row stride
+int image::getRowStride() const {
+	return m_rowStride;
 }
 
-// function to generate the display
-void image::display() {
+// function to convert the image to 8 bits per channel
+void image::convertTo8Bit(unsigned char* pOutput, const int outputPitch, const pixellayout layout, RT::threadpool* pThreadPool) {
+	RT_STAT_PHASE(PHASE_DISPLAY);
 	// compute maximum values
-	computeMaxValues();
-	// allocate memory for a pixel buffer 
-	Uint32* tempPixels = new Uint32[m_xSize * m_ySize];
-	// clear the pixel buffer
-	memset(tempPixels, 0, m_xSize * m_ySize * sizeof(Uint32));
-	// loop through vector channels and generate a Uint32 for each pixel
-	for (int x = 0; x < m_xSize; x++) {
-		for (int y = 0; y < m_ySize; y++) {
-			tempPixels[(y * m_xSize) + x] = convertColor(m_rChannel.at(x).at(y), m_gChannel.at(x).at(y), m_bChannel.at(x).at(y));
+	computeMaxValues(pThreadPool);
+	// an image that is entirely black stays black
+	double scale = (m_overallMax > 0.0) ? (255.0 / m_overallMax) : 0.0;
+	if (pThreadPool != nullptr) {
+		// capture a single pointer, so that the std::function made from the lambda doesn't need to allocate
+		struct conversion {
+			image* m_pImage;
+			unsigned char* m_pOutput;
+			int m_outputPitch;
+			pixellayout m_layout;
+			double m_scale;
+		} params = { this, pOutput, outputPitch, layout, scale };
+		const conversion* pParams = &params;
+		pThreadPool->parallelFor(m_numBands, [pParams](int band, int threadIndex) {
+			pParams->m_pImage->convertBand(band, pParams->m_pOutput, pParams->m_outputPitch, pParams->m_layout, pParams->m_scale);
+		});
+	}
+	else {
+		for (int band = 0; band < m_numBands; band++) convertBand(band, pOutput, outputPitch, layout, scale);
+	}
+}
+
+// function to convert a band of rows to 8 bits per channel
+// the scaling is done in double precision, so the result is the same with and without simd
+void image::convertBand(const int band, unsigned char* pOutput, const int outputPitch, const pixellayout layout, const double scale) {
+	int yEnd = (band + 1) * IMAGE_BAND_ROWS;
+	if (yEnd > m_ySize) yEnd = m_ySize;
+	int bytesPerPixel = (layout == LAYOUT_RGB8) ? 3 : 4;
+	for (int y = band * IMAGE_BAND_ROWS; y < yEnd; y++) {
+		const float* pRow = getRow(y);
+		unsigned char* pOutputRow = pOutput + (static_cast<size_t>(y) * outputPitch);
+		int x = 0;
+#if defined(RT_SIMD_AVX) || defined(RT_SIMD_SSE2)
+		// four pixels (sixteen channels) at a time
+		__m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xff000000u));
+		unsigned char converted[16];
+		for (; x + 4 <= m_xSize; x += 4) {
+			__m128i channels[4];
+			for (int i = 0; i < 4; i++) {
+				__m128 pixel = _mm_load_ps(pRow + ((x + i) * NUM_CHANNELS));
+				if (layout == LAYOUT_BGRA8) pixel = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 0, 1, 2));
+#if defined(RT_SIMD_AVX)
+				channels[i] = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtps_pd(pixel), _mm256_set1_pd(scale)));
+#else
+				__m128i low = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtps_pd(pixel), _mm_set1_pd(scale)));
+				__m128i high = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(pixel, pixel)), _mm_set1_pd(scale)));
+				channels[i] = _mm_unpacklo_epi64(low, high);
+#endif
+			}
+			// narrow to 16 and then 8 bits (the values are already in the range 0 to 255)
+			__m128i packed = _mm_packus_epi16(_mm_packs_epi32(channels[0], channels[1]), _mm_packs_epi32(channels[2], channels[3]));
+			if (layout == LAYOUT_RGB8) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(converted), packed);
+				for (int i = 0; i < 4; i++) std::memcpy(pOutputRow + ((x + i) * 3), converted + (i * 4), 3);
+			}
+			else {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pOutputRow + (x * 4)), _mm_or_si128(packed, alphaMask));
+			}
+		}
+#endif
+		// the remaining pixels (or all of them without simd)
+		for (; x < m_xSize; x++) {
+			const float* pPixel = pRow + (x * NUM_CHANNELS);
+			unsigned char red = static_cast<unsigned char>(pPixel[0] * scale);
+			unsigned char green = static_cast<unsigned char>(pPixel[1] * scale);
+			unsigned char blue = static_cast<unsigned char>(pPixel[2] * scale);
+			unsigned char* pOutputPixel = pOutputRow + (x * bytesPerPixel);
+			pOutputPixel[0] = (layout == LAYOUT_BGRA8) ? blue : red;
+			pOutputPixel[1] = green;
+			pOutputPixel[2] = (layout == LAYOUT_BGRA8) ? red : blue;
+			if (bytesPerPixel == 4) pOutputPixel[3] = 255;
+		}
+	}
+}
+
+// function to convert the image to tightly packed 8 bit RGB
+void image::convertToRGB8(std::vector<unsigned char>& rgbData) {
+	rgbData.resize(m_xSize * m_ySize * 3);
+	convertTo8Bit(rgbData.data(), m_xSize * 3, LAYOUT_RGB8);
+}
+
+// function to write the image to a file, in the format given by the extension
+bool image::save(const std::string& fileName) {
+	size_t dot = fileName.find_last_of('.');
+	std::string extension = (dot == std::string::npos) ? "" : fileName.substr(dot + 1);
+	for (char& c : extension) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+	if (extension == "ppm") return savePPM(fileName);
+	if (extension == "pfm") return savePFM(fileName);
+	if (extension == "png") return savePNG(fileName);
+	return false;
+}
+
+// function to write the image as a binary PPM (8 bits per channel, scaled as for display)
+bool image::savePPM(const std::string& fileName) {
+	std::vector<unsigned char> rgbData;
+	convertToRGB8(rgbData);
+	std::ofstream file(fileName, std::ios::binary);
+	if (!file) return false;
+	file << "P6\n" << m_xSize << " " << m_ySize << "\n255\n";
+	file.write(reinterpret_cast<const char*>(rgbData.data()), rgbData.size());
+	return static_cast<bool>(file);
+}
+
+// function to write the image as a PFM (32 bit float per channel, unscaled)
+bool image::savePFM(const std::string& fileName) {
+	std::ofstream file(fileName, std::ios::binary);
+	if (!file) return false;
+	// a negative scale marks the data as little endian
+	uint32_t endianTest = 1;
+	bool littleEndian = (*reinterpret_cast<unsigned char*>(&endianTest) == 1);
+	file << "PF\n" << m_xSize << " " << m_ySize << "\n" << (littleEndian ? "-1.0" : "1.0") << "\n";
+	// PFM stores the rows from bottom to top
+	std::vector<float> row(m_xSize * 3);
+	for (int y = m_ySize - 1; y >= 0; y--) {
+		const float* pRow = getRow(y);
+		for (int x = 0; x < m_xSize; x++) {
+			row[(x * 3)] = pRow[(x * NUM_CHANNELS)];
+			row[(x * 3) + 1] = pRow[(x * NUM_CHANNELS) + 1];
+			row[(x * 3) + 2] = pRow[(x * NUM_CHANNELS) + 2];
 		}
+		file.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
 	}
-	// update the texture with the pixel buffer
-	SDL_UpdateTexture(m_pTexture, NULL, tempPixels, m_xSize * sizeof(Uint32));
-	// delete the pixel buffer
-	delete[] tempPixels;
-	// copy the texture to the renderer
-	SDL_Rect srcRect, bounds;
-	srcRect.x = 0;
-	srcRect.y = 0;
-	srcRect.w = m_xSize;
-	srcRect.h = m_ySize;
-	bounds = srcRect;
-	SDL_RenderCopy(m_pRenderer, m_pTexture, &srcRect, &bounds);
-}
-
-// function to initialize the texture
-void image::initTexture() {
-	// initialize the texture
-	Uint32 rmask, gmask, bmask, amask;
-	// from SDL2 docs on mask values based on byteorder
-	#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-		rmask = 0xff000000;
-		gmask = 0x00ff0000;
-		bmask = 0x0000ff00;
-		amask = 0x000000ff;
-	#else
-		rmask = 0x000000ff;
-		gmask = 0x0000ff00;
-		bmask = 0x00ff0000;
-		amask = 0xff000000;
-	#endif
-	// delete any previously created texture
-	if (m_pTexture != NULL)
-		SDL_DestroyTexture(m_pTexture);
-	// create the texture that will store the image;
-	SDL_Surface* tempSurface = SDL_CreateRGBSurface(0, m_xSize, m_ySize, 32, rmask, gmask, bmask, amask);
-	m_pTexture = SDL_CreateTextureFromSurface(m_pRenderer, tempSurface);
-	SDL_FreeSurface(tempSurface);
-}
-
-// function to convert colors to Uint32
-Uint32 image::convertColor(const double red, const double green, const double blue) {
-	// convert the colors to unsigned integers
-	unsigned char r = static_cast<unsigned char>((red / m_overallMax) * 255.0);;
-	unsigned char g = static_cast<unsigned char>((green / m_overallMax) * 255.0);
-	unsigned char b = static_cast<unsigned char>((blue / m_overallMax) * 255.0);
-	#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-		Uint32 pixelColor = (r << 24) + (g << 16) + (b << 8) + 255;
-	#else
-		Uint32 pixelColor = (255 << 24) + (r << 16) + (g << 8) + b;
-	#endif
-	return pixelColor;
+	return static_cast<bool>(file);
+}
+
+// function to read a PFM (only the 3 channel colour kind that savePFM writes)
+bool image::loadPFM(const std::string& fileName) {
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file) return false;
+	std::string magic;
+	int xSize = 0, ySize = 0;
+	double scale = 0.0;
+	file >> magic >> xSize >> ySize >> scale;
+	if (!file || (magic != "PF") || (xSize <= 0) || (ySize <= 0) || (scale == 0.0)) return false;
+	// a single whitespace character separates the header from the data
+	file.get();
+	uint32_t endianTest = 1;
+	bool littleEndian = (*reinterpret_cast<unsigned char*>(&endianTest) == 1);
+	bool swapBytes = (scale < 0.0) != littleEndian;
+	initialize(xSize, ySize);
+	std::vector<float> row(m_xSize * 3);
+	for (int y = m_ySize - 1; y >= 0; y--) {
+		if (!file.read(reinterpret_cast<char*>(row.data()), row.size() * sizeof(float))) return false;
+		if (swapBytes) {
+			for (float& value : row) {
+				unsigned char* pBytes = reinterpret_cast<unsigned char*>(&value);
+				std::swap(pBytes[0], pBytes[3]);
+				std::swap(pBytes[1], pBytes[2]);
+			}
+		}
+		float* pRow = getRow(y);
+		for (int x = 0; x < m_xSize; x++) {
+			pRow[(x * NUM_CHANNELS)] = row[(x * 3)];
+			pRow[(x * NUM_CHANNELS) + 1] = row[(x * 3) + 1];
+			pRow[(x * NUM_CHANNELS) + 2] = row[(x * 3) + 2];
+		}
+	}
+	return true;
+}
+
+// function to write the image as an 8 bit RGB PNG (scaled as for display)
+bool image::savePNG(const std::string& fileName) {
+	std::vector<unsigned char> rgbData;
+	convertToRGB8(rgbData);
+	std::vector<unsigned char> pngData;
+	encodePNG(m_xSize, m_ySize, rgbData, pngData);
+	std::ofstream file(fileName, std::ios::binary);
+	if (!file) return false;
+	file.write(reinterpret_cast<const char*>(pngData.data()), pngData.size());
+	return static_cast<bool>(file);
 }
 
 // functions to return the dimensions of the image
-int image::getXSize() {
+int image::getXSize() const {
 	return m_xSize;
 }
 
-int image::getYSize() {
+int image::getYSize() const {
 	return m_ySize;
 }
 
 // function to compute maximum values
-void image::computeMaxValues() {
+void image::computeMaxValues(RT::threadpool* pThreadPool) {
+	// find the maximum of each band, then combine them
+	if (pThreadPool != nullptr) {
+		pThreadPool->parallelFor(m_numBands, [this](int band, int threadIndex) { computeBandMax(band); });
+	}
+	else {
+		for (int band = 0; band < m_numBands; band++) computeBandMax(band);
+	}
 	m_maxRed = 0.0;
 	m_maxGreen = 0.0;
 	m_maxBlue = 0.0;
-	m_overallMax = 0.0;
-	for (int x = 0; x < m_xSize; x++) {
-		for (int y = 0; y < m_ySize; y++) {
-			double redValue = m_rChannel.at(x).at(y);
-			double greenValue = m_gChannel.at(x).at(y);
-			double blueValue = m_bChannel.at(x).at(y);
-			if (redValue > m_maxRed) m_maxRed = redValue;
-			if (greenValue > m_maxGreen) m_maxGreen = greenValue;
-			if (blueValue > m_maxBlue) m_maxBlue = blueValue;
-			if (m_maxRed > m_overallMax) m_overallMax = m_maxRed;
-			if (m_maxGreen > m_overallMax) m_overallMax = m_maxGreen;
-			if (m_maxBlue > m_overallMax) m_overallMax = m_maxBlue;
+	for (int band = 0; band < m_numBands; band++) {
+		const float* pBandMax = &m_bandMax[band * NUM_CHANNELS];
+		if (pBandMax[0] > m_maxRed) m_maxRed = pBandMax[0];
+		if (pBandMax[1] > m_maxGreen) m_maxGreen = pBandMax[1];
+		if (pBandMax[2] > m_maxBlue) m_maxBlue = pBandMax[2];
+	}
+	m_overallMax = m_maxRed;
+	if (m_maxGreen > m_overallMax) m_overallMax = m_maxGreen;
+	if (m_maxBlue > m_overallMax) m_overallMax = m_maxBlue;
+}
+
+// function to compute the maximum of each channel over a band of rows
+void image::computeBandMax(const int band) {
+	int yEnd = (band + 1) * IMAGE_BAND_ROWS;
+	if (yEnd > m_ySize) yEnd = m_ySize;
+	float* pBandMax = &m_bandMax[band * NUM_CHANNELS];
+#if defined(RT_SIMD_AVX) || defined(RT_SIMD_SSE2)
+	// each pixel is one register, so a running maximum covers all channels at once
+	__m128 maxValues = _mm_setzero_ps();
+	for (int y = band * IMAGE_BAND_ROWS; y < yEnd; y++) {
+		const float* pRow = getRow(y);
+		for (int x = 0; x < m_xSize; x++) maxValues = _mm_max_ps(maxValues, _mm_load_ps(pRow + (x * NUM_CHANNELS)));
+	}
+	_mm_storeu_ps(pBandMax, maxValues);
+#else
+	for (int i = 0; i < NUM_CHANNELS; i++) pBandMax[i] = 0.0f;
+	for (int y = band * IMAGE_BAND_ROWS; y < yEnd; y++) {
+		const float* pRow = getRow(y);
+		for (int x = 0; x < m_xSize; x++) {
+			for (int i = 0; i < NUM_CHANNELS; i++) {
+				if (pRow[(x * NUM_CHANNELS) + i] > pBandMax[i]) pBandMax[i] = pRow[(x * NUM_CHANNELS) + i];
+			}
 		}
 	}
-}
\ No newline at end of file
+#endif
+}
@@ -3,41 +3,99 @@
 #define IMAGE_H
 #include <string>
 #include <vector>
-#include <SDL.h>
 
+// forward declare the thread pool, used to share out conversions between threads
+namespace RT {
+	class threadpool;
+}
+
+// the rendered image, stored as a single row-major buffer of interleaved float RGBA pixels
+// each row starts on a 64 byte boundary, and the pixel accessors don't check their arguments
+// render threads write disjoint tiles with writeTile, so no synchronisation is needed
+// it doesn't depend on SDL, so scenes can be rendered without a window and written straight to a file (sdldisplay shows it in the viewer)
 class image {
 public:
+	// number of floats stored per pixel (red, green, blue, and an unused fourth channel that keeps pixels 16 byte aligned)
+	static constexpr int NUM_CHANNELS = 4;
 	// constructor
 	image();
 	// destructor
 	~image();
-	// function to initialize
-	void initialize(const int xSize, const int ySize, SDL_Renderer* pRenderer);
+	// the pixel buffer points into m_storage, so images can't be copied
+	image(const image&) = delete;
+	image& operator= (const image&) = delete;
+	// function to initialize (all pixels are set to black)
+	void initialize(const int xSize, const int ySize);
 	// function to set the color of a pixel
 	void setPixel(const int x, const int y, const double red, const double green, const double blue);
-	// function to handle the image for display
-	void display();
+	// function to return the color of a pixel
+	void getPixel(const int x, const int y, double& red, double& green, double& blue) const;
+	// function to write a block of pixels, tileData holds tileWidth * tileHeight RGBA pixels in row-major order
+	void writeTile(const int x0, const int y0, const int tileWidth, const int tileHeight, const float* tileData);
+	// functions to return a pointer to the first pixel of a row
+	float* getRow(const int y);
+	const float* getRow(const int y) const;
+	// function to return the number of floats from the start of one row to the next
+	int getRowStride() const;
 	// functions to return the dimensions of the image
-	int getXSize();
-	int getYSize();
+	int getXSize() const;
+	int getYSize() const;
+	// byte layouts that the image can be converted to (the 4 byte layouts have alpha set to 255)
+	enum pixellayout { LAYOUT_RGB8, LAYOUT_RGBA8, LAYOUT_BGRA8 };
+	// function to convert the image to 8 bits per channel, scaled so that the brightest channel is 255 (rows from top to bottom)
+	// rows of the output start outputPitch bytes apart, and nothing is allocated once the image has been initialized
+	// if a thread pool is given, the rows are shared out between its threads
+	void convertTo8Bit(unsigned char* pOutput, const int outputPitch, const pixellayout layout, RT::threadpool* pThreadPool = nullptr);
+	// function to convert the image to tightly packed 8 bit RGB
+	void convertToRGB8(std::vector<unsigned char>& rgbData);
+	// functions to write the image to a file, return false if the file can't be written
+	// save picks the format from the extension of fileName (.ppm, .pfm or .png)
+	bool save(const std::string& fileName);
+	bool savePPM(const std::string& fileName);
+	bool savePFM(const std::string& fileName);
+	bool savePNG(const std::string& fileName);
+	// function to read a PFM written by savePFM, replacing the image, returns false if the file can't be read
+	bool loadPFM(const std::string& fileName);
 
 private:
-	// function that accepts RGB and returns Uint32 to represent that in color space for SDL2
-	Uint32 convertColor(const double red, const double green, const double blue);
-	// SDL2 handling
-	void initTexture();
-	void computeMaxValues();
-	// arrays to store image data
-	std::vector<std::vector<double>> m_rChannel; // red channel data
-	std::vector<std::vector<double>> m_gChannel; // greeen channel data
-	std::vector<std::vector<double>> m_bChannel; // blue channel data
-	// store the dimensions of the image
-	int m_xSize, m_ySize;
+	// function to compute the maximum of each channel, in a single pass shared out between threads
+	void computeMaxValues(RT::threadpool* pThreadPool);
+	// functions to compute the maximum of each channel, and to convert, a band of rows
+	void computeBandMax(const int band);
+	void convertBand(const int band, unsigned char* pOutput, const int outputPitch, const pixellayout layout, const double scale);
+	// storage for the pixels, with room to align the start of the buffer
+	std::vector<float> m_storage;
+	// the first pixel of the first row
+	float* m_pPixels;
+	// store the dimensions of the image, and the row stride in floats
+	int m_xSize, m_ySize, m_rowStride;
+	// the maximum of each channel within each band of rows (sized by initialize, so the conversion doesn't allocate)
+	std::vector<float> m_bandMax;
+	int m_numBands;
 	// store the maximum values
 	double m_maxRed, m_maxGreen, m_maxBlue, m_overallMax;
-	// SDL2 stuff
-	SDL_Renderer* m_pRenderer;
-	SDL_Texture* m_pTexture;
 };
 
-#endif
\ No newline at end of file
+inline void image::setPixel(const int x, const int y, const double red, const double green, const double blue) {
+	float* pPixel = m_pPixels + (y * m_rowStride) + (x * NUM_CHANNELS);
+	pPixel[0] = static_cast<float>(red);
+	pPixel[1] = static_cast<float>(green);
+	pPixel[2] = static_cast<float>(blue);
+}
+
+inline void image::getPixel(const int x, const int y, double& red, double& green, double& blue) const {
+	const float* pPixel = m_pPixels + (y * m_rowStride) + (x * NUM_CHANNELS);
+	red = pPixel[0];
+	green = pPixel[1];
+	blue = pPixel[2];
+}
+
+inline float* image::getRow(const int y) {
+	return m_pPixels + (y * m_rowStride);
+}
+
+inline const float* image::getRow(const int y) const {
+	return m_pPixels + (y * m_rowStride);
+}
+
+#endif
@@ -11,6 +11,11 @@ RT::lightbase::~lightbase() {
 }
 
 // function to compute illumination
-bool RT::lightbase::computeIllumination(const vector<double>& intPoint, const vector<double>& localNormal, const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::shared_ptr<RT::objectbase>& currentObject, vector<double>& color, double& intensity) {
+bool RT::lightbase::computeIllumination(const Vec3& intPoint, const Vec3& localNormal, const RT::bvh& objectBVH, const std::shared_ptr<RT::objectbase>& currentObject, RT::real time, Vec3& color, RT::real& intensity) {
+	return false;
+}
+
+// function to compute illumination if nothing blocks the light
+bool RT::lightbase::computeUnshadowedIllumination(const Vec3& intPoint, const Vec3& localNormal, RT::ray& lightRay, Vec3& color, RT::real& intensity) {
 	return false;
 }
\ No newline at end of file
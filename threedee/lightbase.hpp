@@ -1,9 +1,10 @@
 #ifndef LIGHTBASE_H
 #define LIGHTBASE_H
 #include <memory>
-#include "vector.hpp"
+#include "vecn.hpp"
 #include "ray.hpp"
 #include "objectbase.hpp"
+#include "bvh.hpp"
 
 namespace RT {
 	class lightbase {
@@ -11,11 +12,14 @@ namespace RT {
 			// constructor and destructor
 			lightbase();
 			virtual ~lightbase();
-			// function to compute illumination contribution
-			virtual bool computeIllumination(const vector<double>& intPoint, const vector<double>& localNormal, const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::shared_ptr<RT::objectbase>& currentObject, vector<double>& color, double& intensity);
-			vector<double> m_color{ 3 };
-			vector<double> m_location{ 3 };
-			double m_intensity;
+			// function to compute illumination contribution (time is the time of the ray that found the point, the shadow ray is traced at the same time)
+			virtual bool computeIllumination(const Vec3& intPoint, const Vec3& localNormal, const RT::bvh& objectBVH, const std::shared_ptr<RT::objectbase>& currentObject, real time, Vec3& color, real& intensity);
+			// function to compute the illumination contribution if nothing blocks the light, returns false if there is none anyway
+			// lightRay is set to the shadow ray to test, the light is blocked by anything it hits at t < 1
+			virtual bool computeUnshadowedIllumination(const Vec3& intPoint, const Vec3& localNormal, RT::ray& lightRay, Vec3& color, real& intensity);
+			Vec3 m_color;
+			Vec3 m_location;
+			real m_intensity;
 	};
 }
 
@@ -0,0 +1,82 @@
+#include "linereader.hpp"
+#include <cstring>
+#include <stdexcept>
+
+// size of each read (the buffer only grows if a single line is longer than this)
+constexpr size_t LINEREADER_CHUNK_SIZE = 1 << 20;
+
+// constructor
+RT::linereader::linereader() {
+	m_pFile = nullptr;
+	m_lineStart = 0;
+	m_filled = 0;
+	m_endOfFile = false;
+	m_lineNumber = 0;
+}
+
+// destructor
+RT::linereader::~linereader() {
+	close();
+}
+
+// function to open a file
+bool RT::linereader::open(const std::string& fileName) {
+	close();
+	m_pFile = std::fopen(fileName.c_str(), "rb");
+	if (m_pFile == nullptr) return false;
+	m_fileName = fileName;
+	m_buffer.resize(LINEREADER_CHUNK_SIZE);
+	return true;
+}
+
+// function to close the file
+void RT::linereader::close() {
+	if (m_pFile != nullptr) std::fclose(m_pFile);
+	m_pFile = nullptr;
+	m_lineStart = 0;
+	m_filled = 0;
+	m_endOfFile = false;
+	m_lineNumber = 0;
+}
+
+// function to return the next line
+char* RT::linereader::nextLine() {
+	if (m_pFile == nullptr) return nullptr;
+	while (true) {
+		char* pStart = m_buffer.data() + m_lineStart;
+		char* pEnd = m_buffer.data() + m_filled;
+		char* pNewline = static_cast<char*>(std::memchr(pStart, '\n', pEnd - pStart));
+		if (pNewline != nullptr) {
+			*pNewline = '\0';
+			m_lineStart = (pNewline + 1) - m_buffer.data();
+			m_lineNumber++;
+			return pStart;
+		}
+		if (m_endOfFile) {
+			// the last line doesn't need a newline, it is ended in the spare byte at the end of the buffer
+			if (pStart == pEnd) return nullptr;
+			*pEnd = '\0';
+			m_lineStart = m_filled;
+			m_lineNumber++;
+			return pStart;
+		}
+		// keep the partial line and read some more
+		size_t partial = pEnd - pStart;
+		std::memmove(m_buffer.data(), pStart, partial);
+		m_lineStart = 0;
+		m_filled = partial;
+		// one byte is always kept spare, so that the last line can be ended in place
+		if (m_filled == m_buffer.size() - 1) m_buffer.resize(m_buffer.size() * 2);
+		size_t numRead = std::fread(m_buffer.data() + m_filled, 1, m_buffer.size() - 1 - m_filled, m_pFile);
+		if (numRead == 0) {
+			if (std::ferror(m_pFile)) throw std::runtime_error("error reading " + m_fileName);
+			m_endOfFile = true;
+		}
+		m_filled += numRead;
+	}
+}
+
+// function to return the line number
+long long RT::linereader::getLineNumber() const {
+	return m_lineNumber;
+}
@@ -0,0 +1,39 @@
+#ifndef LINEREADER_H
+#define LINEREADER_H
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace RT {
+	// reads a text file a line at a time through a fixed size buffer, for the streaming parsers (scene files, OBJ meshes)
+	// lines are returned in place in the buffer, so nothing is copied or allocated per line
+	class linereader {
+		public:
+			// constructor and destructor
+			linereader();
+			~linereader();
+			// the file is owned, so the reader can't be copied
+			linereader(const linereader&) = delete;
+			linereader& operator= (const linereader&) = delete;
+			// function to open a file, returns false if it can't be opened
+			bool open(const std::string& fileName);
+			// function to close the file
+			void close();
+			// function to return the next line without its newline, null terminated (nullptr at the end of the file)
+			// the line may be modified, and stays valid until the next call, throws std::runtime_error if the file can't be read
+			char* nextLine();
+			// function to return the number of the line last returned (starting at 1)
+			long long getLineNumber() const;
+		private:
+			FILE* m_pFile;
+			std::string m_fileName;
+			// the read buffer, bytes [m_lineStart, m_filled) haven't been returned yet
+			std::vector<char> m_buffer;
+			size_t m_lineStart;
+			size_t m_filled;
+			bool m_endOfFile;
+			long long m_lineNumber;
+	};
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "mappedfile.hpp"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// constructor
+RT::mappedfile::mappedfile() {
+	m_pData = nullptr;
+	m_size = 0;
+#ifdef _WIN32
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = nullptr;
+#endif
+}
+
+// destructor
+RT::mappedfile::~mappedfile() {
+	close();
+}
+
+#ifdef _WIN32
+// function to map a file
+bool RT::mappedfile::open(const std::string& fileName) {
+	close();
+	m_hFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_hFile == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if ((!GetFileSizeEx(m_hFile, &fileSize)) || (fileSize.QuadPart <= 0) || (static_cast<unsigned long long>(fileSize.QuadPart) > static_cast<size_t>(-1))) {
+		close();
+		return false;
+	}
+	m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_hMapping == nullptr) {
+		close();
+		return false;
+	}
+	m_pData = static_cast<const unsigned char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_pData == nullptr) {
+		close();
+		return false;
+	}
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+// function to unmap the file
+void RT::mappedfile::close() {
+	if (m_pData != nullptr) UnmapViewOfFile(m_pData);
+	if (m_hMapping != nullptr) CloseHandle(m_hMapping);
+	if (m_hFile != INVALID_HANDLE_VALUE) CloseHandle(m_hFile);
+	m_pData = nullptr;
+	m_size = 0;
+	m_hMapping = nullptr;
+	m_hFile = INVALID_HANDLE_VALUE;
+}
+#else
+// function to map a file
+bool RT::mappedfile::open(const std::string& fileName) {
+	close();
+	int fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+	if (fileDescriptor < 0) return false;
+	struct stat fileInfo;
+	if ((fstat(fileDescriptor, &fileInfo) != 0) || (fileInfo.st_size <= 0)) {
+		::close(fileDescriptor);
+		return false;
+	}
+	void* pMapping = mmap(nullptr, static_cast<size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	// the mapping stays valid after the descriptor is closed
+	::close(fileDescriptor);
+	if (pMapping == MAP_FAILED) return false;
+	m_pData = static_cast<const unsigned char*>(pMapping);
+	m_size = static_cast<size_t>(fileInfo.st_size);
+	return true;
+}
+
+// function to unmap the file
+void RT::mappedfile::close() {
+	if (m_pData != nullptr) munmap(const_cast<unsigned char*>(m_pData), m_size);
+	m_pData = nullptr;
+	m_size = 0;
+}
+#endif
+
+// functions to return the mapped bytes
+const unsigned char* RT::mappedfile::getData() const {
+	return m_pData;
+}
+
+size_t RT::mappedfile::getSize() const {
+	return m_size;
+}
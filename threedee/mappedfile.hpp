@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <cstddef>
+#include <string>
+
+namespace RT {
+	// a file mapped read-only into memory (the operating system pages it in as it is read)
+	class mappedfile {
+		public:
+			// constructor and destructor
+			mappedfile();
+			~mappedfile();
+			// the mapping is owned, so it can't be copied
+			mappedfile(const mappedfile&) = delete;
+			mappedfile& operator= (const mappedfile&) = delete;
+			// function to map a file, returns false if it can't be opened or is empty
+			bool open(const std::string& fileName);
+			// function to unmap the file
+			void close();
+			// functions to return the mapped bytes
+			const unsigned char* getData() const;
+			size_t getSize() const;
+		private:
+			const unsigned char* m_pData;
+			size_t m_size;
+#ifdef _WIN32
+			// the file and mapping handles
+			void* m_hFile;
+			void* m_hMapping;
+#endif
+	};
+}
+
+#endif
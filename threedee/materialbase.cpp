@@ -1,9 +1,9 @@
 #include "materialbase.hpp"
+#include "renderstats.hpp"
 
 // constructor/destructor
 RT::materialbase::materialbase() {
-	m_maxReflectionRays = 3;
-	m_reflectionRayCount = 0;
+
 }
 
 RT::materialbase::~materialbase() {
@@ -11,25 +11,26 @@ RT::materialbase::~materialbase() {
 }
 
 // function to compute the color of the material
-vector<double> RT::materialbase::computeColor(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const vector<double>& intPoint, const vector<double>& localNormal, const RT::ray& cameraRay) {
+Vec3 RT::materialbase::computeColor(const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& cameraRay, const RT::pathstate& pathState) {
 	// define an initial material color
-	vector<double> matColor{ 3 };
+	Vec3 matColor;
 	return matColor;
 }
 
 // function to compute the diffuse color
-vector<double> RT::materialbase::computeDiffuseColor(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const vector<double>& intPoint, const vector<double>& localNormal, const vector<double>& baseColor) {
+Vec3 RT::materialbase::computeDiffuseColor(const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const Vec3& intPoint, const Vec3& localNormal, const Vec3& baseColor, RT::real time) {
 	// compute the color due to diffuse illumination
-	vector<double> diffuseColor{ 3 };
-	double intensity;
-	vector<double> color{ 3 };
-	double red = 0.0;
-	double green = 0.0;
-	double blue = 0.0;
+	RT_STAT_PHASE(PHASE_SHADE);
+	Vec3 diffuseColor;
+	RT::real intensity;
+	Vec3 color;
+	RT::real red = 0.0;
+	RT::real green = 0.0;
+	RT::real blue = 0.0;
 	bool validIllum = false;
 	bool illumFound = false;
-	for (auto currentLight : lightList) {
-		validIllum = currentLight->computeIllumination(intPoint, localNormal, objectList, currentObject, color, intensity);
+	for (const std::shared_ptr<RT::lightbase>& currentLight : lightList) {
+		validIllum = currentLight->computeIllumination(intPoint, localNormal, objectBVH, currentObject, time, color, intensity);
 		if (validIllum) {
 			illumFound = true;
 			red += color.getElement(0) * intensity;
@@ -47,31 +48,34 @@ vector<double> RT::materialbase::computeDiffuseColor(const std::vector<std::shar
 }
 
 // function to compute the color due to reflection
-vector<double> RT::materialbase::computeReflectionColor(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const vector<double>& intPoint, const vector<double>& localNormal, const RT::ray& incidentRay) {
-	vector<double> reflectionColor{ 3 };
+Vec3 RT::materialbase::computeReflectionColor(const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& incidentRay, const RT::pathstate& reflectedPath) {
+	Vec3 reflectionColor;
+	// stop if the path has reached the maximum depth (or carries too little light to matter)
+	if (!reflectedPath.isAlive()) return reflectionColor;
+	RT_STAT_COUNT(STAT_REFLECTION_RAYS);
 	// compute the reflection vector
-	vector<double> d = incidentRay.m_lab;
-	vector<double> reflectionVector = d - (2 * vector<double>::dot(d, localNormal) * localNormal);
-	// construct the reflection ray
-	RT::ray reflectionRay(intPoint, intPoint + reflectionVector);
+	Vec3 d = incidentRay.m_lab;
+	Vec3 reflectionVector = d - (2 * Vec3::dot(d, localNormal) * localNormal);
+	// construct the reflection ray, at the same time as the incident ray (and a little way off the surface if it could hit the object again)
+	Vec3 reflectionOrigin = currentObject->getRayOrigin(intPoint, localNormal, reflectionVector);
+	RT::ray reflectionRay(reflectionOrigin, reflectionOrigin + reflectionVector);
+	reflectionRay.m_time = incidentRay.m_time;
 	// cast this ray into the scene and find the closest object that it intersects with
 	std::shared_ptr<RT::objectbase> closestObject;
-	vector<double> closestIntPoint{ 3 };
-	vector<double> closestLocalNormal{ 3 };
-	vector<double> closestLocalColor{ 3 };
-	bool intersectionFound = castRay(reflectionRay, objectList, currentObject, closestObject, closestIntPoint, closestLocalNormal, closestLocalColor);
+	Vec3 closestIntPoint;
+	Vec3 closestLocalNormal;
+	Vec3 closestLocalColor;
+	bool intersectionFound = castRay(reflectionRay, objectBVH, currentObject, closestObject, closestIntPoint, closestLocalNormal, closestLocalColor);
 	// compute illumination for closest object assuming that there was a valid intersection
-	vector<double> matColor{ 3 };
-	if ((intersectionFound) && (m_reflectionRayCount < m_maxReflectionRays)) {
-		// increment the reflectionRayCount
-		m_reflectionRayCount++;
+	Vec3 matColor;
+	if (intersectionFound) {
 		// check if a material has been assigned
 		if (closestObject->m_hasMaterial) {
 			// use the material to compute the color
-			matColor = closestObject->m_pMaterial->computeColor(objectList, lightList, closestObject, closestIntPoint, closestLocalNormal, reflectionRay);
+			matColor = closestObject->m_pMaterial->computeColor(objectBVH, lightList, closestObject, closestIntPoint, closestLocalNormal, reflectionRay, reflectedPath);
 		}
 		else {
-			matColor = RT::materialbase::computeDiffuseColor(objectList, lightList, closestObject, closestIntPoint, closestLocalNormal, closestObject->m_baseColor);
+			matColor = RT::materialbase::computeDiffuseColor(objectBVH, lightList, closestObject, closestIntPoint, closestLocalNormal, closestObject->m_baseColor, reflectionRay.m_time);
 		}
 	}
 	else {
@@ -81,38 +85,25 @@ vector<double> RT::materialbase::computeReflectionColor(const std::vector<std::s
 	return reflectionColor;
 }
 
-// function to cast a ray into the scene
-bool RT::materialbase::castRay(const RT::ray& castRay, const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::shared_ptr<RT::objectbase>& thisObject, std::shared_ptr<RT::objectbase>& closestObject, vector<double>& closestIntPoint, vector<double>& closestLocalNormal, vector<double>& closestLocalColor) {
-	// test for intersections with all of the objects in the scene
-	vector<double> intPoint{ 3 };
-	vector<double> localNormal{ 3 };
-	vector<double> localColor{ 3 };
-	double minDist = 1e6;
-	bool intersectionFound = false;
-	for (auto currentObject : objectList) {
-		if (currentObject != thisObject) {
-			bool validInt = currentObject->testIntersections(castRay, intPoint, localNormal, localColor);
-			// if we have a valid intersection
-			if (validInt) {
-				// set the flag to show that we found an intersction
-				intersectionFound = true;
-				// compute the distance between the source and the intersection point
-				double dist = (intPoint - castRay.m_point1).norm();
-				// store a reference to this object if it is the closest 
-				if (dist < minDist) {
-					minDist = dist;
-					closestObject = currentObject;
-					closestIntPoint = intPoint;
-					closestLocalNormal = localNormal;
-					closestLocalColor = localColor;
-				}
-			}
-		}
-	}
-	return intersectionFound;
+// function to return the parts of the color
+RT::shadingterms RT::materialbase::getShadingTerms() const {
+	return RT::shadingterms();
+}
+
+// function to return the specular intensity
+RT::real RT::materialbase::computeSpecularIntensity(const RT::lightbase& light, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& cameraRay, RT::ray& lightRay) const {
+	return 0.0;
 }
 
-// below is only necessary because this is not using C++ 17
-// for C++ 17, just add "inline" in front of the declarations in the .hpp
-int RT::materialbase::m_maxReflectionRays;
-int RT::materialbase::m_reflectionRayCount;
\ No newline at end of file
+// function to combine the parts of the color
+Vec3 RT::materialbase::combineColor(const Vec3& difColor, const Vec3& refColor, const Vec3& spcColor) const {
+	Vec3 matColor;
+	return matColor;
+}
+
+// function to cast a ray into the scene
+bool RT::materialbase::castRay(const RT::ray& castRay, const RT::bvh& objectBVH, const std::shared_ptr<RT::objectbase>& thisObject, std::shared_ptr<RT::objectbase>& closestObject, Vec3& closestIntPoint, Vec3& closestLocalNormal, Vec3& closestLocalColor) {
+	// find the closest intersection with any object in the scene other than this one
+	RT_STAT_PHASE(PHASE_TRACE);
+	return objectBVH.castRay(castRay, thisObject, closestObject, closestIntPoint, closestLocalNormal, closestLocalColor);
+}
@@ -3,26 +3,42 @@
 #include <memory>
 #include "objectbase.hpp"
 #include "lightbase.hpp"
-#include "vector.hpp"
+#include "vecn.hpp"
 #include "ray.hpp"
+#include "pathstate.hpp"
 
 namespace RT {
+	// the parts that a material's color is made of, for integrators that evaluate them in separate stages (see wavefront.hpp)
+	struct shadingterms {
+		// whether the material is lit diffusely, and the color it is lit with
+		bool m_diffuse = false;
+		Vec3 m_baseColor;
+		// whether the material has specular highlights (see computeSpecularIntensity)
+		bool m_specular = false;
+		// the fraction of light arriving along the reflection ray (0 for no reflection ray)
+		real m_reflectivity = 0.0;
+	};
+
 	class materialbase {
 		public:
 			// constructor/destructor
 			materialbase();
 			virtual ~materialbase();
 			// function to return the color of the material
-			virtual vector<double> computeColor(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const vector<double>& intPoint, const vector<double>& localNormal, const RT::ray& cameraRay);
-			// function to compute diffuse color
-			static vector<double> computeDiffuseColor(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const vector<double>& intPoint, const vector<double>& localNormal, const vector<double> &baseColor);
-			// function to compute the reflection color
-			vector<double> computeReflectionColor(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const vector<double>& intPoint, const vector<double>& localNormal, const RT::ray& incidentRay);
+			virtual Vec3 computeColor(const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& cameraRay, const RT::pathstate& pathState);
+			// function to compute diffuse color (time is the time of the ray that found the point)
+			static Vec3 computeDiffuseColor(const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const Vec3& intPoint, const Vec3& localNormal, const Vec3 &baseColor, real time);
+			// function to compute the reflection color (reflectedPath is the state of the path after the reflection)
+			Vec3 computeReflectionColor(const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& incidentRay, const RT::pathstate& reflectedPath);
 			// function to cast a ray into the scene
-			bool castRay(const RT::ray& castRay, const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::shared_ptr<RT::objectbase>& thisObject, std::shared_ptr<RT::objectbase>& closestObject, vector<double>& closestIntPoint, vector<double>& closestLocalNormal, vector<double>& closestLocalColor);
-			// counter for the number of reflection rays
-			static int m_maxReflectionRays;
-			static int m_reflectionRayCount;
+			bool castRay(const RT::ray& castRay, const RT::bvh& objectBVH, const std::shared_ptr<RT::objectbase>& thisObject, std::shared_ptr<RT::objectbase>& closestObject, Vec3& closestIntPoint, Vec3& closestLocalNormal, Vec3& closestLocalColor);
+			// functions that split computeColor into its parts
+			// function to return the parts the material uses (none by default)
+			virtual RT::shadingterms getShadingTerms() const;
+			// function to return the specular intensity from a light if nothing blocks it, lightRay is set to the shadow ray to test (blocked at t < 1)
+			virtual real computeSpecularIntensity(const RT::lightbase& light, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& cameraRay, RT::ray& lightRay) const;
+			// function to combine the parts into the color of the material
+			virtual Vec3 combineColor(const Vec3& difColor, const Vec3& refColor, const Vec3& spcColor) const;
 	};
 }
 
@@ -0,0 +1,292 @@
+#include "meshdata.hpp"
+#include "renderstats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// entry on the traversal stack, the node index and the distance at which the ray enters its box
+struct meshStackEntry {
+	int m_node;
+	RT::real m_tNear;
+};
+
+// a ray prepared for the watertight ray/triangle test (Woop, Benthin and Wald, 2013)
+// the axes are permuted so that the largest component of the direction is z, and the triangle is sheared so the ray points along +z
+// the hit test is then done in 2D with no epsilons, and a ray through a shared edge or vertex always hits at least one of the triangles
+struct watertightRay {
+	Vec3 m_origin;
+	int m_kx;
+	int m_ky;
+	int m_kz;
+	RT::real m_sx;
+	RT::real m_sy;
+	RT::real m_sz;
+};
+
+// function to prepare a ray for the watertight test
+static watertightRay setupRay(const Vec3& origin, const Vec3& dir) {
+	watertightRay wRay;
+	wRay.m_origin = origin;
+	wRay.m_kz = 0;
+	if (fabs(dir[1]) > fabs(dir[wRay.m_kz])) wRay.m_kz = 1;
+	if (fabs(dir[2]) > fabs(dir[wRay.m_kz])) wRay.m_kz = 2;
+	wRay.m_kx = (wRay.m_kz + 1) % 3;
+	wRay.m_ky = (wRay.m_kx + 1) % 3;
+	// keep the winding order of the triangles
+	if (dir[wRay.m_kz] < 0.0) std::swap(wRay.m_kx, wRay.m_ky);
+	wRay.m_sx = dir[wRay.m_kx] / dir[wRay.m_kz];
+	wRay.m_sy = dir[wRay.m_ky] / dir[wRay.m_kz];
+	wRay.m_sz = 1.0 / dir[wRay.m_kz];
+	return wRay;
+}
+
+// constructor
+RT::meshdata::meshdata() {
+	m_numWithoutNormals = 0;
+	m_depth = 0;
+}
+
+// function to reserve space
+void RT::meshdata::reserve(int numVertices, int numTriangles) {
+	m_positionX.reserve(numVertices);
+	m_positionY.reserve(numVertices);
+	m_positionZ.reserve(numVertices);
+	m_normalX.reserve(numVertices);
+	m_normalY.reserve(numVertices);
+	m_normalZ.reserve(numVertices);
+	m_indices.reserve(3 * static_cast<size_t>(numTriangles));
+}
+
+// functions to add a vertex
+int RT::meshdata::addVertex(const Vec3& position) {
+	m_numWithoutNormals++;
+	return addVertex(position, Vec3{ 0.0, 0.0, 0.0 });
+}
+
+int RT::meshdata::addVertex(const Vec3& position, const Vec3& normal) {
+	m_positionX.push_back(position[0]);
+	m_positionY.push_back(position[1]);
+	m_positionZ.push_back(position[2]);
+	m_normalX.push_back(normal[0]);
+	m_normalY.push_back(normal[1]);
+	m_normalZ.push_back(normal[2]);
+	return static_cast<int>(m_positionX.size()) - 1;
+}
+
+// function to add a triangle
+void RT::meshdata::addTriangle(int v0, int v1, int v2) {
+	m_indices.push_back(v0);
+	m_indices.push_back(v1);
+	m_indices.push_back(v2);
+}
+
+// function to build the hierarchy
+void RT::meshdata::build() {
+	RT_STAT_PHASE(PHASE_BVH_BUILD);
+	int numVertices = getNumVertices();
+	int numTriangles = getNumTriangles();
+	if (numTriangles == 0) throw std::invalid_argument("cannot build a mesh with no triangles");
+	for (int index : m_indices) {
+		if ((index < 0) || (index >= numVertices)) throw std::invalid_argument("mesh triangle refers to a vertex that doesn't exist");
+	}
+	// the normals are all or nothing
+	if (m_numWithoutNormals > 0) {
+		m_normalX.clear();
+		m_normalY.clear();
+		m_normalZ.clear();
+		m_normalX.shrink_to_fit();
+		m_normalY.shrink_to_fit();
+		m_normalZ.shrink_to_fit();
+	}
+	// bound every triangle and build the hierarchy over them
+	std::vector<RT::aabb> triBounds(numTriangles);
+	std::vector<int> triOrder(numTriangles);
+	for (int i = 0; i < numTriangles; i++) {
+		for (int j = 0; j < 3; j++) triBounds[i].grow(getPosition(m_indices[(3 * i) + j]));
+		triOrder[i] = i;
+	}
+	m_depth = RT::bvh::buildHierarchy(triBounds, triOrder, m_nodes);
+	// store the triangles in leaf order, so the leaves can refer to them directly
+	std::vector<int> sortedIndices(m_indices.size());
+	for (int i = 0; i < numTriangles; i++) {
+		for (int j = 0; j < 3; j++) sortedIndices[(3 * i) + j] = m_indices[(3 * triOrder[i]) + j];
+	}
+	m_indices.swap(sortedIndices);
+}
+
+// function to return a vertex position
+Vec3 RT::meshdata::getPosition(int vertex) const {
+	return Vec3{ m_positionX[vertex], m_positionY[vertex], m_positionZ[vertex] };
+}
+
+// the watertight test of a ray against one triangle
+// on a hit with MESH_MIN_T < t < tMax, returns true with t and the barycentric weights of the second and third vertices
+static inline bool intersectTriangle(const watertightRay& wRay, const Vec3& p0, const Vec3& p1, const Vec3& p2, RT::real tMax, RT::real& t, RT::real& u, RT::real& v) {
+	// the vertices relative to the ray origin
+	Vec3 a = p0 - wRay.m_origin;
+	Vec3 b = p1 - wRay.m_origin;
+	Vec3 c = p2 - wRay.m_origin;
+	// shear them so the ray points along +z
+	RT::real ax = a[wRay.m_kx] - (wRay.m_sx * a[wRay.m_kz]);
+	RT::real ay = a[wRay.m_ky] - (wRay.m_sy * a[wRay.m_kz]);
+	RT::real bx = b[wRay.m_kx] - (wRay.m_sx * b[wRay.m_kz]);
+	RT::real by = b[wRay.m_ky] - (wRay.m_sy * b[wRay.m_kz]);
+	RT::real cx = c[wRay.m_kx] - (wRay.m_sx * c[wRay.m_kz]);
+	RT::real cy = c[wRay.m_ky] - (wRay.m_sy * c[wRay.m_kz]);
+	// scaled barycentric coordinates, the ray passes through the triangle if they all have the same sign (either winding is a hit)
+	RT::real edgeU = (cx * by) - (cy * bx);
+	RT::real edgeV = (ax * cy) - (ay * cx);
+	RT::real edgeW = (bx * ay) - (by * ax);
+	if (((edgeU < 0.0) || (edgeV < 0.0) || (edgeW < 0.0)) && ((edgeU > 0.0) || (edgeV > 0.0) || (edgeW > 0.0))) return false;
+	RT::real det = edgeU + edgeV + edgeW;
+	if (det == 0.0) return false;
+	// the scaled distance, checked against the range before dividing
+	RT::real az = wRay.m_sz * a[wRay.m_kz];
+	RT::real bz = wRay.m_sz * b[wRay.m_kz];
+	RT::real cz = wRay.m_sz * c[wRay.m_kz];
+	RT::real scaledT = (edgeU * az) + (edgeV * bz) + (edgeW * cz);
+	if (det > 0.0) {
+		if ((scaledT <= RT::MESH_MIN_T * det) || (scaledT >= tMax * det)) return false;
+	}
+	else {
+		if ((scaledT >= RT::MESH_MIN_T * det) || (scaledT <= tMax * det)) return false;
+	}
+	RT::real invDet = 1.0 / det;
+	t = scaledT * invDet;
+	u = edgeV * invDet;
+	v = edgeW * invDet;
+	return true;
+}
+
+// function to find the closest triangle hit by a ray
+bool RT::meshdata::intersect(const Vec3& origin, const Vec3& dir, RT::real tMax, RT::meshhit& hit) const {
+	if (m_nodes.empty()) return false;
+	watertightRay wRay = setupRay(origin, dir);
+	Vec3 invDir = dir.reciprocal();
+	RT::real tBest = tMax;
+	int closestTriangle = -1;
+	// traverse the hierarchy front to back, as bvh::castRay
+	meshStackEntry stack[RT::BVH_MAX_DEPTH + 4];
+	int stackSize = 0;
+	RT::real tNear;
+	if (m_nodes[0].m_bounds.intersect(origin, invDir, 0.0, tBest, tNear)) stack[stackSize++] = meshStackEntry{ 0, tNear };
+	while (stackSize > 0) {
+		meshStackEntry entry = stack[--stackSize];
+		if (entry.m_tNear > tBest) continue;
+		RT_STAT_COUNT(STAT_MESH_NODES);
+		const RT::bvh::node& currentNode = m_nodes[entry.m_node];
+		if (currentNode.m_count > 0) {
+			// leaf, test the triangles
+			for (int i = currentNode.m_index; i < currentNode.m_index + currentNode.m_count; i++) {
+				const int* tri = &m_indices[3 * i];
+				RT::real t, u, v;
+				RT_STAT_COUNT(STAT_TRIANGLE_TESTS);
+				if (intersectTriangle(wRay, getPosition(tri[0]), getPosition(tri[1]), getPosition(tri[2]), tBest, t, u, v)) {
+					tBest = t;
+					closestTriangle = i;
+					hit.m_u = u;
+					hit.m_v = v;
+				}
+			}
+		}
+		else {
+			// interior node, test both children and visit the nearer one first
+			int childA = entry.m_node + 1;
+			int childB = currentNode.m_index;
+			RT::real tA = 0.0, tB = 0.0;
+			bool hitA = m_nodes[childA].m_bounds.intersect(origin, invDir, 0.0, tBest, tA);
+			bool hitB = m_nodes[childB].m_bounds.intersect(origin, invDir, 0.0, tBest, tB);
+			if (hitA && hitB) {
+				if (tA <= tB) {
+					stack[stackSize++] = meshStackEntry{ childB, tB };
+					stack[stackSize++] = meshStackEntry{ childA, tA };
+				}
+				else {
+					stack[stackSize++] = meshStackEntry{ childA, tA };
+					stack[stackSize++] = meshStackEntry{ childB, tB };
+				}
+			}
+			else if (hitA) stack[stackSize++] = meshStackEntry{ childA, tA };
+			else if (hitB) stack[stackSize++] = meshStackEntry{ childB, tB };
+		}
+	}
+	if (closestTriangle < 0) return false;
+	hit.m_t = tBest;
+	hit.m_triangle = closestTriangle;
+	return true;
+}
+
+// function to test whether any triangle is hit closer than tMax
+bool RT::meshdata::occluded(const Vec3& origin, const Vec3& dir, RT::real tMax) const {
+	if (m_nodes.empty()) return false;
+	watertightRay wRay = setupRay(origin, dir);
+	Vec3 invDir = dir.reciprocal();
+	// any hit will do, so there is no need to order the children
+	int stack[RT::BVH_MAX_DEPTH + 4];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const RT::bvh::node& currentNode = m_nodes[stack[--stackSize]];
+		RT_STAT_COUNT(STAT_MESH_NODES);
+		RT::real tNear;
+		if (!currentNode.m_bounds.intersect(origin, invDir, 0.0, tMax, tNear)) continue;
+		if (currentNode.m_count > 0) {
+			for (int i = currentNode.m_index; i < currentNode.m_index + currentNode.m_count; i++) {
+				const int* tri = &m_indices[3 * i];
+				RT::real t, u, v;
+				RT_STAT_COUNT(STAT_TRIANGLE_TESTS);
+				if (intersectTriangle(wRay, getPosition(tri[0]), getPosition(tri[1]), getPosition(tri[2]), tMax, t, u, v)) return true;
+			}
+		}
+		else {
+			stack[stackSize++] = currentNode.m_index;
+			stack[stackSize++] = static_cast<int>(&currentNode - m_nodes.data()) + 1;
+		}
+	}
+	return false;
+}
+
+// function to return the normal at a hit
+Vec3 RT::meshdata::getNormal(const RT::meshhit& hit) const {
+	const int* tri = &m_indices[3 * hit.m_triangle];
+	Vec3 normal;
+	if (hasNormals()) {
+		RT::real w = 1.0 - hit.m_u - hit.m_v;
+		for (int j = 0; j < 3; j++) {
+			RT::real weight = (j == 0) ? w : ((j == 1) ? hit.m_u : hit.m_v);
+			normal += weight * Vec3{ m_normalX[tri[j]], m_normalY[tri[j]], m_normalZ[tri[j]] };
+		}
+	}
+	// fall back on the face normal where there are no vertex normals (or they cancel out)
+	if (normal.normSquared() == 0.0) {
+		Vec3 p0 = getPosition(tri[0]);
+		normal = Vec3::cross(getPosition(tri[1]) - p0, getPosition(tri[2]) - p0);
+	}
+	return normal.normalized();
+}
+
+// functions to return information about the mesh
+RT::aabb RT::meshdata::getBounds() const {
+	if (m_nodes.empty()) return RT::aabb();
+	return m_nodes[0].m_bounds;
+}
+
+int RT::meshdata::getNumVertices() const {
+	return static_cast<int>(m_positionX.size());
+}
+
+int RT::meshdata::getNumTriangles() const {
+	return static_cast<int>(m_indices.size() / 3);
+}
+
+bool RT::meshdata::hasNormals() const {
+	return (!m_normalX.empty()) && (m_numWithoutNormals == 0);
+}
+
+int RT::meshdata::getNodeCount() const {
+	return static_cast<int>(m_nodes.size());
+}
+
+int RT::meshdata::getDepth() const {
+	return m_depth;
+}
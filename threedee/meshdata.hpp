@@ -0,0 +1,74 @@
+#ifndef MESHDATA_H
+#define MESHDATA_H
+#include <vector>
+#include "vecn.hpp"
+#include "aabb.hpp"
+#include "bvh.hpp"
+
+namespace RT {
+	// the smallest ray parameter counted as a hit, so that rays leaving a mesh don't hit the triangle they start on
+	constexpr real MESH_MIN_T = precisionTolerance(1e-4, 1e-9);
+
+	// the closest hit between a ray and a mesh
+	struct meshhit {
+		// the ray parameter of the hit
+		real m_t;
+		// the triangle hit
+		int m_triangle;
+		// the barycentric weights of the triangle's second and third vertices at the hit
+		real m_u;
+		real m_v;
+	};
+
+	// triangle mesh geometry in the mesh's local coordinates, shared by every objmesh that uses it
+	// positions and normals are kept as separate x, y and z arrays, and each triangle as the indices of its three vertices
+	// build() adds a bounding volume hierarchy over the triangles and reorders them so that every leaf is a contiguous run
+	class meshdata {
+		public:
+			// constructor
+			meshdata();
+			// function to reserve space before adding vertices and triangles
+			void reserve(int numVertices, int numTriangles);
+			// functions to add a vertex, returns its index
+			// per-vertex normals are only used if every vertex is given one, otherwise the face normals are used
+			int addVertex(const Vec3& position);
+			int addVertex(const Vec3& position, const Vec3& normal);
+			// function to add a triangle (counter-clockwise when seen from the front)
+			void addTriangle(int v0, int v1, int v2);
+			// function to build the hierarchy once every vertex and triangle has been added
+			// throws std::invalid_argument if the mesh is empty or a triangle refers to a vertex that doesn't exist
+			void build();
+			// function to find the closest triangle hit by the ray origin + t * dir with MESH_MIN_T < t < tMax (both in local coordinates)
+			bool intersect(const Vec3& origin, const Vec3& dir, real tMax, RT::meshhit& hit) const;
+			// function to test whether any triangle is hit with MESH_MIN_T < t < tMax
+			bool occluded(const Vec3& origin, const Vec3& dir, real tMax) const;
+			// function to return the unit normal at a hit (interpolated from the vertex normals if there are any)
+			Vec3 getNormal(const RT::meshhit& hit) const;
+			// functions to return information about the mesh
+			RT::aabb getBounds() const;
+			int getNumVertices() const;
+			int getNumTriangles() const;
+			bool hasNormals() const;
+			int getNodeCount() const;
+			int getDepth() const;
+		private:
+			// function to return a vertex position
+			Vec3 getPosition(int vertex) const;
+			// the vertices
+			std::vector<real> m_positionX;
+			std::vector<real> m_positionY;
+			std::vector<real> m_positionZ;
+			std::vector<real> m_normalX;
+			std::vector<real> m_normalY;
+			std::vector<real> m_normalZ;
+			// the number of vertices added without a normal
+			int m_numWithoutNormals;
+			// the triangles, three vertex indices each
+			std::vector<int> m_indices;
+			// the hierarchy over the triangles, a leaf covers triangles [m_index, m_index + m_count)
+			std::vector<RT::bvh::node> m_nodes;
+			int m_depth;
+	};
+}
+
+#endif
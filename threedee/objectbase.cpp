@@ -1,6 +1,5 @@
 #include "objectbase.hpp"
 #include <math.h>
-#define EPSILON 1e-21f;
 
 // default constructor
 RT::objectbase::objectbase() {
@@ -13,12 +12,98 @@ RT::objectbase::~objectbase() {
 }
 
 // function to test for intersections
-bool RT::objectbase::testIntersections(const ray& castRay, vector<double>& intPoint, vector<double>& localNormal, vector<double>& localColor) {
+bool RT::objectbase::testIntersections(const ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
 	return false;
 }
 
+// function to find the closest hit before tMax
+// the default falls back to the full intersection test
+bool RT::objectbase::intersect(const ray& castRay, RT::real tMax, RT::hitrecord& hit) {
+	Vec3 intPoint;
+	Vec3 localNormal;
+	Vec3 localColor;
+	if (!testIntersections(castRay, intPoint, localNormal, localColor)) return false;
+	// convert the distance to the intersection into the ray parameter
+	RT::real t = (intPoint - castRay.m_point1).norm() / castRay.m_lab.norm();
+	if (t >= tMax) return false;
+	hit.m_t = t;
+	hit.m_primitive = -1;
+	return true;
+}
+
+// function to compute the shading data of a hit
+// the default repeats the full intersection test
+void RT::objectbase::computeHitData(const ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	testIntersections(castRay, intPoint, localNormal, localColor);
+}
+
+// function to test for an intersection closer than tMax
+// the default falls back to the full intersection test, objects should override this with something cheaper
+bool RT::objectbase::occluded(const ray& castRay, RT::real tMax) {
+	Vec3 intPoint;
+	Vec3 localNormal;
+	Vec3 localColor;
+	if (!testIntersections(castRay, intPoint, localNormal, localColor)) return false;
+	// convert the distance to the intersection into the ray parameter
+	return (intPoint - castRay.m_point1).norm() < (tMax * castRay.m_lab.norm());
+}
+
+// function to test a packet of rays
+// the default tests one lane at a time with testIntersections, objects should override this with a simd version
+int RT::objectbase::intersectPacket(const RT::raypacket& rays, double* tHit) {
+	int hitMask = 0;
+	Vec3 intPoint;
+	Vec3 localNormal;
+	Vec3 localColor;
+	for (int i = 0; i < rays.m_numRays; i++) {
+		Vec3 origin = rays.getOrigin(i);
+		Vec3 dir = rays.getDirection(i);
+		if (!testIntersections(RT::ray(origin, origin + dir), intPoint, localNormal, localColor)) continue;
+		// convert the distance to the intersection into the ray parameter
+		RT::real t = (intPoint - origin).norm() / dir.norm();
+		if (t < tHit[i]) {
+			tHit[i] = t;
+			hitMask |= 1 << i;
+		}
+	}
+	return hitMask;
+}
+
+// function to return the local bounds
+RT::aabb RT::objectbase::getLocalBounds() const {
+	return RT::aabb::infinite();
+}
+
+// function to return the concrete type of the object
+RT::primitivetype RT::objectbase::getPrimitiveType() const {
+	return RT::PRIMITIVE_OTHER;
+}
+
+// function to test whether a ray leaving the surface can hit the object again
+bool RT::objectbase::canHitItself() const {
+	return true;
+}
+
+// function to return where a ray leaving the surface starts
+Vec3 RT::objectbase::getRayOrigin(const Vec3& intPoint, const Vec3& normal, const Vec3& direction) const {
+	if (!canHitItself()) return intPoint;
+	return intPoint + (normal * ((Vec3::dot(direction, normal) >= 0.0) ? RT::OBJECT_RAY_OFFSET : -RT::OBJECT_RAY_OFFSET));
+}
+
+// function to return the world bounds
+const RT::aabb& RT::objectbase::getWorldBounds() const {
+	return m_worldBounds;
+}
+
+// function to recompute the world bounds (the local bounds carried through the forward transform)
+void RT::objectbase::updateBounds() {
+	m_worldBounds = getLocalBounds().transformed(m_transformMatrix.getForward());
+}
+
+// function to set the transform matrix
 void RT::objectbase::setTransformMatrix(const RT::GTform& transformMatrix) {
 	m_transformMatrix = transformMatrix;
+	updateBounds();
 }
 
 // function to assign a material
@@ -28,7 +113,10 @@ bool RT::objectbase::assignMaterial(const std::shared_ptr<RT::materialbase>& obj
 	return m_hasMaterial;
 }
 
+// the tolerance for closeEnough
+constexpr RT::real OBJECT_CLOSE_ENOUGH = RT::precisionTolerance(1e-12, 1e-21);
+
 // function to test whether two floating point numbers are close to being equal
-bool RT::objectbase::closeEnough(const double f1, const double f2) {
-	return fabs(f1 - f2) < EPSILON;
+bool RT::objectbase::closeEnough(const RT::real f1, const RT::real f2) {
+	return fabs(f1 - f2) < OBJECT_CLOSE_ENOUGH;
 }
\ No newline at end of file
@@ -1,32 +1,86 @@
 #ifndef OBJECTBASE_H
 #define OBJECTBASE_H
+#include <cstdint>
 #include <memory>
-#include "vector.hpp"
+#include "vecn.hpp"
 #include "ray.hpp"
 #include "gtfm.hpp"
+#include "aabb.hpp"
+#include "raypacket.hpp"
 
 namespace RT {
 	// forward declare the material base class
 	// this will be overridden later
 	class materialbase;
 
+	// the concrete types of object that the bounding volume hierarchy tests without a virtual call (see bvh.hpp)
+	enum primitivetype { PRIMITIVE_OTHER = 0, PRIMITIVE_SPHERE = 1, PRIMITIVE_PLANE = 2 };
+
+	// the distance that rays leaving the surface of an object they could hit again are started off it (see objectbase::getRayOrigin)
+	constexpr real OBJECT_RAY_OFFSET = precisionTolerance(1e-3, 1e-6);
+
+	// the closest hit of a ray on an object, found without computing any shading data
+	// it holds what computeHitData needs to work out the intersection point, normal and color afterwards
+	struct hitrecord {
+		// the ray parameter of the hit (the point is m_point1 + t * m_lab)
+		real m_t = 0.0;
+		// the part of the object that was hit (a triangle of a mesh), -1 for objects in one piece
+		int m_primitive = -1;
+		// the barycentric weights of the triangle's second and third vertices, for meshes
+		real m_u = 0.0;
+		real m_v = 0.0;
+		// the object hit within each group the ray went through, as the digits of a number with one base (its number of objects) per group, see objgroup::intersect
+		// 0 outside groups, the bvh clears it before testing each object
+		uint64_t m_groupPath = 0;
+	};
+
+
 	class objectbase {
 		public:
 			// constructor and destructor
 			objectbase();
 			virtual ~objectbase(); // declared as virtual because it's intended to be overridden
 			// function to test for intersections
-			virtual bool testIntersections(const ray& castRay, vector<double>& intPoint, vector<double>& localNormal, vector<double>& localColor);
-			// function to set the transform matrix
-			void setTransformMatrix(const RT::GTform& transformMatrix);
+			virtual bool testIntersections(const ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor);
+			// function to find the closest hit at a ray parameter t < tMax, without computing any shading data
+			// the defaults fall back to testIntersections, objects should override both this and computeHitData
+			virtual bool intersect(const ray& castRay, real tMax, RT::hitrecord& hit);
+			// function to compute the intersection point, normal and color of a hit found by intersect with the same ray
+			virtual void computeHitData(const ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor);
+			// function to test whether the ray hits the object at a parameter t < tMax (positions along the ray are m_point1 + t * m_lab)
+			// only used for shadow rays, where any hit will do and no shading data is needed
+			virtual bool occluded(const ray& castRay, real tMax);
+			// function to test a packet of rays, lanes that hit the object at a parameter t < tHit[lane] have tHit[lane] set to t
+			// returns a bitmask of the lanes that were updated (no shading data is computed, testIntersections gives that for the closest object)
+			virtual int intersectPacket(const RT::raypacket& rays, double* tHit);
+			// function to return the bounds of the object in its local coordinate system
+			// the default is an infinite box, so objects that don't override this are treated as unbounded
+			virtual RT::aabb getLocalBounds() const;
+			// function to return the concrete type of the object, PRIMITIVE_OTHER (the default) for anything only reached through the virtual functions
+			virtual RT::primitivetype getPrimitiveType() const;
+			// function to test whether a ray leaving the surface of the object can hit the object again
+			// it can't for the convex sphere and plane, so shadow and reflection rays skip them entirely, and other objects (meshes, groups and instances) are tested as usual
+			virtual bool canHitItself() const;
+			// function to return where a ray leaving a point on the surface in the given direction starts
+			// for objects that the ray could hit again it is OBJECT_RAY_OFFSET off the surface (on the side the ray leaves by), so it doesn't find the point it starts from
+			Vec3 getRayOrigin(const Vec3& intPoint, const Vec3& normal, const Vec3& direction) const;
+			// function to return the bounds of the object in world coordinates (kept by updateBounds, so this is cheap enough for every ray)
+			const RT::aabb& getWorldBounds() const;
+			// function to recompute the world bounds from the local bounds and the transform
+			// setTransformMatrix calls this, and objects call it at the end of their constructor (until then the bounds are infinite)
+			void updateBounds();
+			// function to set the transform matrix (objects that keep data derived from it override this, and call it first)
+			virtual void setTransformMatrix(const RT::GTform& transformMatrix);
 			// function to test whether two floating point numbers are close to being equal
-			bool closeEnough(const double f1, const double f2);
+			bool closeEnough(const real f1, const real f2);
 			// function to assign a material
 			bool assignMaterial(const std::shared_ptr<RT::materialbase>& objectMaterial);
 			// the base color of the object
-			vector<double> m_baseColor{ 3 };
+			Vec3 m_baseColor;
 			// the geometric transform applied to the object
 			RT::GTform m_transformMatrix;
+			// the bounds of the object in world coordinates
+			RT::aabb m_worldBounds = RT::aabb::infinite();
 			// a reference to the material assigned to this object
 			std::shared_ptr<RT::materialbase> m_pMaterial;
 			// a flag to indicate whether this object has a material or not
@@ -0,0 +1,78 @@
+#include "objgroup.hpp"
+#include <limits>
+
+// constructor
+RT::objgroup::objgroup(const std::vector<std::shared_ptr<RT::objectbase>>& objectList) {
+	m_objectBVH.build(objectList);
+	for (const auto& object : objectList) m_localBounds.grow(object->getWorldBounds());
+	updateBounds();
+}
+
+// destructor
+RT::objgroup::~objgroup() {
+
+}
+
+// function to return the local bounds
+RT::aabb RT::objgroup::getLocalBounds() const {
+	return m_localBounds;
+}
+
+// function to return the objects in the group
+const std::vector<std::shared_ptr<RT::objectbase>>& RT::objgroup::getObjectList() const {
+	return m_objectBVH.getObjectList();
+}
+
+// function to test for intersections
+bool RT::objgroup::testIntersections(const RT::ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	RT::hitrecord hit;
+	if (!intersect(castRay, std::numeric_limits<RT::real>::infinity(), hit)) return false;
+	computeHitData(castRay, hit, intPoint, localNormal, localColor);
+	return true;
+}
+
+// function to find the closest hit before tMax
+// the hit record is the object's own, with the index of the object added as the lowest digit of m_groupPath (objects inside it may be groups too)
+bool RT::objgroup::intersect(const RT::ray& castRay, RT::real tMax, RT::hitrecord& hit) {
+	// transform the ray into the group's coordinates once, for every object in it (the ray parameter t is the same in both)
+	int closestIndex = m_objectBVH.intersect(m_transformMatrix.apply(castRay, RT::BCKTFM), tMax, nullptr, hit);
+	if (closestIndex < 0) return false;
+	hit.m_groupPath = (hit.m_groupPath * m_objectBVH.getObjectList().size()) + static_cast<uint64_t>(closestIndex);
+	return true;
+}
+
+// function to compute the shading data of a hit
+void RT::objgroup::computeHitData(const RT::ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	RT::ray localRay = m_transformMatrix.apply(castRay, RT::BCKTFM);
+	// take the index of the object off m_groupPath, which leaves the object's own hit record
+	uint64_t numObjects = m_objectBVH.getObjectList().size();
+	RT::objectbase* closestObject = m_objectBVH.getObjectList()[hit.m_groupPath % numObjects].get();
+	RT::hitrecord objectHit = hit;
+	objectHit.m_groupPath = hit.m_groupPath / numObjects;
+	Vec3 localIntPoint;
+	Vec3 normal;
+	closestObject->computeHitData(localRay, objectHit, localIntPoint, normal, localColor);
+	intPoint = m_transformMatrix.apply(localIntPoint, RT::FWDTFM);
+	// normals are carried back by the transpose of the backward transform
+	localNormal = m_transformMatrix.getBackward().transformTransposed(normal);
+	localNormal.normalize();
+}
+
+// function to test for an intersection closer than tMax
+bool RT::objgroup::occluded(const RT::ray& castRay, RT::real tMax) {
+	return m_objectBVH.occluded(m_transformMatrix.apply(castRay, RT::BCKTFM), tMax, nullptr);
+}
+
+// function to test a packet of rays
+int RT::objgroup::intersectPacket(const RT::raypacket& rays, double* tHit) {
+	RT::raypacket localRays;
+	RT::transformPacket(m_transformMatrix.getBackward(), rays, localRays);
+	RT::packethit hits;
+	for (int i = 0; i < RT::PACKET_SIZE; i++) {
+		hits.m_t[i] = tHit[i];
+		hits.m_index[i] = -1;
+	}
+	int hitMask = m_objectBVH.tracePacket(localRays, hits);
+	for (int i = 0; i < RT::PACKET_SIZE; i++) tHit[i] = hits.m_t[i];
+	return hitMask;
+}
@@ -0,0 +1,38 @@
+#ifndef OBJGROUP_H
+#define OBJGROUP_H
+#include <memory>
+#include <vector>
+#include "objectbase.hpp"
+#include "gtfm.hpp"
+#include "bvh.hpp"
+
+namespace RT {
+	// a group of objects treated as one, with a bounding volume hierarchy of its own over them
+	// the objects are placed in the group's local coordinates, and the group by its own transform
+	// groups are the shared geometry behind instances (see objinstance), so one hierarchy serves every copy
+	class objgroup : public objectbase {
+		public:
+			// constructor
+			objgroup(const std::vector<std::shared_ptr<RT::objectbase>>& objectList);
+			// override the destructor
+			virtual ~objgroup() override;
+			// override the function to test for intersections
+			virtual bool testIntersections(const RT::ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) override;
+			// override the functions to find the closest hit and compute its shading data
+			virtual bool intersect(const RT::ray& castRay, real tMax, RT::hitrecord& hit) override;
+			virtual void computeHitData(const RT::ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) override;
+			// override the function to test for an intersection closer than tMax
+			virtual bool occluded(const RT::ray& castRay, real tMax) override;
+			// override the function to test a packet of rays (the packet is traced through the group's hierarchy)
+			virtual int intersectPacket(const RT::raypacket& rays, double* tHit) override;
+			// override the function to return the local bounds (around every object in the group)
+			virtual RT::aabb getLocalBounds() const override;
+			// function to return the objects in the group
+			const std::vector<std::shared_ptr<RT::objectbase>>& getObjectList() const;
+		private:
+			RT::bvh m_objectBVH;
+			RT::aabb m_localBounds;
+	};
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "objinstance.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// constructor
+RT::objinstance::objinstance(const std::shared_ptr<RT::objectbase>& prototype) {
+	m_pPrototype = prototype;
+	updateBounds();
+}
+
+// destructor
+RT::objinstance::~objinstance() {
+
+}
+
+// function to return the local bounds
+RT::aabb RT::objinstance::getLocalBounds() const {
+	return m_pPrototype->getWorldBounds();
+}
+
+// function to set the transform matrix
+void RT::objinstance::setTransformMatrix(const RT::GTform& transformMatrix) {
+	m_hasMotion = false;
+	objectbase::setTransformMatrix(transformMatrix);
+}
+
+// function to make the instance move
+void RT::objinstance::setMotion(const RT::gtfmparts& start, const RT::gtfmparts& end) {
+	RT::GTform startTransform;
+	startTransform.setTransform(start.m_translation, start.m_rotation, start.m_scale);
+	objectbase::setTransformMatrix(startTransform);
+	m_motionStart = start;
+	m_motionEnd = end;
+	m_hasMotion = true;
+	addMotionBounds();
+}
+
+// function to return the transform at a given time
+RT::GTform RT::objinstance::getTransformAt(RT::real time) const {
+	if (!m_hasMotion) return m_transformMatrix;
+	RT::GTform transformMatrix;
+	transformMatrix.setTransform(m_motionStart, m_motionEnd, time);
+	return transformMatrix;
+}
+
+// function to grow the world bounds to cover the whole motion
+void RT::objinstance::addMotionBounds() {
+	RT::aabb localBounds = getLocalBounds();
+	RT::GTform endTransform;
+	endTransform.setTransform(m_motionEnd.m_translation, m_motionEnd.m_rotation, m_motionEnd.m_scale);
+	m_worldBounds.grow(localBounds.transformed(endTransform.getForward()));
+	// without a rotation every point moves in a straight line between its two ends, so the boxes at the two ends bound the whole motion
+	bool rotates = false;
+	for (int i = 0; i < 3; i++) rotates = rotates || (m_motionStart.m_rotation[i] != m_motionEnd.m_rotation[i]);
+	if (!rotates || localBounds.isEmpty() || localBounds.isInfinite()) return;
+	// otherwise points move along curves, but each stays within its distance from the local origin (times the largest scale) of the translation
+	real radius = 0.0;
+	for (int corner = 0; corner < 8; corner++) {
+		Vec3 point{ (corner & 1) ? localBounds.m_max[0] : localBounds.m_min[0], (corner & 2) ? localBounds.m_max[1] : localBounds.m_min[1], (corner & 4) ? localBounds.m_max[2] : localBounds.m_min[2] };
+		radius = std::max(radius, point.norm());
+	}
+	real maxScale = 0.0;
+	for (int i = 0; i < 3; i++) maxScale = std::max(maxScale, std::max(std::fabs(m_motionStart.m_scale[i]), std::fabs(m_motionEnd.m_scale[i])));
+	radius *= maxScale;
+	Vec3 pad{ radius, radius, radius };
+	m_worldBounds.grow(RT::aabb(m_motionStart.m_translation - pad, m_motionStart.m_translation + pad));
+	m_worldBounds.grow(RT::aabb(m_motionEnd.m_translation - pad, m_motionEnd.m_translation + pad));
+}
+
+// function to return the shared object
+const std::shared_ptr<RT::objectbase>& RT::objinstance::getPrototype() const {
+	return m_pPrototype;
+}
+
+// function to test for intersections
+bool RT::objinstance::testIntersections(const RT::ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	RT::hitrecord hit;
+	if (!intersect(castRay, std::numeric_limits<RT::real>::infinity(), hit)) return false;
+	computeHitData(castRay, hit, intPoint, localNormal, localColor);
+	return true;
+}
+
+// function to find the closest hit before tMax
+// the transform is affine, so t means the same for the shared object as for the instance, and its hit record is passed on as it is
+bool RT::objinstance::intersect(const RT::ray& castRay, RT::real tMax, RT::hitrecord& hit) {
+	if (m_hasMotion) return m_pPrototype->intersect(getTransformAt(castRay.m_time).apply(castRay, RT::BCKTFM), tMax, hit);
+	return m_pPrototype->intersect(m_transformMatrix.apply(castRay, RT::BCKTFM), tMax, hit);
+}
+
+// function to compute the shading data of a hit
+void RT::objinstance::computeHitData(const RT::ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	// transform the ray into the instance's coordinates (where the instance is at the time of the ray)
+	RT::GTform transformMatrix = getTransformAt(castRay.m_time);
+	RT::ray localRay = transformMatrix.apply(castRay, RT::BCKTFM);
+	Vec3 localIntPoint;
+	Vec3 normal;
+	m_pPrototype->computeHitData(localRay, hit, localIntPoint, normal, localColor);
+	intPoint = transformMatrix.apply(localIntPoint, RT::FWDTFM);
+	// normals are carried back by the transpose of the backward transform
+	localNormal = transformMatrix.getBackward().transformTransposed(normal);
+	localNormal.normalize();
+	// the color is the instance's own
+	localColor = m_baseColor;
+}
+
+// function to test for an intersection closer than tMax
+bool RT::objinstance::occluded(const RT::ray& castRay, RT::real tMax) {
+	if (m_hasMotion) return m_pPrototype->occluded(getTransformAt(castRay.m_time).apply(castRay, RT::BCKTFM), tMax);
+	return m_pPrototype->occluded(m_transformMatrix.apply(castRay, RT::BCKTFM), tMax);
+}
+
+// function to test a packet of rays
+int RT::objinstance::intersectPacket(const RT::raypacket& rays, double* tHit) {
+	RT::raypacket localRays;
+	RT::transformPacket(m_transformMatrix.getBackward(), rays, localRays);
+	return m_pPrototype->intersectPacket(localRays, tHit);
+}
@@ -0,0 +1,49 @@
+#ifndef OBJINSTANCE_H
+#define OBJINSTANCE_H
+#include <memory>
+#include "objectbase.hpp"
+#include "gtfm.hpp"
+
+namespace RT {
+	// a copy of a shared object (typically an objmesh or objgroup) placed by a transform of its own, with its own color and material
+	// only the transform and the pointer are stored per instance, so thousands of copies cost little more than one
+	// rays are carried into the instance's coordinates once, then traced through the shared object (and its own hierarchy) as they are
+	// an instance can also move, from its transform at time 0 to an end transform at time 1, and each ray then sees it where it is at the ray's time
+	// (the translation, rotation and scale are interpolated separately, see GTform::setTransform)
+	// (packets of rays carry no time, so they see it at time 0)
+	class objinstance : public objectbase {
+		public:
+			// constructor
+			objinstance(const std::shared_ptr<RT::objectbase>& prototype);
+			// override the destructor
+			virtual ~objinstance() override;
+			// override the function to test for intersections
+			virtual bool testIntersections(const RT::ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) override;
+			// override the functions to find the closest hit and compute its shading data
+			virtual bool intersect(const RT::ray& castRay, real tMax, RT::hitrecord& hit) override;
+			virtual void computeHitData(const RT::ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) override;
+			// override the function to test for an intersection closer than tMax
+			virtual bool occluded(const RT::ray& castRay, real tMax) override;
+			// override the function to test a packet of rays
+			virtual int intersectPacket(const RT::raypacket& rays, double* tHit) override;
+			// override the function to return the local bounds (the bounds of the shared object, after its own transform)
+			virtual RT::aabb getLocalBounds() const override;
+			// override the function to set the transform matrix (an instance that was moving stops)
+			virtual void setTransformMatrix(const RT::GTform& transformMatrix) override;
+			// function to make the instance move, from start at time 0 to end at time 1 (the scale mustn't change sign on the way)
+			void setMotion(const RT::gtfmparts& start, const RT::gtfmparts& end);
+			// function to return the transform at a given time
+			RT::GTform getTransformAt(real time) const;
+			// function to return the shared object
+			const std::shared_ptr<RT::objectbase>& getPrototype() const;
+		private:
+			// function to grow the world bounds to cover the whole motion
+			void addMotionBounds();
+			std::shared_ptr<RT::objectbase> m_pPrototype;
+			RT::gtfmparts m_motionStart;
+			RT::gtfmparts m_motionEnd;
+			bool m_hasMotion = false;
+	};
+}
+
+#endif
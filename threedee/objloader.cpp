@@ -0,0 +1,135 @@
+#include "objloader.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "linereader.hpp"
+
+// a corner of a face, the indices of its position and normal (-1 for none)
+struct objCorner {
+	int m_position;
+	int m_normal;
+};
+
+// function to throw an error for a line of the file
+[[noreturn]] static void objFail(const std::string& fileName, long long lineNumber, const std::string& message) {
+	throw std::runtime_error(fileName + ":" + std::to_string(lineNumber) + ": " + message);
+}
+
+// function to read a number from the line, advancing past it
+static bool readNumber(char*& pChar, RT::real& value) {
+	char* end = nullptr;
+	value = static_cast<RT::real>(std::strtod(pChar, &end));
+	if (end == pChar) return false;
+	pChar = end;
+	return true;
+}
+
+// function to convert an OBJ index (1 based, or negative to count back from the last element) into a 0 based index
+static bool resolveIndex(long index, int count, int& resolved) {
+	if (index > 0) resolved = static_cast<int>(index - 1);
+	else if (index < 0) resolved = static_cast<int>(count + index);
+	else return false;
+	return (resolved >= 0) && (resolved < count);
+}
+
+// function to read a Wavefront OBJ file
+std::shared_ptr<RT::meshdata> RT::loadOBJ(const std::string& fileName) {
+	RT::linereader reader;
+	if (!reader.open(fileName)) throw std::runtime_error("cannot open OBJ file " + fileName);
+	std::vector<Vec3> positions;
+	std::vector<Vec3> normals;
+	// the corners of every triangle, three each
+	std::vector<objCorner> corners;
+	std::vector<objCorner> face;
+	bool anyNormals = false;
+	while (char* line = reader.nextLine()) {
+		while ((*line == ' ') || (*line == '\t')) line++;
+		if ((line[0] == 'v') && ((line[1] == ' ') || (line[1] == '\t'))) {
+			// vertex position (an optional w is ignored)
+			char* pChar = line + 2;
+			Vec3 position;
+			for (int i = 0; i < 3; i++) {
+				if (!readNumber(pChar, position[i])) objFail(fileName, reader.getLineNumber(), "expected three numbers for a vertex");
+			}
+			positions.push_back(position);
+		}
+		else if ((line[0] == 'v') && (line[1] == 'n') && ((line[2] == ' ') || (line[2] == '\t'))) {
+			// vertex normal
+			char* pChar = line + 3;
+			Vec3 normal;
+			for (int i = 0; i < 3; i++) {
+				if (!readNumber(pChar, normal[i])) objFail(fileName, reader.getLineNumber(), "expected three numbers for a normal");
+			}
+			normals.push_back(normal);
+		}
+		else if ((line[0] == 'f') && ((line[1] == ' ') || (line[1] == '\t'))) {
+			// face, each corner is v, v/vt, v//vn or v/vt/vn
+			face.clear();
+			char* pChar = line + 2;
+			while (true) {
+				while ((*pChar == ' ') || (*pChar == '\t') || (*pChar == '\r')) pChar++;
+				if (*pChar == '\0') break;
+				objCorner corner{ -1, -1 };
+				char* end = nullptr;
+				long index = std::strtol(pChar, &end, 10);
+				if ((end == pChar) || (!resolveIndex(index, static_cast<int>(positions.size()), corner.m_position))) objFail(fileName, reader.getLineNumber(), "invalid vertex index in face");
+				pChar = end;
+				if (*pChar == '/') {
+					pChar++;
+					// skip the texture coordinate
+					if (*pChar != '/') std::strtol(pChar, &pChar, 10);
+					if (*pChar == '/') {
+						pChar++;
+						index = std::strtol(pChar, &end, 10);
+						if ((end == pChar) || (!resolveIndex(index, static_cast<int>(normals.size()), corner.m_normal))) objFail(fileName, reader.getLineNumber(), "invalid normal index in face");
+						pChar = end;
+						anyNormals = true;
+					}
+				}
+				if ((*pChar != ' ') && (*pChar != '\t') && (*pChar != '\r') && (*pChar != '\0')) objFail(fileName, reader.getLineNumber(), "unexpected character in face");
+				face.push_back(corner);
+			}
+			if (face.size() < 3) objFail(fileName, reader.getLineNumber(), "a face needs at least three vertices");
+			// split the polygon into a fan of triangles
+			for (size_t i = 1; i + 1 < face.size(); i++) {
+				corners.push_back(face[0]);
+				corners.push_back(face[i]);
+				corners.push_back(face[i + 1]);
+			}
+		}
+		// anything else (comments, texture coordinates, groups, materials...) is skipped
+	}
+	int numTriangles = static_cast<int>(corners.size() / 3);
+	if (numTriangles == 0) throw std::runtime_error("OBJ file " + fileName + " has no faces");
+	auto meshData = std::make_shared<RT::meshdata>();
+	std::vector<int> indices(corners.size());
+	if (!anyNormals) {
+		// the OBJ vertices are the mesh vertices
+		meshData->reserve(static_cast<int>(positions.size()), numTriangles);
+		for (const Vec3& position : positions) meshData->addVertex(position);
+		for (size_t i = 0; i < corners.size(); i++) indices[i] = corners[i].m_position;
+	}
+	else {
+		// the mesh keeps one normal per vertex, so every distinct pair of position and normal becomes a vertex
+		std::unordered_map<uint64_t, int> vertexMap;
+		vertexMap.reserve(positions.size());
+		meshData->reserve(static_cast<int>(positions.size()), numTriangles);
+		for (size_t i = 0; i < corners.size(); i++) {
+			uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(corners[i].m_position)) << 32) | static_cast<uint32_t>(corners[i].m_normal);
+			auto found = vertexMap.find(key);
+			if (found == vertexMap.end()) {
+				int vertex;
+				if (corners[i].m_normal >= 0) vertex = meshData->addVertex(positions[corners[i].m_position], normals[corners[i].m_normal]);
+				else vertex = meshData->addVertex(positions[corners[i].m_position]);
+				found = vertexMap.emplace(key, vertex).first;
+			}
+			indices[i] = found->second;
+		}
+	}
+	for (int i = 0; i < numTriangles; i++) meshData->addTriangle(indices[3 * i], indices[(3 * i) + 1], indices[(3 * i) + 2]);
+	meshData->build();
+	return meshData;
+}
@@ -0,0 +1,14 @@
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+#include <memory>
+#include <string>
+#include "meshdata.hpp"
+
+namespace RT {
+	// function to read a Wavefront OBJ file into mesh data (already built), throws std::runtime_error giving the file name and line on failure
+	// only the geometry is read: v, vn and f statements, with polygons split into fans of triangles
+	// texture coordinates, groups, smoothing groups and materials are ignored
+	std::shared_ptr<RT::meshdata> loadOBJ(const std::string& fileName);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "objmesh.hpp"
+#include <limits>
+
+// constructor
+RT::objmesh::objmesh(const std::shared_ptr<const RT::meshdata>& meshData) {
+	m_pMeshData = meshData;
+	updateBounds();
+}
+
+// destructor
+RT::objmesh::~objmesh() {
+
+}
+
+// function to return the local bounds (those of the mesh hierarchy)
+RT::aabb RT::objmesh::getLocalBounds() const {
+	return m_pMeshData->getBounds();
+}
+
+// function to return the mesh data
+const std::shared_ptr<const RT::meshdata>& RT::objmesh::getMeshData() const {
+	return m_pMeshData;
+}
+
+// function to test for intersections
+bool RT::objmesh::testIntersections(const RT::ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	RT::hitrecord hit;
+	if (!intersect(castRay, std::numeric_limits<RT::real>::infinity(), hit)) return false;
+	computeHitData(castRay, hit, intPoint, localNormal, localColor);
+	return true;
+}
+
+// function to find the closest hit before tMax
+bool RT::objmesh::intersect(const RT::ray& castRay, RT::real tMax, RT::hitrecord& hit) {
+	// transform the ray into local coordinates, without normalizing the direction so that t means the same in both
+	Vec3 origin = m_transformMatrix.apply(castRay.m_point1, RT::BCKTFM);
+	Vec3 dir = m_transformMatrix.applyDirection(castRay.m_lab, RT::BCKTFM);
+	RT::meshhit triangleHit;
+	if (!m_pMeshData->intersect(origin, dir, tMax, triangleHit)) return false;
+	hit.m_t = triangleHit.m_t;
+	hit.m_primitive = triangleHit.m_triangle;
+	hit.m_u = triangleHit.m_u;
+	hit.m_v = triangleHit.m_v;
+	return true;
+}
+
+// function to compute the shading data of a hit
+void RT::objmesh::computeHitData(const RT::ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	// the intersection point in world coordinates
+	intPoint = castRay.m_point1 + (hit.m_t * castRay.m_lab);
+	// normals are carried to world coordinates by the transpose of the backward transform
+	RT::meshhit triangleHit{ hit.m_t, hit.m_primitive, hit.m_u, hit.m_v };
+	localNormal = m_transformMatrix.getBackward().transformTransposed(m_pMeshData->getNormal(triangleHit));
+	localNormal.normalize();
+	// return the base color
+	localColor = m_baseColor;
+}
+
+// function to test for an intersection closer than tMax
+bool RT::objmesh::occluded(const RT::ray& castRay, RT::real tMax) {
+	Vec3 origin = m_transformMatrix.apply(castRay.m_point1, RT::BCKTFM);
+	Vec3 dir = m_transformMatrix.applyDirection(castRay.m_lab, RT::BCKTFM);
+	return m_pMeshData->occluded(origin, dir, tMax);
+}
+
+// function to test a packet of rays
+// the lanes of a packet soon go different ways through a mesh hierarchy, so each one is traced on its own (no shading data is computed)
+int RT::objmesh::intersectPacket(const RT::raypacket& rays, double* tHit) {
+	int hitMask = 0;
+	for (int i = 0; i < rays.m_numRays; i++) {
+		Vec3 origin = m_transformMatrix.apply(rays.getOrigin(i), RT::BCKTFM);
+		Vec3 dir = m_transformMatrix.applyDirection(rays.getDirection(i), RT::BCKTFM);
+		RT::meshhit hit;
+		if (m_pMeshData->intersect(origin, dir, tHit[i], hit)) {
+			tHit[i] = hit.m_t;
+			hitMask |= 1 << i;
+		}
+	}
+	return hitMask;
+}
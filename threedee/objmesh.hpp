@@ -0,0 +1,36 @@
+#ifndef OBJMESH_H
+#define OBJMESH_H
+#include <memory>
+#include "objectbase.hpp"
+#include "gtfm.hpp"
+#include "meshdata.hpp"
+
+namespace RT {
+	// a triangle mesh, placed in the scene by its transform
+	// the geometry (and its hierarchy) is held in a meshdata that any number of objmesh objects can share
+	// a mesh can shadow and reflect itself, rays leaving its surface start a little way off it instead of skipping it (see objectbase::getRayOrigin)
+	class objmesh : public objectbase {
+		public:
+			// constructor, the mesh data must already be built
+			objmesh(const std::shared_ptr<const RT::meshdata>& meshData);
+			// override the destructor
+			virtual ~objmesh() override;
+			// override the function to test for intersections
+			virtual bool testIntersections(const RT::ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) override;
+			// override the functions to find the closest hit and compute its shading data
+			virtual bool intersect(const RT::ray& castRay, real tMax, RT::hitrecord& hit) override;
+			virtual void computeHitData(const RT::ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) override;
+			// override the function to test for an intersection closer than tMax
+			virtual bool occluded(const RT::ray& castRay, real tMax) override;
+			// override the function to test a packet of rays (each lane traverses the mesh hierarchy on its own)
+			virtual int intersectPacket(const RT::raypacket& rays, double* tHit) override;
+			// override the function to return the local bounds
+			virtual RT::aabb getLocalBounds() const override;
+			// function to return the mesh data
+			const std::shared_ptr<const RT::meshdata>& getMeshData() const;
+		private:
+			std::shared_ptr<const RT::meshdata> m_pMeshData;
+	};
+}
+
+#endif
@@ -1,9 +1,11 @@
 #include "objplane.hpp"
 #include <cmath>
+#include <limits>
+#include "renderstats.hpp"
 
 // default constructor
 RT::objplane::objplane() {
-
+	updateBounds();
 }
 
 // destructor
@@ -11,49 +13,88 @@ RT::objplane::~objplane() {
 
 }
 
-// the function to test for intersections
-bool RT::objplane::testIntersections(const RT::ray& castRay, vector<double>& intPoint, vector<double>& localNormal, vector<double>& localColor) {
-	// copy the ray and apply the backwards transform
-	RT::ray bckRay = m_transformMatrix.apply(castRay, RT::BCKTFM);
-	// copy the m_lab vector from bckRay and normalize it
-	vector<double> k = bckRay.m_lab;
-	k.normalize();
-	// check if there is an intersection
-	// i.e. if the castRay is not parallel to the plane
-	if (!closeEnough(k.getElement(2), 0.0)) {
-		// there is an intersection
-		double t = bckRay.m_point1.getElement(2) / -k.getElement(2);
-		// if t is negative, then the intersection point must be behind the camera and we can ignore it
-		if (t > 0.0) {
-			// compute the values for u and v
-			double u = bckRay.m_point1.getElement(0) + (k.getElement(0) * t);
-			double v = bckRay.m_point1.getElement(1) + (k.getElement(1) * t);
-			// if the magnitude of both u and v is less than or equal to one then we must be in the plane
-			if ((abs(u) < 1.0) && (abs(v) < 1.0)) {
-				// compute the point of intersection
-				vector<double> poi = bckRay.m_point1 + t * k;
-				// transform the intersection point back into world coordinates
-				intPoint = m_transformMatrix.apply(poi, RT::FWDTFM);
-				// compute the local normal
-				vector<double> localOrigin{ std::vector<double> {0.0, 0.0, 0.0} };
-				vector<double> normalVector{ std::vector<double> {0.0, 0.0, -1.0} };
-				vector<double> globalOrigin = m_transformMatrix.apply(localOrigin, RT::FWDTFM);
-				localNormal = m_transformMatrix.apply(normalVector, RT::FWDTFM) - globalOrigin;
-				localNormal.normalize();
-				// return the base color
-				localColor = m_baseColor;
-				return true;
-			}
-			else {
-				return false;
-			}
-		}
-		else {
-			return false;
-		}
-	}
-	else {
-		return false;
-	}
+// function to return the concrete type
+RT::primitivetype RT::objplane::getPrimitiveType() const {
+	return RT::PRIMITIVE_PLANE;
+}
+
+// function to test whether a ray leaving the surface can hit the object again (it can't, as the plane is convex)
+bool RT::objplane::canHitItself() const {
 	return false;
 }
+
+// function to return the local bounds (the plane spans -1 to 1 in u and v, at z = 0)
+RT::aabb RT::objplane::getLocalBounds() const {
+	return RT::aabb(Vec3{ -1.0, -1.0, 0.0 }, Vec3{ 1.0, 1.0, 0.0 });
+}
+
+// function to find the closest hit before tMax (no intersection point, normal or color is computed)
+bool RT::objplane::intersect(const RT::ray& castRay, RT::real tMax, RT::hitrecord& hit) {
+	RT_STAT_COUNT(STAT_PLANE_TESTS);
+	// transform the origin and direction of the ray into local coordinates
+	// the direction is not normalized, so t means the same thing in local and world coordinates
+	Vec3 origin = m_transformMatrix.apply(castRay.m_point1, RT::BCKTFM);
+	Vec3 dir = m_transformMatrix.applyDirection(castRay.m_lab, RT::BCKTFM);
+	// a ray parallel to the plane never hits it
+	if (closeEnough(dir.getElement(2), 0.0)) return false;
+	RT::real t = origin.getElement(2) / -dir.getElement(2);
+	// the intersection must be in front of the origin and before tMax
+	if ((t <= 0.0) || (t >= tMax)) return false;
+	// and within the bounds of the plane
+	RT::real u = origin.getElement(0) + (dir.getElement(0) * t);
+	RT::real v = origin.getElement(1) + (dir.getElement(1) * t);
+	if ((fabs(u) >= 1.0) || (fabs(v) >= 1.0)) return false;
+	hit.m_t = t;
+	hit.m_primitive = -1;
+	return true;
+}
+
+// function to test for an intersection closer than tMax
+bool RT::objplane::occluded(const RT::ray& castRay, RT::real tMax) {
+	RT::hitrecord hit;
+	return intersect(castRay, tMax, hit);
+}
+
+// function to test a packet of rays, four lanes at a time
+int RT::objplane::intersectPacket(const RT::raypacket& rays, double* tHit) {
+	RT_STAT_ADD(STAT_PLANE_TESTS, rays.m_numRays);
+	// the transform is affine, so t means the same thing in local and world coordinates as long as the direction isn't normalized
+	Affine4 bckTfm = m_transformMatrix.getBackward();
+	int hitMask = 0;
+	for (int first = 0; first < RT::PACKET_SIZE; first += RT::simd4d::WIDTH) {
+		RT::simdvec3 origin = RT::transformPoint(bckTfm, RT::loadOrigins(rays, first));
+		RT::simdvec3 dir = RT::transformDirection(bckTfm, RT::loadDirections(rays, first));
+		// rays parallel to the plane give an infinite or NaN t, which fails the comparisons below
+		RT::simd4d t = (RT::simd4d(0.0) - origin.m_z) / dir.m_z;
+		RT::simd4d u = origin.m_x + (dir.m_x * t);
+		RT::simd4d v = origin.m_y + (dir.m_y * t);
+		RT::simd4d tBest = RT::simd4d::load(tHit + first);
+		RT::simd4d hit = (t > RT::simd4d(0.0)) & (t < tBest) & (RT::simd4d::abs(u) < RT::simd4d(1.0)) & (RT::simd4d::abs(v) < RT::simd4d(1.0));
+		RT::simd4d::select(hit, t, tBest).store(tHit + first);
+		hitMask |= hit.movemask() << first;
+	}
+	// ignore the padding lanes
+	return hitMask & ((1 << rays.m_numRays) - 1);
+}
+
+// the function to test for intersections
+bool RT::objplane::testIntersections(const RT::ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	RT::hitrecord hit;
+	if (!intersect(castRay, std::numeric_limits<RT::real>::infinity(), hit)) return false;
+	computeHitData(castRay, hit, intPoint, localNormal, localColor);
+	return true;
+}
+
+// function to compute the shading data of a hit
+void RT::objplane::computeHitData(const RT::ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	// the transform is affine, so the point at t along the world ray is the point of intersection
+	intPoint = castRay.m_point1 + (hit.m_t * castRay.m_lab);
+	// compute the local normal
+	Vec3 localOrigin{ 0.0, 0.0, 0.0 };
+	Vec3 normalVector{ 0.0, 0.0, -1.0 };
+	Vec3 globalOrigin = m_transformMatrix.apply(localOrigin, RT::FWDTFM);
+	localNormal = m_transformMatrix.apply(normalVector, RT::FWDTFM) - globalOrigin;
+	localNormal.normalize();
+	// return the base color
+	localColor = m_baseColor;
+}
@@ -4,14 +4,28 @@
 #include "gtfm.hpp"
 
 namespace RT {
-	class objplane : public objectbase {
+	// final, so the bounding volume hierarchy can call it directly (see getPrimitiveType)
+	class objplane final : public objectbase {
 		public:
 			// default constructor
 			objplane();
 			// override the destructor
 			virtual ~objplane() override;
 			// override the function to test for intersections
-			virtual bool testIntersections(const RT::ray& castRay, vector<double>& intPoint, vector<double>& localNormal, vector<double>& localColor) override;
+			virtual bool testIntersections(const RT::ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) override;
+			// override the functions to find the closest hit and compute its shading data
+			virtual bool intersect(const RT::ray& castRay, real tMax, RT::hitrecord& hit) override;
+			virtual void computeHitData(const RT::ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) override;
+			// override the function to test for an intersection closer than tMax
+			virtual bool occluded(const RT::ray& castRay, real tMax) override;
+			// override the function to test a packet of rays
+			virtual int intersectPacket(const RT::raypacket& rays, double* tHit) override;
+			// override the function to return the local bounds
+			virtual RT::aabb getLocalBounds() const override;
+			// override the function to return the concrete type
+			virtual RT::primitivetype getPrimitiveType() const override;
+			// override the function to test whether a ray leaving the surface can hit the object again
+			virtual bool canHitItself() const override;
 	};
 }
 
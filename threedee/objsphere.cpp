@@ -1,9 +1,15 @@
 #include "objsphere.hpp"
 #include <cmath>
+#include <limits>
+#include "renderstats.hpp"
+
+// the relative tolerance on the lengths and angles of the transformed axes for a transform to count as a similarity
+constexpr RT::real SPHERE_SIMILARITY_TOLERANCE = RT::precisionTolerance(1e-6, 1e-12);
 
 // the default constructor
 RT::objsphere::objsphere() {
-
+	updateShape();
+	updateBounds();
 }
 
 // the destructor
@@ -11,46 +17,134 @@ RT::objsphere::~objsphere() {
 
 }
 
-// function to test for intersections (takes a ray and does the math on the ray directly)
-bool RT::objsphere::testIntersections(const RT::ray& castRay, vector<double>& intPoint, vector<double>& localNormal, vector<double>& localColor) {
-	// copy the ray and apply the backwards transform
-	// note: castRay is in world coordinates and we want to put that in local coordinates before doing the math
-	RT::ray bckRay = m_transformMatrix.apply(castRay, RT::BCKTFM); // important to apply backwards transform, we are transforming from the world coordinates to the local coordinates of the object
-	// compute the values of a, b, and c (to solve quadratic equation)
-	// first get the direction vector for the ray
-	vector<double> vhat = bckRay.m_lab;
-	vhat.normalize();
-	// note that a is equal to the squared magnitude of the direction of the cast ray
-	// as this will be a unit vector, we can conclude that the value of a will always be 1
-	// a already equals 1.0
-	// calculate b
-	double b = 2.0 * vector<double>::dot(bckRay.m_point1, vhat);
-	// calculate c
-	double c = vector<double>::dot(bckRay.m_point1, bckRay.m_point1) - 1.0;
+// function to return the concrete type
+RT::primitivetype RT::objsphere::getPrimitiveType() const {
+	return RT::PRIMITIVE_SPHERE;
+}
+
+// function to test whether a ray leaving the surface can hit the object again (it can't, as the sphere is convex)
+bool RT::objsphere::canHitItself() const {
+	return false;
+}
+
+// function to set the transform matrix
+void RT::objsphere::setTransformMatrix(const RT::GTform& transformMatrix) {
+	objectbase::setTransformMatrix(transformMatrix);
+	updateShape();
+}
+
+// function to work out the center and radius
+// the transform is a similarity if the three axes it maps the unit axes to are at right angles and of the same length
+void RT::objsphere::updateShape() {
+	Affine4 fwdTfm = m_transformMatrix.getForward();
+	Vec3 axes[3];
+	for (int col = 0; col < 3; col++) axes[col] = Vec3{ fwdTfm.getElement(0, col), fwdTfm.getElement(1, col), fwdTfm.getElement(2, col) };
+	m_center = Vec3{ fwdTfm.getElement(0, 3), fwdTfm.getElement(1, 3), fwdTfm.getElement(2, 3) };
+	m_radiusSquared = Vec3::dot(axes[0], axes[0]);
+	RT::real tolerance = SPHERE_SIMILARITY_TOLERANCE * m_radiusSquared;
+	m_isSimilarity = (m_radiusSquared > 0.0)
+		&& (fabs(Vec3::dot(axes[1], axes[1]) - m_radiusSquared) <= tolerance) && (fabs(Vec3::dot(axes[2], axes[2]) - m_radiusSquared) <= tolerance)
+		&& (fabs(Vec3::dot(axes[0], axes[1])) <= tolerance) && (fabs(Vec3::dot(axes[1], axes[2])) <= tolerance) && (fabs(Vec3::dot(axes[2], axes[0])) <= tolerance);
+}
+
+// function to return the local bounds (a unit sphere at the origin)
+RT::aabb RT::objsphere::getLocalBounds() const {
+	return RT::aabb(Vec3{ -1.0, -1.0, -1.0 }, Vec3{ 1.0, 1.0, 1.0 });
+}
+
+// function to find the closest hit before tMax (no intersection point, normal or color is computed)
+bool RT::objsphere::intersect(const RT::ray& castRay, RT::real tMax, RT::hitrecord& hit) {
+	RT_STAT_COUNT(STAT_SPHERE_TESTS);
+	// the origin and direction of the ray relative to the sphere, and the square of its radius
+	Vec3 origin;
+	Vec3 dir;
+	RT::real radiusSquared;
+	if (m_isSimilarity) {
+		// the sphere is round in world coordinates, so the ray is tested as it is
+		origin = castRay.m_point1 - m_center;
+		dir = castRay.m_lab;
+		radiusSquared = m_radiusSquared;
+	}
+	else {
+		// transform the origin and direction of the ray into local coordinates, where the sphere is the unit sphere
+		// the direction is not normalized, as the transform is affine the parameter t then means the same thing in both coordinate systems
+		origin = m_transformMatrix.apply(castRay.m_point1, RT::BCKTFM);
+		dir = m_transformMatrix.applyDirection(castRay.m_lab, RT::BCKTFM);
+		radiusSquared = 1.0;
+	}
+	// compute the values of a, b, and c
+	RT::real a = Vec3::dot(dir, dir);
+	RT::real b = 2.0 * Vec3::dot(origin, dir);
+	RT::real c = Vec3::dot(origin, origin) - radiusSquared;
 	// test whether we actually have an intersection
-	double intTest = (b * b) - 4.0 * c;
-	vector<double> poi; // point of intersection, tells us the point in the local coordinate system
-	if (intTest > 0.0) { // you have an intersection
-		double numsqrt = sqrtf(intTest);
-		double t1 = (-b + numsqrt) / 2.0; // a = 1, no need to multiply it to 2
-		double t2 = (-b - numsqrt) / 2.0;
-		// if either t1 or t2 are negative, then at least part of the object is behind the camera and so we will ignore it
-		if ((t1 < 0.0) || (t2 < 0.0)) return false;
+	RT::real intTest = (b * b) - 4.0 * a * c;
+	if (intTest <= 0.0) return false;
+	RT::real numsqrt = std::sqrt(intTest);
+	RT::real t1 = (-b - numsqrt) / (2.0 * a); // the nearer of the two points of intersection
+	// if any part of the sphere is behind the origin of the ray (so t1 is negative) we ignore it
+	if ((t1 < 0.0) || (t1 >= tMax)) return false;
+	hit.m_t = t1;
+	hit.m_primitive = -1;
+	return true;
+}
+
+// function to test for an intersection closer than tMax
+bool RT::objsphere::occluded(const RT::ray& castRay, RT::real tMax) {
+	RT::hitrecord hit;
+	return intersect(castRay, tMax, hit);
+}
+
+// function to test a packet of rays, four lanes at a time
+int RT::objsphere::intersectPacket(const RT::raypacket& rays, double* tHit) {
+	RT_STAT_ADD(STAT_SPHERE_TESTS, rays.m_numRays);
+	// the transform is affine, so t means the same thing in local and world coordinates as long as the direction isn't normalized
+	Affine4 bckTfm = m_transformMatrix.getBackward();
+	RT::simdvec3 center{ RT::simd4d(m_center[0]), RT::simd4d(m_center[1]), RT::simd4d(m_center[2]) };
+	RT::simd4d radiusSquared(m_isSimilarity ? m_radiusSquared : 1.0);
+	int hitMask = 0;
+	for (int first = 0; first < RT::PACKET_SIZE; first += RT::simd4d::WIDTH) {
+		// as in intersect, the rays are only carried into local coordinates if the sphere isn't round in world coordinates
+		RT::simdvec3 origin = RT::loadOrigins(rays, first);
+		RT::simdvec3 dir = RT::loadDirections(rays, first);
+		if (m_isSimilarity) {
+			origin = RT::simdvec3{ origin.m_x - center.m_x, origin.m_y - center.m_y, origin.m_z - center.m_z };
+		}
 		else {
-			// determine which point of intersection was closest to the camera
-			if (t1 < t2) poi = bckRay.m_point1 + (vhat * t1);
-			else poi = bckRay.m_point1 + (vhat * t2);
-			// transform the intersection point back into world coordinates
-			intPoint = m_transformMatrix.apply(poi, RT::FWDTFM);
-			// compute the local normal (easy for a sphere at the origin!)
-			vector<double> objOrigin = vector<double>{ std::vector<double>{0.0, 0.0, 0.0} };
-			vector<double> newObjOrigin = m_transformMatrix.apply(objOrigin, RT::FWDTFM);
-			localNormal = intPoint - newObjOrigin;
-			localNormal.normalize();
-			// return the base color
-			localColor = m_baseColor;
+			origin = RT::transformPoint(bckTfm, origin);
+			dir = RT::transformDirection(bckTfm, dir);
 		}
-		return true;
+		// solve the quadratic for the nearer point of intersection
+		RT::simd4d a = RT::dot(dir, dir);
+		RT::simd4d b = RT::simd4d(2.0) * RT::dot(origin, dir);
+		RT::simd4d c = RT::dot(origin, origin) - radiusSquared;
+		RT::simd4d intTest = (b * b) - (RT::simd4d(4.0) * a * c);
+		RT::simd4d numsqrt = RT::simd4d::sqrt(RT::simd4d::max(intTest, RT::simd4d(0.0)));
+		RT::simd4d t = (RT::simd4d(0.0) - b - numsqrt) / (RT::simd4d(2.0) * a);
+		// as in testIntersections, the sphere is ignored if any part of it is behind the origin of the ray
+		RT::simd4d tBest = RT::simd4d::load(tHit + first);
+		RT::simd4d hit = (intTest > RT::simd4d(0.0)) & (t >= RT::simd4d(0.0)) & (t < tBest);
+		RT::simd4d::select(hit, t, tBest).store(tHit + first);
+		hitMask |= hit.movemask() << first;
 	}
-	else return false;
-}
\ No newline at end of file
+	// ignore the padding lanes
+	return hitMask & ((1 << rays.m_numRays) - 1);
+}
+
+// function to test for intersections
+bool RT::objsphere::testIntersections(const RT::ray& castRay, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	RT::hitrecord hit;
+	if (!intersect(castRay, std::numeric_limits<RT::real>::infinity(), hit)) return false;
+	computeHitData(castRay, hit, intPoint, localNormal, localColor);
+	return true;
+}
+
+// function to compute the shading data of a hit
+void RT::objsphere::computeHitData(const RT::ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) {
+	// the transform is affine, so the point at t along the world ray is the point of intersection
+	intPoint = castRay.m_point1 + (hit.m_t * castRay.m_lab);
+	// compute the local normal (easy for a sphere, from its center)
+	localNormal = intPoint - m_center;
+	localNormal.normalize();
+	// return the base color
+	localColor = m_baseColor;
+}
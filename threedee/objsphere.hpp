@@ -4,7 +4,8 @@
 #include "gtfm.hpp"
 
 namespace RT {
-	class objsphere : public objectbase { // inherits from objectbase
+	// final, so the bounding volume hierarchy can call it directly (see getPrimitiveType)
+	class objsphere final : public objectbase { // inherits from objectbase
 		public: 
 			// default constructor, defines a unit sphere at the origin
 			objsphere();
@@ -13,7 +14,31 @@ namespace RT {
 			virtual ~objsphere() override;
 
 			// override the function to test for intersections
-			virtual bool testIntersections(const RT::ray& castRay, vector<double> &intPoint, vector<double>& localNormal, vector<double>& localColor);
+			virtual bool testIntersections(const RT::ray& castRay, Vec3 &intPoint, Vec3& localNormal, Vec3& localColor) override;
+			// override the functions to find the closest hit and compute its shading data
+			virtual bool intersect(const RT::ray& castRay, real tMax, RT::hitrecord& hit) override;
+			virtual void computeHitData(const RT::ray& castRay, const RT::hitrecord& hit, Vec3& intPoint, Vec3& localNormal, Vec3& localColor) override;
+			// override the function to test for an intersection closer than tMax
+			virtual bool occluded(const RT::ray& castRay, real tMax) override;
+			// override the function to test a packet of rays
+			virtual int intersectPacket(const RT::raypacket& rays, double* tHit) override;
+			// override the function to return the local bounds
+			virtual RT::aabb getLocalBounds() const override;
+			// override the function to return the concrete type
+			virtual RT::primitivetype getPrimitiveType() const override;
+			// override the function to test whether a ray leaving the surface can hit the object again
+			virtual bool canHitItself() const override;
+			// override the function to set the transform matrix, to check whether it keeps the sphere round
+			virtual void setTransformMatrix(const RT::GTform& transformMatrix) override;
+		private:
+			// function to work out the center and radius from the transform
+			void updateShape();
+			// the center of the sphere in world coordinates
+			Vec3 m_center;
+			// whether the transform is a similarity (rotation, uniform scale and translation), so the sphere is still a sphere in world coordinates
+			// rays are then tested against the center and radius directly, rather than being carried into local coordinates
+			bool m_isSimilarity;
+			real m_radiusSquared;
 	};
 }
 
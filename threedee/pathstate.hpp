@@ -0,0 +1,47 @@
+#ifndef PATHSTATE_H
+#define PATHSTATE_H
+#include <vector>
+#include "camera.hpp"
+
+namespace RT {
+	// per-thread scratch data, one instance is owned by each render thread for the duration of a render
+	// anything a thread needs to accumulate without synchronisation belongs here
+	struct threadcontext {
+		int m_threadIndex = 0;
+		// the pixels of the tile being rendered, reused from one tile to the next
+		std::vector<float> m_tileBuffer;
+		// the camera rays of the tile (or of a round of samples of one pixel), and where they sample the pixel, lens and shutter interval
+		RT::camerarays m_cameraRays;
+		RT::camerasamples m_cameraSamples;
+	};
+
+	// state carried along a single path as it is traced through the scene
+	// a copy is made for every bounce, so nothing here is shared between paths or threads
+	struct pathstate {
+		// number of reflection bounces taken to reach the current ray (0 for a camera ray)
+		int m_depth = 0;
+		// maximum number of reflection bounces allowed
+		int m_maxDepth = 3;
+		// fraction of the light arriving along this path that reaches the camera
+		double m_throughput = 1.0;
+		// paths whose throughput drops below this are not followed any further (0 disables the test)
+		double m_minThroughput = 0.0;
+		// scratch data for the thread tracing this path
+		threadcontext* m_pThread = nullptr;
+
+		// function to return the state of a path after a bounce that passes on a fraction weight of the light
+		pathstate bounce(double weight) const {
+			pathstate result = *this;
+			result.m_depth++;
+			result.m_throughput *= weight;
+			return result;
+		}
+
+		// function to test whether a path in this state should still be traced
+		bool isAlive() const {
+			return (m_depth <= m_maxDepth) && (m_throughput >= m_minThroughput);
+		}
+	};
+}
+
+#endif
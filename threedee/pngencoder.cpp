@@ -0,0 +1,98 @@
+#include "pngencoder.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// largest amount of data in a single uncompressed deflate block
+constexpr int DEFLATE_MAX_STORED = 65535;
+
+// lookup table for the CRC-32 used by PNG chunks
+struct crcTable {
+	crcTable() {
+		for (uint32_t n = 0; n < 256; n++) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++) c = (c & 1) ? (0xedb88320u ^ (c >> 1)) : (c >> 1);
+			m_values[n] = c;
+		}
+	}
+	uint32_t m_values[256];
+};
+
+// function to compute the CRC-32 of a block of data
+static uint32_t crc32(const unsigned char* data, size_t length) {
+	// built on first use (thread safe, as a function local static)
+	static const crcTable table;
+	uint32_t crc = 0xffffffffu;
+	for (size_t i = 0; i < length; i++) crc = table.m_values[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+// function to append a 32 bit big endian value
+static void appendUint32(std::vector<unsigned char>& output, uint32_t value) {
+	output.push_back(static_cast<unsigned char>(value >> 24));
+	output.push_back(static_cast<unsigned char>(value >> 16));
+	output.push_back(static_cast<unsigned char>(value >> 8));
+	output.push_back(static_cast<unsigned char>(value));
+}
+
+// function to append a chunk (length, type, data and the CRC of the type and data)
+static void appendChunk(std::vector<unsigned char>& output, const char* type, const std::vector<unsigned char>& data) {
+	appendUint32(output, static_cast<uint32_t>(data.size()));
+	size_t typeStart = output.size();
+	output.insert(output.end(), type, type + 4);
+	output.insert(output.end(), data.begin(), data.end());
+	appendUint32(output, crc32(&output[typeStart], output.size() - typeStart));
+}
+
+// function to encode an image as a PNG file
+void encodePNG(const int xSize, const int ySize, const std::vector<unsigned char>& rgbData, std::vector<unsigned char>& pngData) {
+	// signature
+	const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	pngData.assign(signature, signature + 8);
+	// header: dimensions, 8 bits per channel, color type 2 (RGB), default compression and filter, no interlacing
+	std::vector<unsigned char> header;
+	appendUint32(header, static_cast<uint32_t>(xSize));
+	appendUint32(header, static_cast<uint32_t>(ySize));
+	header.push_back(8);
+	header.push_back(2);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	appendChunk(pngData, "IHDR", header);
+	// the raw scanlines, each starts with filter type 0 (none)
+	size_t rowSize = static_cast<size_t>(xSize) * 3;
+	std::vector<unsigned char> scanlines;
+	scanlines.reserve((rowSize + 1) * ySize);
+	for (int y = 0; y < ySize; y++) {
+		scanlines.push_back(0);
+		scanlines.insert(scanlines.end(), rgbData.begin() + (y * rowSize), rgbData.begin() + ((y + 1) * rowSize));
+	}
+	// wrap the scanlines in a zlib stream made of stored deflate blocks
+	std::vector<unsigned char> zlibData;
+	zlibData.reserve(scanlines.size() + ((scanlines.size() / DEFLATE_MAX_STORED) + 1) * 5 + 6);
+	zlibData.push_back(0x78);
+	zlibData.push_back(0x01);
+	size_t position = 0;
+	do {
+		size_t blockSize = scanlines.size() - position;
+		if (blockSize > DEFLATE_MAX_STORED) blockSize = DEFLATE_MAX_STORED;
+		bool finalBlock = (position + blockSize == scanlines.size());
+		zlibData.push_back(finalBlock ? 1 : 0);
+		zlibData.push_back(static_cast<unsigned char>(blockSize & 0xff));
+		zlibData.push_back(static_cast<unsigned char>(blockSize >> 8));
+		zlibData.push_back(static_cast<unsigned char>(~blockSize & 0xff));
+		zlibData.push_back(static_cast<unsigned char>((~blockSize >> 8) & 0xff));
+		zlibData.insert(zlibData.end(), scanlines.begin() + position, scanlines.begin() + position + blockSize);
+		position += blockSize;
+	} while (position < scanlines.size());
+	// Adler-32 checksum of the uncompressed data
+	uint32_t a = 1;
+	uint32_t b = 0;
+	for (unsigned char value : scanlines) {
+		a = (a + value) % 65521;
+		b = (b + a) % 65521;
+	}
+	appendUint32(zlibData, (b << 16) | a);
+	appendChunk(pngData, "IDAT", zlibData);
+	// end of the file
+	appendChunk(pngData, "IEND", std::vector<unsigned char>());
+}
@@ -0,0 +1,9 @@
+#ifndef PNGENCODER_H
+#define PNGENCODER_H
+#include <vector>
+
+// function to encode 8 bit RGB data (rows from top to bottom) as a PNG file in memory
+// the image data is written as uncompressed deflate blocks, which keeps the encoder free of any dependency on zlib
+void encodePNG(const int xSize, const int ySize, const std::vector<unsigned char>& rgbData, std::vector<unsigned char>& pngData);
+
+#endif
@@ -1,8 +1,9 @@
 #include "pointlight.hpp"
+#include "renderstats.hpp"
 
 // default constructor
 RT::pointlight::pointlight() {
-	m_color = vector<double>{ std::vector<double>{1.0, 1.0, 1.0} };
+	m_color = Vec3{ 1.0, 1.0, 1.0 };
 	m_intensity = 1.0;
 }
 
@@ -12,51 +13,46 @@ RT::pointlight::~pointlight() {
 }
 
 // function to compute illumination
-bool RT::pointlight::computeIllumination(const vector<double> &intPoint, const vector<double> &localNormal, const std::vector<std::shared_ptr<RT::objectbase>> &objectList, const std::shared_ptr<RT::objectbase> &currentObject, vector<double> &color, double &intensity) {
-	// construct a vector pointing from the intersection point to the light
-	vector<double> lightDir = (m_location - intPoint).normalized();
-	// compute a starting point
-	vector<double> startPoint = intPoint;
-	// construct a ray from the point of intersection to the light
-	RT::ray lightRay(startPoint, startPoint + lightDir);
-	// check for intersections with all of the objects in the scene except for current one
-	vector<double> poi{ 3 };
-	vector<double> poiNormal{ 3 };
-	vector<double> poiColor{ 3 };
-	bool validInt = false;
-	for (auto sceneObject : objectList) {
-		if (sceneObject != currentObject) {
-			validInt = sceneObject->testIntersections(lightRay, poi, poiNormal, poiColor);
-		}
-		// if we have an intersection, then there is no point checking further so we can break out of the loop
-		// in other words, this object is blocking light from this light source
-		if (validInt) break;
+bool RT::pointlight::computeIllumination(const Vec3 &intPoint, const Vec3 &localNormal, const RT::bvh &objectBVH, const std::shared_ptr<RT::objectbase> &currentObject, RT::real time, Vec3 &color, RT::real &intensity) {
+	// find the illumination if nothing is in the way (there is none where the surface faces away from the light)
+	RT::ray lightRay;
+	if (!computeUnshadowedIllumination(intPoint, localNormal, lightRay, color, intensity)) return false;
+	// a ray leaving an object that it could hit again starts a little way off it
+	lightRay = RT::ray(currentObject->getRayOrigin(intPoint, localNormal, lightRay.m_lab), m_location);
+	lightRay.m_time = time;
+	// check for intersections with all of the objects in the scene (except for the current one, if the ray can't hit it)
+	// only objects between the point and the light (t < 1) can block it, and the search stops at the first one found
+	RT_STAT_COUNT(STAT_SHADOW_RAYS);
+	bool validInt;
+	{
+		RT_STAT_PHASE(PHASE_TRACE);
+		validInt = objectBVH.occluded(lightRay, 1.0, currentObject.get());
 	}
-	// only continue to compute illumination if the light ray didn't intersect with any objects in the scene
+	// only keep the illumination if the light ray didn't intersect with any objects in the scene
 	// i.e. no objects are casting a shadow from this light source
-	if (!validInt) {
-		// compute the angle between the local normal and the light ray
-		// note that we assume that localNormal is a unit vector
-		double angle = acos(vector<double>::dot(localNormal, lightDir));
-		// if the normal is pointing away from the light, then we have no illumination
-		if (angle > 1.5708) {
-			// no illumination
-			color = m_color;
-			intensity = 0.0;
-			return false;
-		}
-		else {
-			// we have illumination
-			color = m_color;
-			intensity = m_intensity * (1.0 - (angle / 1.5708));
-			return true;
-		}
-	}
-	else {
+	if (validInt) {
 		// shadow, so no illumination
-		color = m_color;
 		intensity = 0.0;
 		return false;
 	}
 	return true;
-}
\ No newline at end of file
+}
+
+// function to compute illumination if nothing blocks the light
+bool RT::pointlight::computeUnshadowedIllumination(const Vec3 &intPoint, const Vec3 &localNormal, RT::ray &lightRay, Vec3 &color, RT::real &intensity) {
+	// construct a vector pointing from the intersection point to the light
+	Vec3 lightDir = (m_location - intPoint).normalized();
+	// construct a ray from the point of intersection to the light
+	lightRay = RT::ray(intPoint, m_location);
+	color = m_color;
+	// compute the angle between the local normal and the light ray
+	// note that we assume that localNormal is a unit vector
+	RT::real angle = acos(Vec3::dot(localNormal, lightDir));
+	// if the normal is pointing away from the light, then we have no illumination
+	if (angle > 1.5708) {
+		intensity = 0.0;
+		return false;
+	}
+	intensity = m_intensity * (1.0 - (angle / 1.5708));
+	return true;
+}
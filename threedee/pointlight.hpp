@@ -9,7 +9,9 @@ namespace RT {
 		// override the default destructor
 		virtual ~pointlight() override;
 		// function to compute illumination
-		virtual bool computeIllumination(const vector<double> &intPoint, const vector<double> &localNormal, const std::vector<std::shared_ptr<RT::objectbase>> &objectList, const std::shared_ptr<RT::objectbase> &currentObject, vector<double> &color, double &intensity) override;
+		virtual bool computeIllumination(const Vec3 &intPoint, const Vec3 &localNormal, const RT::bvh &objectBVH, const std::shared_ptr<RT::objectbase> &currentObject, real time, Vec3 &color, real &intensity) override;
+		// function to compute illumination if nothing blocks the light
+		virtual bool computeUnshadowedIllumination(const Vec3 &intPoint, const Vec3 &localNormal, RT::ray &lightRay, Vec3 &color, real &intensity) override;
 	};
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef PRECISION_H
+#define PRECISION_H
+
+namespace RT {
+	// the scalar type of the geometry and shading (vectors, transforms, rays, objects, materials and lights)
+	// the renderer is built at double precision, define RT_USE_FLOAT to build the whole pipeline at single precision instead
+	// scene files, render settings and the image itself don't depend on it
+	// the packet kernels (simd4d in simd.hpp and raypacket) stay at four double lanes in both builds, converting from real as packets are filled
+#if defined(RT_USE_FLOAT)
+	typedef float real;
+#else
+	typedef double real;
+#endif
+
+	// function to pick a tolerance for the precision in use
+	constexpr real precisionTolerance(double floatValue, double doubleValue) {
+		return static_cast<real>((sizeof(real) == sizeof(float)) ? floatValue : doubleValue);
+	}
+
+	// function to return the name of the precision, for reports
+	inline const char* getPrecisionName() {
+		return (sizeof(real) == sizeof(float)) ? "float" : "double";
+	}
+}
+
+#endif
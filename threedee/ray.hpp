@@ -1,6 +1,6 @@
 #ifndef RAY_H
 #define RAY_H
-#include "vector.hpp"
+#include "vecn.hpp"
 
 namespace RT {
 	class ray {
@@ -8,16 +8,17 @@ namespace RT {
 			// default constructor
 			ray();
 			// constuctor, ray between two vectors point1 and point2
-			ray(const vector<double>& point1, const vector<double>& point2);
+			ray(const Vec3& point1, const Vec3& point2);
 			// returns first vector
-			vector<double> getPoint1() const;
+			Vec3 getPoint1() const;
 			// returns second vector
-			vector<double> getPoint2() const;
+			Vec3 getPoint2() const;
 			// variables
-			vector<double> m_point1{ 3 };
-			vector<double> m_point2{ 3 };
-			vector<double> m_lab{ 3 }; // vector from point a to point b
+			Vec3 m_point1;
+			Vec3 m_point2;
+			Vec3 m_lab; // vector from point a to point b
+			real m_time = 0.0; // time within the camera's shutter interval (moving objects are tested where they are at this time)
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,122 @@
+#ifndef RAYPACKET_H
+#define RAYPACKET_H
+#include "vecn.hpp"
+#include "ray.hpp"
+#include "affine4.hpp"
+#include "simd.hpp"
+
+namespace RT {
+	// number of rays traced together in a packet (a multiple of simd4d::WIDTH)
+	constexpr int PACKET_SIZE = 8;
+
+	// a bundle of rays stored as a structure of arrays, so each component of four rays loads straight into a simd register
+	// lane i is the ray origin + t * direction, with direction = m_lab of the original ray (not normalized, so t means the same as for RT::ray)
+	struct alignas(32) raypacket {
+		// function to fill the packet from up to PACKET_SIZE rays (unused lanes repeat the first ray)
+		void setRays(const RT::ray* rays, int numRays);
+		// functions to return the origin and direction of lane i (in the precision of Vec3, for the scalar fallbacks)
+		Vec3 getOrigin(int i) const;
+		Vec3 getDirection(int i) const;
+		// variables
+		double m_originX[PACKET_SIZE];
+		double m_originY[PACKET_SIZE];
+		double m_originZ[PACKET_SIZE];
+		double m_dirX[PACKET_SIZE];
+		double m_dirY[PACKET_SIZE];
+		double m_dirZ[PACKET_SIZE];
+		double m_invDirX[PACKET_SIZE];
+		double m_invDirY[PACKET_SIZE];
+		double m_invDirZ[PACKET_SIZE];
+		int m_numRays;
+	};
+
+	// the closest hit found for each lane of a packet
+	struct alignas(32) packethit {
+		// the ray parameter of the hit (or the search limit, for lanes that missed)
+		double m_t[PACKET_SIZE];
+		// the index of the object hit in the object list (-1 for lanes that missed)
+		int m_index[PACKET_SIZE];
+	};
+
+	// three simd4d holding one vector for each of four lanes
+	struct simdvec3 {
+		simd4d m_x;
+		simd4d m_y;
+		simd4d m_z;
+	};
+
+	inline void raypacket::setRays(const RT::ray* rays, int numRays) {
+		m_numRays = numRays;
+		for (int i = 0; i < PACKET_SIZE; i++) {
+			const RT::ray& laneRay = rays[(i < numRays) ? i : 0];
+			m_originX[i] = laneRay.m_point1[0];
+			m_originY[i] = laneRay.m_point1[1];
+			m_originZ[i] = laneRay.m_point1[2];
+			m_dirX[i] = laneRay.m_lab[0];
+			m_dirY[i] = laneRay.m_lab[1];
+			m_dirZ[i] = laneRay.m_lab[2];
+			m_invDirX[i] = 1.0 / laneRay.m_lab[0];
+			m_invDirY[i] = 1.0 / laneRay.m_lab[1];
+			m_invDirZ[i] = 1.0 / laneRay.m_lab[2];
+		}
+	}
+
+	inline Vec3 raypacket::getOrigin(int i) const {
+		return Vec3{ static_cast<RT::real>(m_originX[i]), static_cast<RT::real>(m_originY[i]), static_cast<RT::real>(m_originZ[i]) };
+	}
+
+	inline Vec3 raypacket::getDirection(int i) const {
+		return Vec3{ static_cast<RT::real>(m_dirX[i]), static_cast<RT::real>(m_dirY[i]), static_cast<RT::real>(m_dirZ[i]) };
+	}
+
+	// functions to load four lanes of origins or directions, starting at lane first
+	inline simdvec3 loadOrigins(const raypacket& rays, int first) {
+		return simdvec3{ simd4d::load(rays.m_originX + first), simd4d::load(rays.m_originY + first), simd4d::load(rays.m_originZ + first) };
+	}
+
+	inline simdvec3 loadDirections(const raypacket& rays, int first) {
+		return simdvec3{ simd4d::load(rays.m_dirX + first), simd4d::load(rays.m_dirY + first), simd4d::load(rays.m_dirZ + first) };
+	}
+
+	inline simd4d dot(const simdvec3& lhs, const simdvec3& rhs) {
+		return (lhs.m_x * rhs.m_x) + (lhs.m_y * rhs.m_y) + (lhs.m_z * rhs.m_z);
+	}
+
+	// functions to apply an affine transform to four points or directions at once
+	inline simdvec3 transformPoint(const Affine4& tfm, const simdvec3& point) {
+		simdvec3 result;
+		result.m_x = (simd4d(tfm.getElement(0, 0)) * point.m_x) + (simd4d(tfm.getElement(0, 1)) * point.m_y) + (simd4d(tfm.getElement(0, 2)) * point.m_z) + simd4d(tfm.getElement(0, 3));
+		result.m_y = (simd4d(tfm.getElement(1, 0)) * point.m_x) + (simd4d(tfm.getElement(1, 1)) * point.m_y) + (simd4d(tfm.getElement(1, 2)) * point.m_z) + simd4d(tfm.getElement(1, 3));
+		result.m_z = (simd4d(tfm.getElement(2, 0)) * point.m_x) + (simd4d(tfm.getElement(2, 1)) * point.m_y) + (simd4d(tfm.getElement(2, 2)) * point.m_z) + simd4d(tfm.getElement(2, 3));
+		return result;
+	}
+
+	inline simdvec3 transformDirection(const Affine4& tfm, const simdvec3& direction) {
+		simdvec3 result;
+		result.m_x = (simd4d(tfm.getElement(0, 0)) * direction.m_x) + (simd4d(tfm.getElement(0, 1)) * direction.m_y) + (simd4d(tfm.getElement(0, 2)) * direction.m_z);
+		result.m_y = (simd4d(tfm.getElement(1, 0)) * direction.m_x) + (simd4d(tfm.getElement(1, 1)) * direction.m_y) + (simd4d(tfm.getElement(1, 2)) * direction.m_z);
+		result.m_z = (simd4d(tfm.getElement(2, 0)) * direction.m_x) + (simd4d(tfm.getElement(2, 1)) * direction.m_y) + (simd4d(tfm.getElement(2, 2)) * direction.m_z);
+		return result;
+	}
+
+	// function to apply an affine transform to every ray in a packet (used to carry a packet into an object's local coordinates once)
+	// the directions aren't normalized, so t means the same thing for the transformed rays
+	inline void transformPacket(const Affine4& tfm, const raypacket& rays, raypacket& result) {
+		result.m_numRays = rays.m_numRays;
+		for (int first = 0; first < PACKET_SIZE; first += simd4d::WIDTH) {
+			simdvec3 origin = transformPoint(tfm, loadOrigins(rays, first));
+			simdvec3 dir = transformDirection(tfm, loadDirections(rays, first));
+			origin.m_x.store(result.m_originX + first);
+			origin.m_y.store(result.m_originY + first);
+			origin.m_z.store(result.m_originZ + first);
+			dir.m_x.store(result.m_dirX + first);
+			dir.m_y.store(result.m_dirY + first);
+			dir.m_z.store(result.m_dirZ + first);
+			(simd4d(1.0) / dir.m_x).store(result.m_invDirX + first);
+			(simd4d(1.0) / dir.m_y).store(result.m_invDirY + first);
+			(simd4d(1.0) / dir.m_z).store(result.m_invDirZ + first);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef RENDERCONFIG_H
+#define RENDERCONFIG_H
+
+namespace RT {
+	// settings that control how a scene is rendered
+	struct renderconfig {
+		// number of threads to render with (0 uses one per hardware thread)
+		int m_numThreads = 0;
+		// width and height (in pixels) of the square tiles the image is split into
+		int m_tileSize = 16;
+		// trace camera rays in packets of RT::PACKET_SIZE along each row of a tile (the image is the same either way)
+		bool m_usePackets = true;
+		// evaluate the camera rays of each tile breadth-first, one stage at a time for all of them, rather than following each path to its end (see wavefront.hpp)
+		// the image is the same either way, and anti-aliasing or a cost map use the depth-first path
+		bool m_wavefront = false;
+		// width and height of the tiles when m_wavefront is set (larger, so that each stage has plenty of rays to work through)
+		int m_wavefrontTileSize = 64;
+		// maximum number of reflection bounces along a path
+		int m_maxDepth = 3;
+		// paths carrying less than this fraction of light are not followed any further (0 disables the test)
+		double m_minThroughput = 0.0;
+		// anti-aliasing, used when m_maxSamples is more than 1 (otherwise each pixel is a single ray through its corner)
+		// each pixel starts with m_minSamples jittered samples, one in each cell of a square grid over the pixel (so the count is rounded to a square)
+		// while the estimate of a pixel is still noisy it gets further rounds of as many samples, up to m_maxSamples in all
+		int m_minSamples = 4;
+		int m_maxSamples = 1;
+		// a pixel gets another round of samples while the variance of its mean luminance is above this
+		double m_varianceThreshold = 1e-4;
+		// with depth of field or motion blur (see camera::needsSamples), take the lens and shutter samples from a low discrepancy sequence (see sampler.hpp)
+		// rather than independent random numbers, so the noise falls faster with the number of samples (the camera rays are then traced one at a time)
+		bool m_lowDiscrepancy = true;
+		// print the progress of each render to stdout
+		bool m_reportProgress = true;
+	};
+}
+
+#endif
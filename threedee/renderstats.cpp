@@ -0,0 +1,56 @@
+#include "renderstats.hpp"
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+// every bucket ever created, so that collect can reach the buckets of other threads
+// buckets are kept until the program ends, a thread that exits leaves its counts to be collected
+static std::mutex bucketMutex;
+static std::vector<std::unique_ptr<RT::statbucket>> bucketList;
+
+thread_local RT::statbucket* RT::renderstats::m_pThreadBucket = nullptr;
+
+// the names used for the counters and phases in the JSON summary
+static const char* counterNames[RT::STAT_NUM_COUNTERS] = { "camera_rays", "reflection_rays", "shadow_rays", "sphere_tests", "plane_tests", "triangle_tests", "bvh_nodes", "mesh_nodes" };
+static const char* phaseNames[RT::PHASE_NUM_PHASES] = { "other", "scene_build", "bvh_build", "trace", "shade", "display" };
+
+// function to create and register a bucket for the calling thread
+RT::statbucket& RT::renderstats::addBucket() {
+	std::lock_guard<std::mutex> lock(bucketMutex);
+	bucketList.emplace_back(new RT::statbucket());
+	m_pThreadBucket = bucketList.back().get();
+	m_pThreadBucket->m_phaseStart = std::chrono::steady_clock::now();
+	return *m_pThreadBucket;
+}
+
+// function to sum and zero every thread's bucket
+RT::statbucket RT::renderstats::collect() {
+	// bring the calling thread's current phase up to date first
+	RT::statbucket& ownBucket = getBucket();
+	auto now = std::chrono::steady_clock::now();
+	ownBucket.m_phaseNs[ownBucket.m_currentPhase] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - ownBucket.m_phaseStart).count();
+	ownBucket.m_phaseStart = now;
+	RT::statbucket totals;
+	std::lock_guard<std::mutex> lock(bucketMutex);
+	for (auto& pBucket : bucketList) {
+		for (int i = 0; i < RT::STAT_NUM_COUNTERS; i++) totals.m_counters[i] += pBucket->m_counters[i];
+		for (int i = 0; i < RT::PHASE_NUM_PHASES; i++) totals.m_phaseNs[i] += pBucket->m_phaseNs[i];
+		for (uint64_t& counter : pBucket->m_counters) counter = 0;
+		for (uint64_t& phaseNs : pBucket->m_phaseNs) phaseNs = 0;
+	}
+	return totals;
+}
+
+// function to format a set of totals as a JSON object
+std::string RT::renderstats::toJSON(const RT::statbucket& totals) {
+	std::ostringstream output;
+	output << "{ \"counters\": {";
+	for (int i = 0; i < RT::STAT_NUM_COUNTERS; i++) output << ((i > 0) ? ", \"" : " \"") << counterNames[i] << "\": " << totals.m_counters[i];
+	// phase times are summed over threads, so with several threads they add up to more than the time that passed
+	// (time spent outside every phase isn't reported, for the render threads most of it is waiting for work)
+	output << " }, \"phase_ms\": {";
+	for (int i = 1; i < RT::PHASE_NUM_PHASES; i++) output << ((i > 1) ? ", \"" : " \"") << phaseNames[i] << "\": " << (totals.m_phaseNs[i] / 1e6);
+	output << " } }";
+	return output.str();
+}
@@ -0,0 +1,112 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// ray and intersection counters, and timers for the phases of a render
+// they are compiled in only when RT_STATS is defined (add it to the preprocessor definitions of the build)
+// without it, the RT_STAT_ macros below expand to nothing, so the renderer carries no trace of them
+
+namespace RT {
+	// the events that are counted
+	enum statcounter {
+		STAT_CAMERA_RAYS = 0,
+		STAT_REFLECTION_RAYS,
+		STAT_SHADOW_RAYS,
+		STAT_SPHERE_TESTS,
+		STAT_PLANE_TESTS,
+		STAT_TRIANGLE_TESTS,
+		STAT_BVH_NODES,
+		STAT_MESH_NODES,
+		STAT_NUM_COUNTERS
+	};
+
+	// the phases that are timed
+	// phases nest (a reflection is traced in the middle of shading) but each moment is charged to the innermost phase only,
+	// so the times add up to the time spent in all of them
+	enum statphase {
+		PHASE_NONE = 0,
+		PHASE_SCENE_BUILD,
+		PHASE_BVH_BUILD,
+		PHASE_TRACE,
+		PHASE_SHADE,
+		PHASE_DISPLAY,
+		PHASE_NUM_PHASES
+	};
+
+	// the counters and phase times of one thread
+	struct statbucket {
+		uint64_t m_counters[STAT_NUM_COUNTERS] = {};
+		uint64_t m_phaseNs[PHASE_NUM_PHASES] = {};
+		// the phase being timed on this thread, and when it was entered (or resumed)
+		statphase m_currentPhase = PHASE_NONE;
+		std::chrono::steady_clock::time_point m_phaseStart;
+	};
+
+	class renderstats {
+		public:
+			// function to return the calling thread's bucket, which is written without any synchronisation
+			static statbucket& getBucket();
+			// function to return the sum of every thread's bucket, and zero them so that the next call starts afresh
+			// call it while no other thread is adding to its bucket (e.g. between renders)
+			static statbucket collect();
+			// function to format a set of totals as a JSON object
+			static std::string toJSON(const statbucket& totals);
+		private:
+			// function to create and register a bucket for the calling thread
+			static statbucket& addBucket();
+			// the calling thread's bucket (nullptr until it is first used)
+			static thread_local statbucket* m_pThreadBucket;
+	};
+
+	inline statbucket& renderstats::getBucket() {
+		statbucket* pBucket = m_pThreadBucket;
+		return (pBucket != nullptr) ? *pBucket : addBucket();
+	}
+
+	// charges the calling thread's time to a phase from construction to destruction, then goes back to the phase it interrupted
+	class statphasetimer {
+		public:
+			// constructor, enters the phase
+			statphasetimer(statphase phase);
+			// destructor, leaves it
+			~statphasetimer();
+		private:
+			statphase m_previousPhase;
+	};
+
+	inline statphasetimer::statphasetimer(statphase phase) {
+		statbucket& bucket = renderstats::getBucket();
+		auto now = std::chrono::steady_clock::now();
+		bucket.m_phaseNs[bucket.m_currentPhase] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - bucket.m_phaseStart).count();
+		m_previousPhase = bucket.m_currentPhase;
+		bucket.m_currentPhase = phase;
+		bucket.m_phaseStart = now;
+	}
+
+	inline statphasetimer::~statphasetimer() {
+		statbucket& bucket = renderstats::getBucket();
+		auto now = std::chrono::steady_clock::now();
+		bucket.m_phaseNs[bucket.m_currentPhase] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - bucket.m_phaseStart).count();
+		bucket.m_currentPhase = m_previousPhase;
+		bucket.m_phaseStart = now;
+	}
+}
+
+#if defined(RT_STATS)
+#define RT_STAT_CONCAT_(a, b) a##b
+#define RT_STAT_CONCAT(a, b) RT_STAT_CONCAT_(a, b)
+// count one event
+#define RT_STAT_COUNT(counter) (RT::renderstats::getBucket().m_counters[RT::counter]++)
+// count n events
+#define RT_STAT_ADD(counter, n) (RT::renderstats::getBucket().m_counters[RT::counter] += (n))
+// time the rest of the enclosing block as the given phase
+#define RT_STAT_PHASE(phase) RT::statphasetimer RT_STAT_CONCAT(statPhaseTimer, __LINE__)(RT::phase)
+#else
+#define RT_STAT_COUNT(counter) ((void)0)
+#define RT_STAT_ADD(counter, n) ((void)0)
+#define RT_STAT_PHASE(phase) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,101 @@
+#include "sampler.hpp"
+#include <cmath>
+#include <cstdint>
+
+// the numbers of a sample, from a hash of the pixel, the sample and the dimension
+// (the hash depends only on its arguments, so any pixel can be sampled on its own)
+static uint64_t hashSample(int x, int y, int sample, int dimension) {
+	uint64_t state = (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) ^ static_cast<uint32_t>(y);
+	state ^= (static_cast<uint64_t>(sample) << 8) * 0x9E3779B97F4A7C15ull;
+	state += static_cast<uint64_t>(dimension) * 0xBF58476D1CE4E5B9ull;
+	// splitmix64 finaliser
+	state = (state ^ (state >> 30)) * 0xBF58476D1CE4E5B9ull;
+	state = (state ^ (state >> 27)) * 0x94D049BB133111EBull;
+	state ^= state >> 31;
+	return state;
+}
+
+// function to return a pseudo-random number for one dimension of one sample of a pixel
+double RT::pixelRandom(int x, int y, int sample, int dimension) {
+	return static_cast<double>(hashSample(x, y, sample, dimension) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// function to reverse the order of the bits of a number
+static uint32_t reverseBits(uint32_t value) {
+	value = ((value >> 1) & 0x55555555u) | ((value & 0x55555555u) << 1);
+	value = ((value >> 2) & 0x33333333u) | ((value & 0x33333333u) << 2);
+	value = ((value >> 4) & 0x0F0F0F0Fu) | ((value & 0x0F0F0F0Fu) << 4);
+	value = ((value >> 8) & 0x00FF00FFu) | ((value & 0x00FF00FFu) << 8);
+	return (value >> 16) | (value << 16);
+}
+
+// function to scramble the bits of a number, each bit is flipped or not depending only on the bits above it (an Owen scramble)
+// this is Laine and Karras' hash run on the reversed bits, with the constants from Burley's "Practical Hash-based Owen Scrambling"
+static uint32_t nestedUniformScramble(uint32_t value, uint32_t seed) {
+	value = reverseBits(value);
+	value += seed;
+	value ^= value * 0x6C50B47Cu;
+	value ^= value * 0xB82F1E52u;
+	value ^= value * 0xC7AFE638u;
+	value ^= value * 0x8D22F6E6u;
+	return reverseBits(value);
+}
+
+// functions to return the first two dimensions of the Sobol sequence, as 32 bit fractions
+// the first is the van der Corput sequence, the second has the direction numbers of the polynomial x + 1
+static uint32_t sobolDimension0(uint32_t index) {
+	return reverseBits(index);
+}
+
+static uint32_t sobolDimension1(uint32_t index) {
+	uint32_t result = 0;
+	for (uint32_t direction = 1u << 31; index != 0; index >>= 1, direction ^= direction >> 1) {
+		if (index & 1) result ^= direction;
+	}
+	return result;
+}
+
+// function to turn a 32 bit fraction into a number in [0, 1)
+static double toUnit(uint32_t fraction) {
+	return static_cast<double>(fraction) * (1.0 / 4294967296.0);
+}
+
+// function to return a point of the 2D sequence for one sample of a pixel
+// the sample number is shuffled first (with a scramble of its own, which keeps every aligned run of 2^k samples together), then each coordinate is scrambled
+void RT::sobol2D(int x, int y, int sample, int dimension, double& u, double& v) {
+	uint64_t seed = hashSample(x, y, 0, dimension);
+	uint32_t index = nestedUniformScramble(static_cast<uint32_t>(sample), static_cast<uint32_t>(seed));
+	u = toUnit(nestedUniformScramble(sobolDimension0(index), static_cast<uint32_t>(seed >> 32)));
+	v = toUnit(nestedUniformScramble(sobolDimension1(index), static_cast<uint32_t>(hashSample(x, y, 1, dimension))));
+}
+
+// function to return a number of the 1D sequence for one sample of a pixel
+double RT::sobol1D(int x, int y, int sample, int dimension) {
+	uint64_t seed = hashSample(x, y, 0, dimension);
+	uint32_t index = nestedUniformScramble(static_cast<uint32_t>(sample), static_cast<uint32_t>(seed));
+	return toUnit(nestedUniformScramble(sobolDimension0(index), static_cast<uint32_t>(seed >> 32)));
+}
+
+// function to map a point onto the unit disk
+// squares around the center of [-1, 1] x [-1, 1] are mapped onto circles, so neighbouring points stay neighbours and areas are kept
+void RT::concentricDisk(double u, double v, double& diskX, double& diskY) {
+	const double quarterPi = 0.78539816339744831;
+	double a = (2.0 * u) - 1.0;
+	double b = (2.0 * v) - 1.0;
+	if ((a == 0.0) && (b == 0.0)) {
+		diskX = 0.0;
+		diskY = 0.0;
+		return;
+	}
+	double radius, angle;
+	if (std::fabs(a) > std::fabs(b)) {
+		radius = a;
+		angle = quarterPi * (b / a);
+	}
+	else {
+		radius = b;
+		angle = (2.0 * quarterPi) - (quarterPi * (a / b));
+	}
+	diskX = radius * std::cos(angle);
+	diskY = radius * std::sin(angle);
+}
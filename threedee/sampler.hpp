@@ -0,0 +1,23 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+namespace RT {
+	// the positions of the samples taken within a pixel, on the lens and over the shutter interval
+	// every function here depends only on its arguments (the pixel, the number of the sample and the dimension), so the image doesn't depend on which thread renders which pixel
+	// dimensions pick independent streams of numbers for the same sample, so that (for instance) the lens and the time of a sample aren't correlated
+
+	// function to return a pseudo-random number in [0, 1) for one dimension of one sample of a pixel
+	double pixelRandom(int x, int y, int sample, int dimension);
+
+	// function to return a point in [0, 1) x [0, 1) for one sample of a pixel, from a low discrepancy sequence
+	// the points are the first two dimensions of the Sobol sequence, Owen scrambled (and their order shuffled) differently for each pixel and dimension
+	// any 2^k samples of a pixel starting at a multiple of 2^k are then stratified in u, in v and in both together, so the error falls much faster with the sample count than with random points
+	void sobol2D(int x, int y, int sample, int dimension, double& u, double& v);
+	// function to return a number in [0, 1) for one sample of a pixel, from the first dimension of the same sequence
+	double sobol1D(int x, int y, int sample, int dimension);
+
+	// function to map a point of [0, 1) x [0, 1) onto the unit disk, keeping its stratification (Shirley and Chiu's concentric mapping)
+	void concentricDisk(double u, double v, double& diskX, double& diskY);
+}
+
+#endif
@@ -1,7 +1,24 @@
 #include "scene.hpp"
 #include "materialbase.hpp"
 #include "simplematerial.hpp"
+#include "sceneparser.hpp"
+#include "scenecache.hpp"
+#include "objloader.hpp"
+#include "objgroup.hpp"
+#include "objinstance.hpp"
+#include "renderstats.hpp"
+#include "sampler.hpp"
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cmath>
+
+// the dimensions of the samples of a pixel (see sampler.hpp), the position within the pixel, on the lens (two dimensions when they are random) and in the shutter interval
+constexpr int SCENE_DIMENSION_PIXEL = 0;
+constexpr int SCENE_DIMENSION_LENS = 2;
+constexpr int SCENE_DIMENSION_TIME = 4;
 
 // constructor
 RT::scene::scene() {
@@ -11,22 +28,22 @@ RT::scene::scene() {
 	auto testMaterial3 = std::make_shared<RT::simplematerial>(RT::simplematerial());
 	auto floorMaterial = std::make_shared<RT::simplematerial>(RT::simplematerial());
 	// set up the materials
-	testMaterial->m_baseColor = vector<double>{ std::vector<double>{0.25, 0.5, 0,8} };
+	testMaterial->m_baseColor = Vec3{ 0.25, 0.5, 0.8 };
 	testMaterial->m_reflectivity = 0.1;
 	testMaterial->m_shininess = 10.0;
-	testMaterial2->m_baseColor = vector<double>{ std::vector<double>{1.0, 0.5, 0.0} };
+	testMaterial2->m_baseColor = Vec3{ 1.0, 0.5, 0.0 };
 	testMaterial2->m_reflectivity = 0.75;
 	testMaterial2->m_shininess = 10.0;
-	testMaterial3->m_baseColor = vector<double>{ std::vector<double>{1.0, 0.8, 0.0} };
+	testMaterial3->m_baseColor = Vec3{ 1.0, 0.8, 0.0 };
 	testMaterial3->m_reflectivity = 0.25;
 	testMaterial3->m_shininess = 10.0;
-	floorMaterial->m_baseColor = vector<double>{ std::vector<double>{1.0, 1.0, 1.0} };
+	floorMaterial->m_baseColor = Vec3{ 1.0, 1.0, 1.0 };
 	floorMaterial->m_reflectivity = 0.5;
 	floorMaterial->m_shininess = 0.0;
 	// configure the camera
-	m_camera.setPosition(vector<double>{std::vector<double>{0.0, -10.0, -1.0}});
-	m_camera.setLookAt(vector<double>{std::vector<double> {0.0, 0.0, 0.0}});
-	m_camera.setUp(vector<double>{std::vector<double>{0.0, 0.0, 1.0}});
+	m_camera.setPosition(Vec3{ 0.0, -10.0, -1.0 });
+	m_camera.setLookAt(Vec3{ 0.0, 0.0, 0.0 });
+	m_camera.setUp(Vec3{ 0.0, 0.0, 1.0 });
 	m_camera.setHorzSize(0.25);
 	m_camera.setAspect(16.0 / 9.0);
 	m_camera.updateCameraGeometry();
@@ -36,22 +53,22 @@ RT::scene::scene() {
 	m_objectList.push_back(std::make_shared<RT::objsphere>(RT::objsphere()));
 	// construct a test plane
 	m_objectList.push_back(std::make_shared<RT::objplane>(RT::objplane()));
-	m_objectList.at(3)->m_baseColor = vector<double>{ std::vector<double> {0.5, 0.5, 0.5} };
+	m_objectList.at(3)->m_baseColor = Vec3{ 0.5, 0.5, 0.5 };
 	// define a transform for the plane
 	RT::GTform planeMatrix;
-	planeMatrix.setTransform(vector<double>{std::vector<double>{0.0, 0.0, 0.75}}, vector<double>{std::vector<double>{0.0, 0.0, 0.0}}, vector<double>{std::vector<double>{4.0, 4.0, 1.0}});
+	planeMatrix.setTransform(Vec3{ 0.0, 0.0, 0.75 }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 4.0, 4.0, 1.0 });
 	m_objectList.at(3)->setTransformMatrix(planeMatrix);
 	// modify the spheres
 	RT::GTform testMatrix1, testMatrix2, testMatrix3;
-	testMatrix1.setTransform(vector<double>{std::vector<double>{-1.5, 0.0, 0.0}}, vector<double>{std::vector<double>{0.0, 0.0, 0.0}}, vector<double>{std::vector<double>{0.5, 0.5, 0.5}});
-	testMatrix2.setTransform(vector<double>{std::vector<double>{0.0, 0.0, 0.0}}, vector<double>{std::vector<double>{0.0, 0.0, 0.0}}, vector<double>{std::vector<double>{0.5, 0.5, 0.5}});
-	testMatrix3.setTransform(vector<double>{std::vector<double>{1.5, 0.0, 0.0}}, vector<double>{std::vector<double>{0.0, 0.0, 0.0}}, vector<double>{std::vector<double>{0.5, 0.5, 0.5}});
+	testMatrix1.setTransform(Vec3{ -1.5, 0.0, 0.0 }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 0.5, 0.5, 0.5 });
+	testMatrix2.setTransform(Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 0.5, 0.5, 0.5 });
+	testMatrix3.setTransform(Vec3{ 1.5, 0.0, 0.0 }, Vec3{ 0.0, 0.0, 0.0 }, Vec3{ 0.5, 0.5, 0.5 });
 	m_objectList.at(0)->setTransformMatrix(testMatrix1);
 	m_objectList.at(1)->setTransformMatrix(testMatrix2);
 	m_objectList.at(2)->setTransformMatrix(testMatrix3);
-	m_objectList.at(0)->m_baseColor = vector<double>{ std::vector<double>{0.25, 0.5, 0.8} }; // blue
-	m_objectList.at(1)->m_baseColor = vector<double>{ std::vector<double>{1.0, 0.5, 0.0} }; // yellow
-	m_objectList.at(2)->m_baseColor = vector<double>{ std::vector<double>{1.0, 0.8, 0.0} }; // orange
+	m_objectList.at(0)->m_baseColor = Vec3{ 0.25, 0.5, 0.8 }; // blue
+	m_objectList.at(1)->m_baseColor = Vec3{ 1.0, 0.5, 0.0 }; // yellow
+	m_objectList.at(2)->m_baseColor = Vec3{ 1.0, 0.8, 0.0 }; // orange
 	// assign materials to objects
 	m_objectList.at(0)->assignMaterial(testMaterial3);
 	m_objectList.at(1)->assignMaterial(testMaterial);
@@ -59,90 +76,417 @@ RT::scene::scene() {
 	m_objectList.at(3)->assignMaterial(floorMaterial);
 	// construct a test light
 	m_lightList.push_back(std::make_shared<RT::pointlight>(RT::pointlight()));
-	m_lightList.at(0)->m_location = vector<double>{ std::vector<double> {5.0, -10.0, -5.0} };
-	m_lightList.at(0)->m_color = vector<double>{ std::vector<double>{0.0, 0.0, 1.0} }; // blue light
+	m_lightList.at(0)->m_location = Vec3{ 5.0, -10.0, -5.0 };
+	m_lightList.at(0)->m_color = Vec3{ 0.0, 0.0, 1.0 }; // blue light
 	m_lightList.push_back(std::make_shared<RT::pointlight>(RT::pointlight()));
-	m_lightList.at(1)->m_location = vector<double>{ std::vector<double> {-5.0, -10.0, -5.0} };
-	m_lightList.at(1)->m_color = vector<double>{ std::vector<double> {1.0, 0.0, 0.0} }; // red light
+	m_lightList.at(1)->m_location = Vec3{ -5.0, -10.0, -5.0 };
+	m_lightList.at(1)->m_color = Vec3{ 1.0, 0.0, 0.0 }; // red light
 	m_lightList.push_back(std::make_shared<RT::pointlight>(RT::pointlight()));
-	m_lightList.at(2)->m_location = vector<double>{ std::vector<double> {0.0, -10.0, -5.0} };
-	m_lightList.at(2)->m_color = vector<double>{ std::vector<double> {0.0, 1.0, 0.0} }; // green light
+	m_lightList.at(2)->m_location = Vec3{ 0.0, -10.0, -5.0 };
+	m_lightList.at(2)->m_color = Vec3{ 0.0, 1.0, 0.0 }; // green light
+}
+
+// function to load a scene file
+void RT::scene::loadFile(const std::string& fileName) {
+	RT_STAT_PHASE(PHASE_SCENE_BUILD);
+	std::string cacheFileName = fileName + ".cache";
+	// use the cache if it is up to date, it holds the hierarchy as well so nothing needs building
+	RT::scenecache cache;
+	if (cache.open(cacheFileName, fileName)) {
+		buildFromDescription(cache.getRecords());
+		m_bvhBuilt = m_objectBVH.restore(m_objectList, cache.getNodes(), cache.getNumNodes(), cache.getPrimIndices(), cache.getNumPrimIndices(), cache.getUnbounded(), cache.getNumUnbounded());
+		if (m_bvhBuilt) return;
+	}
+	// otherwise parse the scene file and cache the result for next time
+	RT::scenedescription description;
+	RT::sceneparser parser;
+	parser.parse(fileName, description);
+	buildFromDescription(RT::getRecords(description));
+	m_objectBVH.build(m_objectList);
+	m_bvhBuilt = true;
+	// the cache is only an optimisation, so failing to write it (e.g. a read-only directory) isn't an error
+	if (!RT::scenecache::write(cacheFileName, fileName, description, m_objectBVH)) {
+		std::cout << "could not write the scene cache " << cacheFileName << std::endl;
+	}
+}
+
+// function to create the object for a record, with its transform (instances must come after the prototypes they use)
+static std::shared_ptr<RT::objectbase> makeObject(const RT::objectdesc& desc, const std::vector<std::shared_ptr<const RT::meshdata>>& meshList, const std::vector<std::shared_ptr<RT::objectbase>>& prototypeList) {
+	std::shared_ptr<RT::objectbase> object;
+	if (desc.m_type == RT::OBJECT_PLANE) object = std::make_shared<RT::objplane>();
+	else if (desc.m_type == RT::OBJECT_MESH) object = std::make_shared<RT::objmesh>(meshList[desc.m_mesh]);
+	else if (desc.m_type == RT::OBJECT_INSTANCE) object = std::make_shared<RT::objinstance>(prototypeList[desc.m_prototype]);
+	else object = std::make_shared<RT::objsphere>();
+	if (desc.m_moving == 0) {
+		// the transform is stored in both directions, so nothing is inverted here
+		object->setTransformMatrix(RT::GTform(Affine4(desc.m_fwdtfm), Affine4(desc.m_bcktfm)));
+		return object;
+	}
+	// an object that moves is placed by an instance that moves, and is left where it is defined (at the origin) itself
+	std::shared_ptr<RT::objinstance> instance = (desc.m_type == RT::OBJECT_INSTANCE) ? std::static_pointer_cast<RT::objinstance>(object) : std::make_shared<RT::objinstance>(object);
+	RT::gtfmparts motion[2];
+	for (int i = 0; i < 2; i++) {
+		motion[i].m_translation = Vec3::fromArray(desc.m_motionTranslation[i]);
+		motion[i].m_rotation = Vec3::fromArray(desc.m_motionRotation[i]);
+		motion[i].m_scale = Vec3::fromArray(desc.m_motionScale[i]);
+	}
+	instance->setMotion(motion[0], motion[1]);
+	return instance;
+}
+
+// function to replace the scene with the one described by the given records
+void RT::scene::buildFromDescription(const RT::scenerecords& records) {
+	// load the meshes first, so the scene is left as it was if one can't be read (each mesh is shared by every object that uses it)
+	std::vector<std::shared_ptr<const RT::meshdata>> meshList;
+	for (const std::string& meshFile : *records.m_pMeshFiles) meshList.push_back(RT::loadOBJ(meshFile));
+	m_objectList.clear();
+	m_lightList.clear();
+	m_bvhBuilt = false;
+	// configure the camera
+	const RT::cameradesc& camera = *records.m_pCamera;
+	m_camera.setPosition(Vec3::fromArray(camera.m_position));
+	m_camera.setLookAt(Vec3::fromArray(camera.m_lookAt));
+	m_camera.setUp(Vec3::fromArray(camera.m_up));
+	m_camera.setLength(camera.m_length);
+	m_camera.setHorzSize(camera.m_horzSize);
+	m_camera.setAspect(camera.m_aspect);
+	m_camera.setAperture(camera.m_aperture);
+	m_camera.setFocusDistance(camera.m_focusDistance);
+	m_camera.setShutter(camera.m_shutter[0], camera.m_shutter[1]);
+	m_camera.updateCameraGeometry();
+	// create the materials
+	std::vector<std::shared_ptr<RT::materialbase>> materialList(records.m_numMaterials);
+	for (int i = 0; i < records.m_numMaterials; i++) {
+		const RT::materialdesc& desc = records.m_pMaterials[i];
+		auto material = std::make_shared<RT::simplematerial>();
+		material->m_baseColor = Vec3::fromArray(desc.m_baseColor);
+		material->m_reflectivity = desc.m_reflectivity;
+		material->m_shininess = desc.m_shininess;
+		materialList[i] = material;
+	}
+	// create the prototypes, each one is built once and shared by all of its instances
+	// a prototype of a single object is that object, larger ones are grouped under a hierarchy of their own
+	std::vector<std::shared_ptr<RT::objectbase>> prototypeList(records.m_numPrototypes);
+	for (int i = 0; i < records.m_numPrototypes; i++) {
+		const RT::prototypedesc& prototype = records.m_pPrototypes[i];
+		std::vector<std::shared_ptr<RT::objectbase>> parts;
+		for (int j = 0; j < prototype.m_numObjects; j++) parts.push_back(makeObject(records.m_pPrototypeObjects[prototype.m_firstObject + j], meshList, prototypeList));
+		if (parts.size() == 1) prototypeList[i] = parts[0];
+		else prototypeList[i] = std::make_shared<RT::objgroup>(parts);
+	}
+	// create the objects
+	m_objectList.reserve(records.m_numObjects);
+	for (int i = 0; i < records.m_numObjects; i++) {
+		const RT::objectdesc& desc = records.m_pObjects[i];
+		std::shared_ptr<RT::objectbase> object = makeObject(desc, meshList, prototypeList);
+		object->m_baseColor = Vec3::fromArray(desc.m_baseColor);
+		if (desc.m_material >= 0) object->assignMaterial(materialList[desc.m_material]);
+		m_objectList.push_back(object);
+	}
+	// create the lights
+	for (int i = 0; i < records.m_numLights; i++) {
+		const RT::lightdesc& desc = records.m_pLights[i];
+		auto light = std::make_shared<RT::pointlight>();
+		light->m_location = Vec3::fromArray(desc.m_location);
+		light->m_color = Vec3::fromArray(desc.m_color);
+		light->m_intensity = desc.m_intensity;
+		m_lightList.push_back(light);
+	}
+}
+
+// the work done so far by the calling thread, sampled either side of a pixel for the cost map
+struct pixelCost {
+	uint64_t m_rays = 0;
+	uint64_t m_tests = 0;
+	std::chrono::steady_clock::time_point m_time;
+};
+
+static pixelCost samplePixelCost() {
+	pixelCost cost;
+#if defined(RT_STATS)
+	const RT::statbucket& bucket = RT::renderstats::getBucket();
+	cost.m_rays = bucket.m_counters[RT::STAT_CAMERA_RAYS] + bucket.m_counters[RT::STAT_REFLECTION_RAYS] + bucket.m_counters[RT::STAT_SHADOW_RAYS];
+	cost.m_tests = bucket.m_counters[RT::STAT_SPHERE_TESTS] + bucket.m_counters[RT::STAT_PLANE_TESTS] + bucket.m_counters[RT::STAT_TRIANGLE_TESTS];
+#endif
+	cost.m_time = std::chrono::steady_clock::now();
+	return cost;
+}
+
+// function to place the lens and shutter samples of sample number `sample` of pixel (x, y), as entry i of samples
+static void sampleLensAndTime(bool lowDiscrepancy, int x, int y, int sample, RT::camerasamples& samples, int i) {
+	if (lowDiscrepancy) {
+		RT::sobol2D(x, y, sample, SCENE_DIMENSION_LENS, samples.m_lensU[i], samples.m_lensV[i]);
+		samples.m_time[i] = RT::sobol1D(x, y, sample, SCENE_DIMENSION_TIME);
+	}
+	else {
+		samples.m_lensU[i] = RT::pixelRandom(x, y, sample, SCENE_DIMENSION_LENS);
+		samples.m_lensV[i] = RT::pixelRandom(x, y, sample, SCENE_DIMENSION_LENS + 1);
+		samples.m_time[i] = RT::pixelRandom(x, y, sample, SCENE_DIMENSION_TIME);
+	}
 }
 
 // function to perform the rendering
-bool RT::scene::render(image &outputImage) {
+bool RT::scene::render(image &outputImage, RT::costmap* pCostMap) {
+	if ((pCostMap != nullptr) && ((pCostMap->getXSize() != outputImage.getXSize()) || (pCostMap->getYSize() != outputImage.getYSize()))) return false;
+	// build the acceleration structure over the objects in the scene (unless it was loaded with them)
+	if (!m_bvhBuilt) {
+		m_objectBVH.build(m_objectList);
+		m_bvhBuilt = true;
+	}
+	// make sure we have the requested number of worker threads
+	if ((!m_pThreadPool) || ((m_config.m_numThreads > 0) && (m_pThreadPool->getNumThreads() != m_config.m_numThreads))) {
+		m_pThreadPool.reset(new RT::threadpool(m_config.m_numThreads));
+	}
 	// get the dimensions of the output image
 	int xSize = outputImage.getXSize();
 	int ySize = outputImage.getYSize();
-	// loop over each pixel in our image
-	RT::ray cameraRay; // ray to generate for each pixel
-	vector<double> intPoint(3);
-	vector<double> localNormal(3);
-	vector<double> localColor(3);
 	double xFact = 1.0 / (static_cast<double>(xSize) / 2.0);
 	double yFact = 1.0 / (static_cast<double>(ySize) / 2.0);
-	double minDist = 1e6;
-	double maxDist = 0.0;
-	for (int y = 0; y < ySize; y++) {
-		std::cout << "processing line " << y << " of " << ySize << std::endl; // for debugging, gives a time estimate on when the process will finish (number of pixels for width)
-		for (int x = 0; x < xSize; x++) {
-			// normalize the x and y coordinates
-			double normX = (static_cast<double>(x) * xFact) - 1.0;
-			double normY = (static_cast<double>(y) * yFact) - 1.0;
-			// generate the ray for this pixel
-			m_camera.generateRay(normX, normY, cameraRay);
-			// test for intersections with all objects in the scene
-			std::shared_ptr<RT::objectbase> closestObject;
-			vector<double> closestIntPoint{ 3 };
-			vector<double> closestLocalNormal{ 3 };
-			vector<double> closestLocalColor{ 3 };
-			bool intersectionFound = castRay(cameraRay, closestObject, closestIntPoint, closestLocalNormal, closestLocalColor);
-			// compute the illumination for the closest object
-			// assuming that there was a valid intersection
-			if (intersectionFound) {
-				// check if the object has a material
-				if (closestObject->m_hasMaterial) {
-					// use the material to compute the color
-					RT::materialbase::m_reflectionRayCount = 0;
-					vector<double> color = closestObject->m_pMaterial->computeColor(m_objectList, m_lightList, closestObject, closestIntPoint, closestLocalNormal, cameraRay);
-					outputImage.setPixel(x, y, color.getElement(0), color.getElement(1), color.getElement(2));
+	// pixels are sampled adaptively when more than one sample is allowed (packets only trace one ray per pixel)
+	bool adaptive = m_config.m_maxSamples > 1;
+	// rays that sample the lens or the shutter interval are traced one at a time (packets, and the wavefront queues, don't carry the time of each ray)
+	bool cameraSamples = m_camera.needsSamples();
+	// the wavefront integrator traces a single ray per pixel, and doesn't time pixels one at a time
+	bool wavefrontMode = m_config.m_wavefront && (!adaptive) && (pCostMap == nullptr) && (!cameraSamples);
+	if (wavefrontMode) m_wavefronts.resize(m_pThreadPool->getNumThreads());
+	// split the image into tiles
+	// every pixel is computed independently of the others, so the result doesn't depend on which thread renders which tile
+	int tileSize = std::max(1, wavefrontMode ? m_config.m_wavefrontTileSize : m_config.m_tileSize);
+	int numTilesX = (xSize + tileSize - 1) / tileSize;
+	int numTilesY = (ySize + tileSize - 1) / tileSize;
+	int numTiles = numTilesX * numTilesY;
+	// scratch data for each render thread
+	std::vector<RT::threadcontext> threadContexts(m_pThreadPool->getNumThreads());
+	for (int i = 0; i < static_cast<int>(threadContexts.size()); i++) threadContexts[i].m_threadIndex = i;
+	std::atomic<int> tilesDone(0);
+	std::atomic<int64_t> totalSamples(0);
+	std::mutex progressMutex;
+	m_pThreadPool->parallelFor(numTiles, [&](int tileIndex, int threadIndex) {
+		int x0 = (tileIndex % numTilesX) * tileSize;
+		int y0 = (tileIndex / numTilesX) * tileSize;
+		int x1 = std::min(x0 + tileSize, xSize);
+		int y1 = std::min(y0 + tileSize, ySize);
+		// the tile is rendered into a buffer owned by this thread and copied into the image in one go (pixels that hit nothing stay black)
+		int tileWidth = x1 - x0;
+		std::vector<float>& tileBuffer = threadContexts[threadIndex].m_tileBuffer;
+		tileBuffer.assign(tileWidth * (y1 - y0) * image::NUM_CHANNELS, 0.0f);
+		int64_t tileSamples = 0;
+		auto setTilePixel = [&](int x, int y, const Vec3& pixelColor) {
+			float* pPixel = &tileBuffer[(((y - y0) * tileWidth) + (x - x0)) * image::NUM_CHANNELS];
+			pPixel[0] = static_cast<float>(pixelColor.getElement(0));
+			pPixel[1] = static_cast<float>(pixelColor.getElement(1));
+			pPixel[2] = static_cast<float>(pixelColor.getElement(2));
+		};
+		if (wavefrontMode) {
+			// the whole tile goes through the wavefront stages together
+			m_wavefronts[threadIndex].renderTile(m_camera, m_objectBVH, m_lightList, m_config, x0, y0, x1, y1, xFact, yFact, tileBuffer.data());
+		}
+		else {
+			// with one sample per pixel, the camera rays of the whole tile are generated in one go
+			RT::threadcontext& threadContext = threadContexts[threadIndex];
+			const RT::camerarays& cameraRays = threadContext.m_cameraRays;
+			if (!adaptive) {
+				const RT::camerasamples* pSamples = nullptr;
+				if (cameraSamples) {
+					// each ray still goes through the corner of its pixel, but from its own point on the lens and at its own time
+					RT::camerasamples& samples = threadContext.m_cameraSamples;
+					samples.resize(tileWidth * (y1 - y0));
+					for (int y = y0, i = 0; y < y1; y++) {
+						for (int x = x0; x < x1; x++, i++) {
+							samples.m_pixelX[i] = 0.0;
+							samples.m_pixelY[i] = 0.0;
+							sampleLensAndTime(m_config.m_lowDiscrepancy, x, y, 0, samples, i);
+						}
+					}
+					pSamples = &samples;
+				}
+				m_camera.generateRays(x0, y0, x1, y1, 1, xFact, yFact, pSamples, threadContext.m_cameraRays);
+			}
+			for (int y = y0; y < y1; y++) {
+				int rowStart = (y - y0) * tileWidth;
+				if (m_config.m_usePackets && (pCostMap == nullptr) && (!adaptive) && (!cameraSamples)) {
+					// trace the row in packets of neighbouring pixels, whose camera rays are almost parallel
+					for (int x = x0; x < x1; x += RT::PACKET_SIZE) {
+						int numPixels = std::min(RT::PACKET_SIZE, x1 - x);
+						RT::ray packetRays[RT::PACKET_SIZE];
+						for (int i = 0; i < numPixels; i++) packetRays[i] = cameraRays.getRay(rowStart + (x - x0) + i);
+						Vec3 pixelColors[RT::PACKET_SIZE];
+						int hitMask = renderPixelPacket(packetRays, numPixels, threadContext, pixelColors);
+						for (int i = 0; i < numPixels; i++) {
+							if (hitMask & (1 << i)) setTilePixel(x + i, y, pixelColors[i]);
+						}
+					}
+					continue;
 				}
-				else {
-					// use the basic method to compute the color
-					vector<double> matColor = RT::materialbase::computeDiffuseColor(m_objectList, m_lightList, closestObject, closestIntPoint, closestLocalNormal, closestObject->m_baseColor);
-					outputImage.setPixel(x, y, matColor.getElement(0), matColor.getElement(1), matColor.getElement(2));
+				for (int x = x0; x < x1; x++) {
+					Vec3 pixelColor;
+					pixelCost before;
+					if (pCostMap != nullptr) before = samplePixelCost();
+					int numSamples = 1;
+					if (adaptive) {
+						numSamples = renderPixelAdaptive(x, y, xFact, yFact, threadContext, pixelColor);
+						setTilePixel(x, y, pixelColor);
+					}
+					else if (renderPixel(cameraRays.getRay(rowStart + (x - x0)), threadContext, pixelColor)) setTilePixel(x, y, pixelColor);
+					tileSamples += numSamples;
+					if (pCostMap != nullptr) {
+						pixelCost after = samplePixelCost();
+						double nanoseconds = std::chrono::duration<double, std::nano>(after.m_time - before.m_time).count();
+						pCostMap->setPixel(x, y, static_cast<double>(after.m_rays - before.m_rays), static_cast<double>(after.m_tests - before.m_tests), nanoseconds, numSamples);
+					}
 				}
 			}
 		}
+		outputImage.writeTile(x0, y0, tileWidth, y1 - y0, tileBuffer.data());
+		totalSamples += tileSamples;
+		// for debugging, gives a time estimate on when the process will finish (reported every 10%)
+		int done = ++tilesDone;
+		if (m_config.m_reportProgress && (((done * 10) / numTiles) != (((done - 1) * 10) / numTiles))) {
+			std::lock_guard<std::mutex> lock(progressMutex);
+			std::cout << "processed " << done << " of " << numTiles << " tiles" << std::endl;
+		}
+	});
+	if (adaptive && m_config.m_reportProgress) {
+		std::cout << "samples per pixel: " << (static_cast<double>(totalSamples) / (static_cast<double>(xSize) * ySize)) << " on average, up to " << m_config.m_maxSamples << std::endl;
 	}
+#if defined(RT_STATS)
+	// everything counted since the last summary (including loading the scene and converting the last frame for display)
+	std::cout << "render stats: " << RT::renderstats::toJSON(RT::renderstats::collect()) << std::endl;
+#endif
+	return true;
+}
+
+// functions to set and return the render settings
+void RT::scene::setRenderConfig(const RT::renderconfig& config) {
+	m_config = config;
+}
+
+RT::renderconfig RT::scene::getRenderConfig() const {
+	return m_config;
+}
+
+// function to return the render threads
+RT::threadpool* RT::scene::getThreadPool() const {
+	return m_pThreadPool.get();
+}
+
+// function to compute the color seen along a single camera ray
+bool RT::scene::renderPixel(const RT::ray& cameraRay, RT::threadcontext& threadContext, Vec3& pixelColor) {
+	RT_STAT_COUNT(STAT_CAMERA_RAYS);
+	// test for intersections with all objects in the scene
+	std::shared_ptr<RT::objectbase> closestObject;
+	Vec3 closestIntPoint;
+	Vec3 closestLocalNormal;
+	Vec3 closestLocalColor;
+	bool intersectionFound = castRay(cameraRay, closestObject, closestIntPoint, closestLocalNormal, closestLocalColor);
+	// compute the illumination for the closest object
+	// assuming that there was a valid intersection
+	if (!intersectionFound) return false;
+	pixelColor = shadeHit(cameraRay, closestObject, closestIntPoint, closestLocalNormal, threadContext);
 	return true;
 }
 
+// function to compute the color of a pixel from several samples
+int RT::scene::renderPixelAdaptive(int x, int y, double xFact, double yFact, RT::threadcontext& threadContext, Vec3& pixelColor) {
+	// each round is a grid of gridSize x gridSize cells, with one jittered sample in each
+	// the grid is centered on the point that the single ray of a pixel goes through (its corner on the screen), so the image doesn't shift when sampling is turned on
+	int gridSize = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(m_config.m_minSamples)) + 0.5));
+	int roundSize = gridSize * gridSize;
+	// the variance needs at least two samples, so the first round is never smaller than that
+	if (roundSize < 2) {
+		gridSize = 2;
+		roundSize = 4;
+	}
+	int maxSamples = std::max(m_config.m_maxSamples, roundSize);
+	double red = 0.0, green = 0.0, blue = 0.0;
+	double lumSum = 0.0, lumSumSq = 0.0;
+	int numSamples = 0;
+	while (numSamples < maxSamples) {
+		// place the samples of this round, then generate their camera rays together
+		int roundCount = std::min(roundSize, maxSamples - numSamples);
+		RT::camerasamples& samples = threadContext.m_cameraSamples;
+		samples.resize(roundCount);
+		for (int cell = 0; cell < roundCount; cell++) {
+			samples.m_pixelX[cell] = ((static_cast<double>(cell % gridSize) + RT::pixelRandom(x, y, numSamples + cell, SCENE_DIMENSION_PIXEL)) / gridSize) - 0.5;
+			samples.m_pixelY[cell] = ((static_cast<double>(cell / gridSize) + RT::pixelRandom(x, y, numSamples + cell, SCENE_DIMENSION_PIXEL + 1)) / gridSize) - 0.5;
+			sampleLensAndTime(m_config.m_lowDiscrepancy, x, y, numSamples + cell, samples, cell);
+		}
+		m_camera.generateRays(x, y, x + 1, y + 1, roundCount, xFact, yFact, &samples, threadContext.m_cameraRays);
+		for (int cell = 0; cell < roundCount; cell++, numSamples++) {
+			Vec3 sampleColor;
+			if (!renderPixel(threadContext.m_cameraRays.getRay(cell), threadContext, sampleColor)) continue;
+			red += sampleColor.getElement(0);
+			green += sampleColor.getElement(1);
+			blue += sampleColor.getElement(2);
+			double luminance = (0.2126 * sampleColor.getElement(0)) + (0.7152 * sampleColor.getElement(1)) + (0.0722 * sampleColor.getElement(2));
+			lumSum += luminance;
+			lumSumSq += luminance * luminance;
+		}
+		// stop once the variance of the mean is small enough
+		double variance = (lumSumSq - ((lumSum * lumSum) / numSamples)) / (numSamples - 1);
+		if ((variance / numSamples) <= m_config.m_varianceThreshold) break;
+	}
+	pixelColor = Vec3{ static_cast<RT::real>(red / numSamples), static_cast<RT::real>(green / numSamples), static_cast<RT::real>(blue / numSamples) };
+	return numSamples;
+}
+
+// function to compute the colors of a packet of pixels along a row
+int RT::scene::renderPixelPacket(const RT::ray* cameraRays, int numPixels, RT::threadcontext& threadContext, Vec3* pixelColors) {
+	RT_STAT_ADD(STAT_CAMERA_RAYS, numPixels);
+	// find the closest object along each of them
+	std::shared_ptr<RT::objectbase> closestObjects[RT::PACKET_SIZE];
+	Vec3 closestIntPoints[RT::PACKET_SIZE];
+	Vec3 closestLocalNormals[RT::PACKET_SIZE];
+	Vec3 closestLocalColors[RT::PACKET_SIZE];
+	int hitMask = castRayPacket(cameraRays, numPixels, closestObjects, closestIntPoints, closestLocalNormals, closestLocalColors);
+	// shading is done one ray at a time
+	for (int i = 0; i < numPixels; i++) {
+		if (hitMask & (1 << i)) pixelColors[i] = shadeHit(cameraRays[i], closestObjects[i], closestIntPoints[i], closestLocalNormals[i], threadContext);
+	}
+	return hitMask;
+}
+
+// function to compute the color seen along a camera ray
+Vec3 RT::scene::shadeHit(const RT::ray& cameraRay, const std::shared_ptr<RT::objectbase>& closestObject, const Vec3& closestIntPoint, const Vec3& closestLocalNormal, RT::threadcontext& threadContext) {
+	// check if the object has a material
+	if (closestObject->m_hasMaterial) {
+		// use the material to compute the color, starting a new path for this camera ray
+		RT::pathstate pathState;
+		pathState.m_maxDepth = m_config.m_maxDepth;
+		pathState.m_minThroughput = m_config.m_minThroughput;
+		pathState.m_pThread = &threadContext;
+		return closestObject->m_pMaterial->computeColor(m_objectBVH, m_lightList, closestObject, closestIntPoint, closestLocalNormal, cameraRay, pathState);
+	}
+	else {
+		// use the basic method to compute the color
+		return RT::materialbase::computeDiffuseColor(m_objectBVH, m_lightList, closestObject, closestIntPoint, closestLocalNormal, closestObject->m_baseColor, cameraRay.m_time);
+	}
+}
+
 // function to cast a ray into the scene
-bool RT::scene::castRay(RT::ray& castRay, std::shared_ptr<RT::objectbase>& closestObject, vector<double>& closestIntPoint, vector<double>& closestLocalNormal, vector<double>& closestLocalColor) {
-	vector<double> intPoint{ 3 };
-	vector<double> localNormal{ 3 };
-	vector<double> localColor{ 3 };
-	double minDist = 1e6;
-	bool intersectionFound = false; // flag
-	for (auto currentObject : m_objectList) {
-		bool validInt = currentObject->testIntersections(castRay, intPoint, localNormal, localColor);
-		// if we have a valid intersection
-		if (validInt) {
-			// set the flag to indicate that we found an intersection
-			intersectionFound = true;
-			// compute the distance between the camera and the point of intersection
-			double dist = (intPoint - castRay.m_point1).norm();
-			// if this object is closer to the camera than any one that we have scene before
-			// then store a reference to it
-			if (dist < minDist) {
-				minDist = dist;
-				closestObject = currentObject;
-				closestIntPoint = intPoint;
-				closestLocalNormal = localNormal;
-				closestLocalColor = localColor;
-			}
+bool RT::scene::castRay(const RT::ray& castRay, std::shared_ptr<RT::objectbase>& closestObject, Vec3& closestIntPoint, Vec3& closestLocalNormal, Vec3& closestLocalColor) {
+	// find the closest intersection with any object in the scene
+	RT_STAT_PHASE(PHASE_TRACE);
+	return m_objectBVH.castRay(castRay, nullptr, closestObject, closestIntPoint, closestLocalNormal, closestLocalColor);
+}
+
+// function to cast a packet of rays into the scene
+int RT::scene::castRayPacket(const RT::ray* castRays, int numRays, std::shared_ptr<RT::objectbase>* closestObjects, Vec3* closestIntPoints, Vec3* closestLocalNormals, Vec3* closestLocalColors) {
+	// find the closest object along each ray with the simd kernels
+	RT_STAT_PHASE(PHASE_TRACE);
+	RT::raypacket rays;
+	rays.setRays(castRays, numRays);
+	RT::packethit hits;
+	int hitMask = m_objectBVH.castPacket(rays, hits);
+	// compute the intersection details for the closest object only
+	const std::vector<std::shared_ptr<RT::objectbase>>& objectList = m_objectBVH.getObjectList();
+	for (int i = 0; i < numRays; i++) {
+		if (!(hitMask & (1 << i))) continue;
+		closestObjects[i] = objectList[hits.m_index[i]];
+		if (!closestObjects[i]->testIntersections(castRays[i], closestIntPoints[i], closestLocalNormals[i], closestLocalColors[i])) {
+			// the packet and scalar tests can disagree for rays that only graze an object, let the scalar path decide those
+			if (!m_objectBVH.castRay(castRays[i], nullptr, closestObjects[i], closestIntPoints[i], closestLocalNormals[i], closestLocalColors[i])) hitMask &= ~(1 << i);
 		}
 	}
-	return intersectionFound;
-}
\ No newline at end of file
+	return hitMask;
+}
@@ -1,28 +1,71 @@
 #ifndef SCENE_H
 #define SCENE_H
 #include <memory>
+#include <string>
 #include <vector>
-#include <SDL.h>
 #include "image.hpp"
 #include "camera.hpp"
 #include "objsphere.hpp"
 #include "objplane.hpp"
+#include "objmesh.hpp"
 #include "pointlight.hpp"
+#include "bvh.hpp"
+#include "renderconfig.hpp"
+#include "pathstate.hpp"
+#include "threadpool.hpp"
+#include "scenedescription.hpp"
+#include "costmap.hpp"
+#include "wavefront.hpp"
 
 namespace RT {
 	class scene {
 		public:
-			// default constructor
+			// default constructor, sets up the built-in test scene
 			scene();
+			// function to replace the scene with one read from a scene file (see sceneparser.hpp for the format), throws std::runtime_error on failure
+			// the parsed scene and its bounding volume hierarchy are cached in fileName + ".cache", which is used instead while the scene file is unchanged
+			void loadFile(const std::string& fileName);
 			// function to perform the rendering
-			bool render(image& outputImage);
+			// if a cost map is given (initialized to the size of the image), the cost of each pixel is recorded in it
+			// the pixels are then traced one at a time, so that each one's cost is its own
+			bool render(image& outputImage, RT::costmap* pCostMap = nullptr);
+			// functions to set and return the render settings
+			void setRenderConfig(const RT::renderconfig& config);
+			RT::renderconfig getRenderConfig() const;
+			// function to return the render threads, so that other work can share them (nullptr before the first render)
+			RT::threadpool* getThreadPool() const;
 			// function to cast a ray into the scene
-			bool castRay(RT::ray& castRay, std::shared_ptr<RT::objectbase>& closestObject, vector<double>& closestIntPoint, vector<double>& closestLocalNormal, vector<double>& closestLocalColor);
+			bool castRay(const RT::ray& castRay, std::shared_ptr<RT::objectbase>& closestObject, Vec3& closestIntPoint, Vec3& closestLocalNormal, Vec3& closestLocalColor);
+			// function to cast up to RT::PACKET_SIZE rays into the scene together, returns a bitmask of the rays that hit something
+			// the outputs are arrays with one entry per ray, only entries for rays that hit something are written
+			int castRayPacket(const RT::ray* castRays, int numRays, std::shared_ptr<RT::objectbase>* closestObjects, Vec3* closestIntPoints, Vec3* closestLocalNormals, Vec3* closestLocalColors);
 		private:
+			// function to replace the scene with the one described by the given records
+			// (meshes are loaded from their OBJ files here, throws std::runtime_error if one can't be read)
+			void buildFromDescription(const RT::scenerecords& records);
+			// function to compute the color seen along a single camera ray, returns false if it hits nothing
+			bool renderPixel(const RT::ray& cameraRay, RT::threadcontext& threadContext, Vec3& pixelColor);
+			// function to compute the color of pixel (x, y) from several samples spread over it (see renderconfig), returns the number of samples taken
+			// the color is the mean of the samples, with those whose camera ray hits nothing counted as black
+			int renderPixelAdaptive(int x, int y, double xFact, double yFact, RT::threadcontext& threadContext, Vec3& pixelColor);
+			// function to compute the colors of up to RT::PACKET_SIZE pixels along a row from their camera rays, returns a bitmask of the pixels whose camera ray hit something
+			int renderPixelPacket(const RT::ray* cameraRays, int numPixels, RT::threadcontext& threadContext, Vec3* pixelColors);
+			// function to compute the color seen along a camera ray that hit closestObject
+			Vec3 shadeHit(const RT::ray& cameraRay, const std::shared_ptr<RT::objectbase>& closestObject, const Vec3& closestIntPoint, const Vec3& closestLocalNormal, RT::threadcontext& threadContext);
+			// the render settings
+			RT::renderconfig m_config;
+			// the worker threads (created on the first render, and again if the thread count changes)
+			std::unique_ptr<RT::threadpool> m_pThreadPool;
+			// the queues of the wavefront integrator for each thread, kept from one render to the next
+			std::vector<RT::wavefront> m_wavefronts;
 			// the camera that we will use
 			RT::camera m_camera;
 			// the list of objects in the scene (creates pointers to instances of base class of our objects)
 			std::vector<std::shared_ptr<RT::objectbase>> m_objectList;
+			// the bounding volume hierarchy over m_objectList, shared by every ray query
+			RT::bvh m_objectBVH;
+			// whether m_objectBVH is up to date with m_objectList
+			bool m_bvhBuilt = false;
 			// the list of point lights in the scene
 			std::vector<std::shared_ptr<RT::lightbase>> m_lightList;
 	};
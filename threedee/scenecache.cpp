@@ -0,0 +1,273 @@
+#include "scenecache.hpp"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// identifies a cache file, the version must be increased whenever a cached record or the way the bvh is built changes
+constexpr char SCENECACHE_MAGIC[8] = "RTSCENE";
+constexpr uint32_t SCENECACHE_VERSION = 5;
+// the cache is written in the native byte order, a cache from a machine with the other byte order reads this back differently
+constexpr uint32_t SCENECACHE_BYTE_ORDER = 0x01020304;
+// alignment of each array in the file (the mapping itself is page aligned)
+constexpr int64_t SCENECACHE_ALIGNMENT = 8;
+
+// the records are written exactly as they are in memory
+static_assert(std::is_trivially_copyable<RT::cameradesc>::value && std::is_trivially_copyable<RT::materialdesc>::value && std::is_trivially_copyable<RT::objectdesc>::value && std::is_trivially_copyable<RT::lightdesc>::value && std::is_trivially_copyable<RT::prototypedesc>::value && std::is_trivially_copyable<RT::bvh::node>::value, "cached records must be trivially copyable");
+static_assert((alignof(RT::objectdesc) <= SCENECACHE_ALIGNMENT) && (alignof(RT::bvh::node) <= SCENECACHE_ALIGNMENT), "cached records must not need more than the cache alignment");
+
+// an array in the cache file
+struct scenecacheSection {
+	int64_t m_offset;
+	int64_t m_count;
+};
+
+// the size and modification time of a file
+struct scenecacheStamp {
+	int64_t m_size;
+	int64_t m_time;
+};
+
+// the start of a cache file (laid out without padding, so every byte written is defined)
+struct scenecacheHeader {
+	char m_magic[8];
+	uint32_t m_version;
+	uint32_t m_byteOrder;
+	// the sizes of the records, so that a cache written by a build with a different layout is ignored
+	uint32_t m_recordSizes[6];
+	// the size and modification time of the scene file the cache was made from
+	scenecacheStamp m_source;
+	RT::cameradesc m_camera;
+	scenecacheSection m_materials;
+	scenecacheSection m_objects;
+	scenecacheSection m_lights;
+	scenecacheSection m_prototypes;
+	scenecacheSection m_prototypeObjects;
+	scenecacheSection m_nodes;
+	scenecacheSection m_primIndices;
+	scenecacheSection m_unbounded;
+	// the mesh file names (each null terminated, the count is in bytes) and their stamps
+	scenecacheSection m_meshNames;
+	scenecacheSection m_meshStamps;
+};
+
+static_assert(sizeof(scenecacheHeader) == (40 + sizeof(scenecacheStamp) + sizeof(RT::cameradesc) + (10 * sizeof(scenecacheSection))), "the cache header must not contain padding");
+
+// function to fill in the fields that identify a valid cache
+static void setIdentity(scenecacheHeader& header) {
+	std::memcpy(header.m_magic, SCENECACHE_MAGIC, sizeof(header.m_magic));
+	header.m_version = SCENECACHE_VERSION;
+	header.m_byteOrder = SCENECACHE_BYTE_ORDER;
+	header.m_recordSizes[0] = sizeof(RT::materialdesc);
+	header.m_recordSizes[1] = sizeof(RT::objectdesc);
+	header.m_recordSizes[2] = sizeof(RT::lightdesc);
+	header.m_recordSizes[3] = sizeof(RT::bvh::node);
+	header.m_recordSizes[4] = sizeof(RT::prototypedesc);
+	header.m_recordSizes[5] = sizeof(scenecacheStamp);
+}
+
+// function to return the size and modification time of a file
+static bool getFileStamp(const std::string& fileName, scenecacheStamp& stamp) {
+#ifdef _WIN32
+	struct _stat64 fileInfo;
+	if (_stat64(fileName.c_str(), &fileInfo) != 0) return false;
+#else
+	struct stat fileInfo;
+	if (stat(fileName.c_str(), &fileInfo) != 0) return false;
+#endif
+	stamp.m_size = static_cast<int64_t>(fileInfo.st_size);
+	stamp.m_time = static_cast<int64_t>(fileInfo.st_mtime);
+	return true;
+}
+
+// function to round an offset up to the alignment of the arrays
+static int64_t alignOffset(int64_t offset) {
+	return (offset + SCENECACHE_ALIGNMENT - 1) & ~(SCENECACHE_ALIGNMENT - 1);
+}
+
+// function to find an array in a mapped cache, returns false if it doesn't lie within the file
+template <class T>
+static bool findSection(const RT::mappedfile& file, const scenecacheSection& section, const T*& pData, int& count) {
+	uint64_t fileSize = file.getSize();
+	if ((section.m_offset < 0) || ((section.m_offset % SCENECACHE_ALIGNMENT) != 0) || (static_cast<uint64_t>(section.m_offset) > fileSize)) return false;
+	if ((section.m_count < 0) || (section.m_count > std::numeric_limits<int>::max())) return false;
+	if (static_cast<uint64_t>(section.m_count) > ((fileSize - section.m_offset) / sizeof(T))) return false;
+	pData = reinterpret_cast<const T*>(file.getData() + section.m_offset);
+	count = static_cast<int>(section.m_count);
+	return true;
+}
+
+// function to check that a list of objects only refers to materials, meshes and prototypes that exist
+static bool validObjects(const RT::objectdesc* objects, int numObjects, int numMaterials, int numMeshes, int numPrototypes) {
+	for (int i = 0; i < numObjects; i++) {
+		const RT::objectdesc& object = objects[i];
+		if ((object.m_material < -1) || (object.m_material >= numMaterials)) return false;
+		if (object.m_type == RT::OBJECT_MESH) {
+			if ((object.m_mesh < 0) || (object.m_mesh >= numMeshes)) return false;
+		}
+		else if (object.m_type == RT::OBJECT_INSTANCE) {
+			if ((object.m_prototype < 0) || (object.m_prototype >= numPrototypes)) return false;
+		}
+		else if ((object.m_type != RT::OBJECT_SPHERE) && (object.m_type != RT::OBJECT_PLANE)) return false;
+	}
+	return true;
+}
+
+// constructor
+RT::scenecache::scenecache() {
+	close();
+}
+
+// function to write a cache
+bool RT::scenecache::write(const std::string& cacheFileName, const std::string& sourceFileName, const RT::scenedescription& description, const RT::bvh& objectBVH) {
+	scenecacheHeader header = {};
+	setIdentity(header);
+	if (!getFileStamp(sourceFileName, header.m_source)) return false;
+	std::vector<char> meshNames;
+	std::vector<scenecacheStamp> meshStamps(description.m_meshFiles.size());
+	for (size_t i = 0; i < description.m_meshFiles.size(); i++) {
+		meshNames.insert(meshNames.end(), description.m_meshFiles[i].c_str(), description.m_meshFiles[i].c_str() + description.m_meshFiles[i].size() + 1);
+		if (!getFileStamp(description.m_meshFiles[i], meshStamps[i])) return false;
+	}
+	header.m_camera = description.m_camera;
+	// lay out the arrays one after another
+	int64_t offset = alignOffset(sizeof(header));
+	auto placeSection = [&](scenecacheSection& section, size_t count, size_t recordSize) {
+		section.m_offset = offset;
+		section.m_count = static_cast<int64_t>(count);
+		offset = alignOffset(offset + static_cast<int64_t>(count * recordSize));
+	};
+	placeSection(header.m_materials, description.m_materials.size(), sizeof(RT::materialdesc));
+	placeSection(header.m_objects, description.m_objects.size(), sizeof(RT::objectdesc));
+	placeSection(header.m_lights, description.m_lights.size(), sizeof(RT::lightdesc));
+	placeSection(header.m_prototypes, description.m_prototypes.size(), sizeof(RT::prototypedesc));
+	placeSection(header.m_prototypeObjects, description.m_prototypeObjects.size(), sizeof(RT::objectdesc));
+	placeSection(header.m_nodes, objectBVH.getNodes().size(), sizeof(RT::bvh::node));
+	placeSection(header.m_primIndices, objectBVH.getPrimIndices().size(), sizeof(int));
+	placeSection(header.m_unbounded, objectBVH.getUnbounded().size(), sizeof(int));
+	placeSection(header.m_meshNames, meshNames.size(), sizeof(char));
+	placeSection(header.m_meshStamps, meshStamps.size(), sizeof(scenecacheStamp));
+	// write to a temporary file and move it into place at the end, so that a partly written cache is never read
+	std::string tempFileName = cacheFileName + ".tmp";
+	FILE* pFile = std::fopen(tempFileName.c_str(), "wb");
+	if (pFile == nullptr) return false;
+	bool success = true;
+	auto writeBytes = [&](const void* pData, size_t numBytes) {
+		if (success && (numBytes > 0)) success = (std::fwrite(pData, 1, numBytes, pFile) == numBytes);
+		// pad to the start of the next array
+		static const char padding[SCENECACHE_ALIGNMENT] = { 0 };
+		size_t paddingBytes = static_cast<size_t>(alignOffset(static_cast<int64_t>(numBytes)) - static_cast<int64_t>(numBytes));
+		if (success && (paddingBytes > 0)) success = (std::fwrite(padding, 1, paddingBytes, pFile) == paddingBytes);
+	};
+	writeBytes(&header, sizeof(header));
+	writeBytes(description.m_materials.data(), description.m_materials.size() * sizeof(RT::materialdesc));
+	writeBytes(description.m_objects.data(), description.m_objects.size() * sizeof(RT::objectdesc));
+	writeBytes(description.m_lights.data(), description.m_lights.size() * sizeof(RT::lightdesc));
+	writeBytes(description.m_prototypes.data(), description.m_prototypes.size() * sizeof(RT::prototypedesc));
+	writeBytes(description.m_prototypeObjects.data(), description.m_prototypeObjects.size() * sizeof(RT::objectdesc));
+	writeBytes(objectBVH.getNodes().data(), objectBVH.getNodes().size() * sizeof(RT::bvh::node));
+	writeBytes(objectBVH.getPrimIndices().data(), objectBVH.getPrimIndices().size() * sizeof(int));
+	writeBytes(objectBVH.getUnbounded().data(), objectBVH.getUnbounded().size() * sizeof(int));
+	writeBytes(meshNames.data(), meshNames.size());
+	writeBytes(meshStamps.data(), meshStamps.size() * sizeof(scenecacheStamp));
+	if (std::fclose(pFile) != 0) success = false;
+	if (success) {
+		// rename won't replace an existing file on every platform
+		std::remove(cacheFileName.c_str());
+		success = (std::rename(tempFileName.c_str(), cacheFileName.c_str()) == 0);
+	}
+	if (!success) std::remove(tempFileName.c_str());
+	return success;
+}
+
+// function to map a cache
+bool RT::scenecache::open(const std::string& cacheFileName, const std::string& sourceFileName) {
+	close();
+	scenecacheStamp source;
+	if (!getFileStamp(sourceFileName, source)) return false;
+	if ((!m_file.open(cacheFileName)) || (m_file.getSize() < sizeof(scenecacheHeader))) {
+		close();
+		return false;
+	}
+	// check that the cache was written by this version, for this version of the scene file
+	scenecacheHeader expected = {};
+	setIdentity(expected);
+	const scenecacheHeader* pHeader = reinterpret_cast<const scenecacheHeader*>(m_file.getData());
+	bool valid = (std::memcmp(pHeader->m_magic, expected.m_magic, sizeof(expected.m_magic)) == 0) && (pHeader->m_version == expected.m_version) && (pHeader->m_byteOrder == expected.m_byteOrder);
+	valid = valid && (std::memcmp(pHeader->m_recordSizes, expected.m_recordSizes, sizeof(expected.m_recordSizes)) == 0);
+	valid = valid && (pHeader->m_source.m_size == source.m_size) && (pHeader->m_source.m_time == source.m_time);
+	// find the arrays
+	valid = valid && findSection(m_file, pHeader->m_materials, m_records.m_pMaterials, m_records.m_numMaterials);
+	valid = valid && findSection(m_file, pHeader->m_objects, m_records.m_pObjects, m_records.m_numObjects);
+	valid = valid && findSection(m_file, pHeader->m_lights, m_records.m_pLights, m_records.m_numLights);
+	valid = valid && findSection(m_file, pHeader->m_prototypes, m_records.m_pPrototypes, m_records.m_numPrototypes);
+	valid = valid && findSection(m_file, pHeader->m_prototypeObjects, m_records.m_pPrototypeObjects, m_records.m_numPrototypeObjects);
+	valid = valid && findSection(m_file, pHeader->m_nodes, m_pNodes, m_numNodes);
+	valid = valid && findSection(m_file, pHeader->m_primIndices, m_pPrimIndices, m_numPrimIndices);
+	valid = valid && findSection(m_file, pHeader->m_unbounded, m_pUnbounded, m_numUnbounded);
+	const char* pMeshNames = nullptr;
+	const scenecacheStamp* pMeshStamps = nullptr;
+	int numNameBytes = 0;
+	int numMeshes = 0;
+	valid = valid && findSection(m_file, pHeader->m_meshNames, pMeshNames, numNameBytes);
+	valid = valid && findSection(m_file, pHeader->m_meshStamps, pMeshStamps, numMeshes);
+	// read the mesh file names, and check that none of the files has changed
+	for (int offset = 0; valid && (offset < numNameBytes); ) {
+		const char* pEnd = static_cast<const char*>(std::memchr(pMeshNames + offset, '\0', numNameBytes - offset));
+		valid = (pEnd != nullptr);
+		if (!valid) break;
+		m_meshFiles.push_back(std::string(pMeshNames + offset, pEnd));
+		offset = static_cast<int>(pEnd - pMeshNames) + 1;
+	}
+	valid = valid && (static_cast<int>(m_meshFiles.size()) == numMeshes);
+	for (int i = 0; valid && (i < numMeshes); i++) {
+		scenecacheStamp meshStamp;
+		valid = getFileStamp(m_meshFiles[i], meshStamp) && (meshStamp.m_size == pMeshStamps[i].m_size) && (meshStamp.m_time == pMeshStamps[i].m_time);
+	}
+	// check the objects refer to things that exist (the hierarchy is checked by bvh::restore)
+	valid = valid && validObjects(m_records.m_pObjects, m_records.m_numObjects, m_records.m_numMaterials, numMeshes, m_records.m_numPrototypes);
+	valid = valid && validObjects(m_records.m_pPrototypeObjects, m_records.m_numPrototypeObjects, m_records.m_numMaterials, numMeshes, 0);
+	for (int i = 0; valid && (i < m_records.m_numPrototypes); i++) {
+		const RT::prototypedesc& prototype = m_records.m_pPrototypes[i];
+		valid = (prototype.m_numObjects > 0) && (prototype.m_firstObject >= 0) && (prototype.m_firstObject <= m_records.m_numPrototypeObjects - prototype.m_numObjects);
+	}
+	if (!valid) {
+		close();
+		return false;
+	}
+	m_records.m_pCamera = &pHeader->m_camera;
+	m_records.m_pMeshFiles = &m_meshFiles;
+	return true;
+}
+
+// function to unmap the cache
+void RT::scenecache::close() {
+	m_file.close();
+	m_records = RT::scenerecords();
+	m_meshFiles.clear();
+	m_pNodes = nullptr;
+	m_pPrimIndices = nullptr;
+	m_pUnbounded = nullptr;
+	m_numNodes = 0;
+	m_numPrimIndices = 0;
+	m_numUnbounded = 0;
+}
+
+// function to return the cached scene
+const RT::scenerecords& RT::scenecache::getRecords() const { return m_records; }
+
+// functions to return the cached hierarchy
+const RT::bvh::node* RT::scenecache::getNodes() const { return m_pNodes; }
+
+int RT::scenecache::getNumNodes() const { return m_numNodes; }
+
+const int* RT::scenecache::getPrimIndices() const { return m_pPrimIndices; }
+
+int RT::scenecache::getNumPrimIndices() const { return m_numPrimIndices; }
+
+const int* RT::scenecache::getUnbounded() const { return m_pUnbounded; }
+
+int RT::scenecache::getNumUnbounded() const { return m_numUnbounded; }
@@ -0,0 +1,50 @@
+#ifndef SCENECACHE_H
+#define SCENECACHE_H
+#include <string>
+#include <vector>
+#include "scenedescription.hpp"
+#include "mappedfile.hpp"
+#include "bvh.hpp"
+
+namespace RT {
+	// binary cache of a parsed scene and the bounding volume hierarchy built over its objects
+	// the file is a header followed by arrays of scenedescription records, bvh nodes and indices (each 8 byte aligned),
+	// so once it is mapped the arrays are used where they are and nothing needs parsing
+	// the cache records the size and modification time of the scene file it came from, and of the OBJ files its meshes use
+	// (their bounds are in the cached hierarchy), and is ignored once any of them changes
+	class scenecache {
+		public:
+			// constructor
+			scenecache();
+			// function to write a cache of a scene file, returns false if it couldn't be written
+			static bool write(const std::string& cacheFileName, const std::string& sourceFileName, const RT::scenedescription& description, const RT::bvh& objectBVH);
+			// function to map a cache, returns false if it is missing, out of date or damaged
+			bool open(const std::string& cacheFileName, const std::string& sourceFileName);
+			// function to unmap the cache (the records and pointers returned below are no longer valid)
+			void close();
+			// function to return the cached scene
+			const RT::scenerecords& getRecords() const;
+			// functions to return the cached hierarchy, in the form taken by bvh::restore
+			const RT::bvh::node* getNodes() const;
+			int getNumNodes() const;
+			const int* getPrimIndices() const;
+			int getNumPrimIndices() const;
+			const int* getUnbounded() const;
+			int getNumUnbounded() const;
+		private:
+			// the mapped file
+			RT::mappedfile m_file;
+			// the scene, pointing into the mapped file (apart from the mesh file names, which are copied out of it)
+			RT::scenerecords m_records;
+			std::vector<std::string> m_meshFiles;
+			// the hierarchy, pointing into the mapped file
+			const RT::bvh::node* m_pNodes;
+			const int* m_pPrimIndices;
+			const int* m_pUnbounded;
+			int m_numNodes;
+			int m_numPrimIndices;
+			int m_numUnbounded;
+	};
+}
+
+#endif
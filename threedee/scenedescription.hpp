@@ -0,0 +1,121 @@
+#ifndef SCENEDESCRIPTION_H
+#define SCENEDESCRIPTION_H
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RT {
+	// plain data describing a scene, as read from a scene file
+	// every record is trivially copyable with a fixed layout, so arrays of them are written to the binary cache as they are
+	// and used straight from the memory-mapped cache on later runs
+
+	// the camera
+	struct cameradesc {
+		double m_position[3] = { 0.0, -10.0, 0.0 };
+		double m_lookAt[3] = { 0.0, 0.0, 0.0 };
+		double m_up[3] = { 0.0, 0.0, 1.0 };
+		double m_length = 1.0;
+		double m_horzSize = 1.0;
+		double m_aspect = 1.0;
+		// the thin lens (an aperture of 0 is a pinhole, a focus distance of 0 focuses on the look at point) and the shutter interval
+		double m_aperture = 0.0;
+		double m_focusDistance = 0.0;
+		double m_shutter[2] = { 0.0, 0.0 };
+	};
+
+	// a simplematerial
+	struct materialdesc {
+		double m_baseColor[3] = { 1.0, 0.0, 1.0 };
+		double m_reflectivity = 0.0;
+		double m_shininess = 0.0;
+	};
+
+	// the kinds of object a scene file can contain
+	enum objecttype : int32_t { OBJECT_SPHERE = 0, OBJECT_PLANE = 1, OBJECT_MESH = 2, OBJECT_INSTANCE = 3 };
+
+	// an object, with its transform already in forward and backward form so that nothing needs inverting when it is loaded
+	struct objectdesc {
+		int32_t m_type = OBJECT_SPHERE;
+		// index into the list of materials (-1 for none)
+		int32_t m_material = -1;
+		// index into the list of mesh files, for meshes
+		int32_t m_mesh = -1;
+		// index into the list of prototypes, for instances
+		int32_t m_prototype = -1;
+		// non-zero if the object moves, from its transform at time 0 to its end transform at time 1
+		int32_t m_moving = 0;
+		// unused, keeps the doubles below aligned without padding
+		int32_t m_reserved = 0;
+		double m_baseColor[3] = { 1.0, 1.0, 1.0 };
+		// the top three rows of the forward and backward transforms, row by row (as stored by Affine4)
+		double m_fwdtfm[12];
+		double m_bcktfm[12];
+		// the translation, rotation and scale at the start and end of the motion, for objects that move
+		// these are kept rather than the end transform, as they are interpolated separately (blending two matrices doesn't give a rotation)
+		double m_motionTranslation[2][3];
+		double m_motionRotation[2][3];
+		double m_motionScale[2][3];
+	};
+
+	// a prototype, shared geometry placed in the scene by instances
+	// it is made up of m_prototypeObjects[m_firstObject, m_firstObject + m_numObjects) (which have no color or material of their own)
+	struct prototypedesc {
+		int32_t m_firstObject = 0;
+		int32_t m_numObjects = 0;
+	};
+
+	// a point light
+	struct lightdesc {
+		double m_location[3] = { 0.0, 0.0, 0.0 };
+		double m_color[3] = { 1.0, 1.0, 1.0 };
+		double m_intensity = 1.0;
+	};
+
+	// a whole scene
+	struct scenedescription {
+		cameradesc m_camera;
+		std::vector<materialdesc> m_materials;
+		std::vector<objectdesc> m_objects;
+		std::vector<lightdesc> m_lights;
+		std::vector<prototypedesc> m_prototypes;
+		std::vector<objectdesc> m_prototypeObjects;
+		// the OBJ files used by meshes (each is loaded once and shared by every mesh that uses it)
+		std::vector<std::string> m_meshFiles;
+	};
+
+	// pointers to the records of a scene, wherever they are stored (a scenedescription, or a mapped scenecache)
+	struct scenerecords {
+		const cameradesc* m_pCamera = nullptr;
+		const materialdesc* m_pMaterials = nullptr;
+		int m_numMaterials = 0;
+		const objectdesc* m_pObjects = nullptr;
+		int m_numObjects = 0;
+		const lightdesc* m_pLights = nullptr;
+		int m_numLights = 0;
+		const prototypedesc* m_pPrototypes = nullptr;
+		int m_numPrototypes = 0;
+		const objectdesc* m_pPrototypeObjects = nullptr;
+		int m_numPrototypeObjects = 0;
+		const std::vector<std::string>* m_pMeshFiles = nullptr;
+	};
+
+	// function to return the records of a scene description
+	inline scenerecords getRecords(const scenedescription& description) {
+		scenerecords records;
+		records.m_pCamera = &description.m_camera;
+		records.m_pMaterials = description.m_materials.data();
+		records.m_numMaterials = static_cast<int>(description.m_materials.size());
+		records.m_pObjects = description.m_objects.data();
+		records.m_numObjects = static_cast<int>(description.m_objects.size());
+		records.m_pLights = description.m_lights.data();
+		records.m_numLights = static_cast<int>(description.m_lights.size());
+		records.m_pPrototypes = description.m_prototypes.data();
+		records.m_numPrototypes = static_cast<int>(description.m_prototypes.size());
+		records.m_pPrototypeObjects = description.m_prototypeObjects.data();
+		records.m_numPrototypeObjects = static_cast<int>(description.m_prototypeObjects.size());
+		records.m_pMeshFiles = &description.m_meshFiles;
+		return records;
+	}
+}
+
+#endif
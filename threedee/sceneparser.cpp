@@ -0,0 +1,261 @@
+#include "sceneparser.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include "gtfm.hpp"
+#include "linereader.hpp"
+
+// constructor
+RT::sceneparser::sceneparser() {
+	m_lineNumber = 0;
+	m_nextToken = 0;
+	m_currentPrototype = -1;
+	m_prototypeLine = 0;
+}
+
+// function to parse a scene file
+void RT::sceneparser::parse(const std::string& fileName, RT::scenedescription& description) {
+	m_fileName = fileName;
+	m_lineNumber = 0;
+	m_materialNames.clear();
+	m_meshFiles.clear();
+	m_prototypeNames.clear();
+	m_currentPrototype = -1;
+	size_t separator = fileName.find_last_of("/\\");
+	m_directory = (separator == std::string::npos) ? std::string() : fileName.substr(0, separator + 1);
+	description = RT::scenedescription();
+	RT::linereader reader;
+	if (!reader.open(fileName)) throw std::runtime_error("cannot open scene file " + fileName);
+	while (char* line = reader.nextLine()) {
+		m_lineNumber = reader.getLineNumber();
+		parseLine(line, description);
+	}
+	if (m_currentPrototype >= 0) {
+		m_lineNumber = m_prototypeLine;
+		fail("definition is not closed with end");
+	}
+}
+
+// function to parse one line
+void RT::sceneparser::parseLine(char* line, RT::scenedescription& description) {
+	// cut off any comment
+	char* pComment = std::strchr(line, '#');
+	if (pComment != nullptr) *pComment = '\0';
+	// split the line into tokens, ending each one in place
+	m_tokens.clear();
+	m_nextToken = 0;
+	char* pChar = line;
+	while (true) {
+		while ((*pChar == ' ') || (*pChar == '\t') || (*pChar == '\r')) pChar++;
+		if (*pChar == '\0') break;
+		m_tokens.push_back(pChar);
+		while ((*pChar != '\0') && (*pChar != ' ') && (*pChar != '\t') && (*pChar != '\r')) pChar++;
+		if (*pChar == '\0') break;
+		*pChar++ = '\0';
+	}
+	if (!hasToken()) return;
+	std::string keyword = nextWord("a keyword");
+	if (keyword == "camera") parseCamera(description.m_camera);
+	else if (keyword == "material") parseMaterial(description);
+	else if (keyword == "sphere") parseObject(RT::OBJECT_SPHERE, description);
+	else if (keyword == "plane") parseObject(RT::OBJECT_PLANE, description);
+	else if (keyword == "mesh") parseObject(RT::OBJECT_MESH, description);
+	else if (keyword == "instance") parseObject(RT::OBJECT_INSTANCE, description);
+	else if (keyword == "define") parseDefine(description);
+	else if (keyword == "end") parseEnd(description);
+	else if (keyword == "pointlight") parsePointLight(description);
+	else fail("unknown keyword '" + keyword + "'");
+}
+
+// function to parse the camera
+void RT::sceneparser::parseCamera(RT::cameradesc& camera) {
+	while (hasToken()) {
+		std::string option = nextWord("a camera option");
+		if (option == "position") nextNumbers(camera.m_position, 3, "the camera position");
+		else if (option == "lookat") nextNumbers(camera.m_lookAt, 3, "the camera look at point");
+		else if (option == "up") nextNumbers(camera.m_up, 3, "the camera up vector");
+		else if (option == "length") camera.m_length = nextNumber("the camera length");
+		else if (option == "horzsize") camera.m_horzSize = nextNumber("the camera horizontal size");
+		else if (option == "aspect") camera.m_aspect = nextNumber("the camera aspect ratio");
+		else if (option == "aperture") camera.m_aperture = nextNumber("the camera aperture");
+		else if (option == "focus") camera.m_focusDistance = nextNumber("the camera focus distance");
+		else if (option == "shutter") nextNumbers(camera.m_shutter, 2, "the shutter open and close times");
+		else fail("unknown camera option '" + option + "'");
+	}
+}
+
+// function to parse a material
+void RT::sceneparser::parseMaterial(RT::scenedescription& description) {
+	std::string name = nextWord("a material name");
+	if (m_materialNames.count(name) != 0) fail("material '" + name + "' is already defined");
+	RT::materialdesc material;
+	while (hasToken()) {
+		std::string option = nextWord("a material option");
+		if (option == "color") nextNumbers(material.m_baseColor, 3, "the material color");
+		else if (option == "reflectivity") material.m_reflectivity = nextNumber("the material reflectivity");
+		else if (option == "shininess") material.m_shininess = nextNumber("the material shininess");
+		else fail("unknown material option '" + option + "'");
+	}
+	m_materialNames[name] = static_cast<int>(description.m_materials.size());
+	description.m_materials.push_back(material);
+}
+
+// function to parse an object
+void RT::sceneparser::parseObject(RT::objecttype type, RT::scenedescription& description) {
+	RT::objectdesc object;
+	object.m_type = type;
+	if (type == RT::OBJECT_MESH) {
+		std::string meshFile = nextWord("an OBJ file name");
+		// relative names are relative to the scene file
+		bool absolute = (meshFile[0] == '/') || (meshFile[0] == '\\') || ((meshFile.size() > 1) && (meshFile[1] == ':'));
+		if (!absolute) meshFile = m_directory + meshFile;
+		auto mesh = m_meshFiles.find(meshFile);
+		if (mesh == m_meshFiles.end()) {
+			mesh = m_meshFiles.emplace(meshFile, static_cast<int>(description.m_meshFiles.size())).first;
+			description.m_meshFiles.push_back(meshFile);
+		}
+		object.m_mesh = mesh->second;
+	}
+	else if (type == RT::OBJECT_INSTANCE) {
+		if (m_currentPrototype >= 0) fail("instances can't be used inside a definition");
+		std::string name = nextWord("a definition name");
+		auto prototype = m_prototypeNames.find(name);
+		if (prototype == m_prototypeNames.end()) fail("definition '" + name + "' is not defined");
+		object.m_prototype = prototype->second;
+	}
+	// the transform at time 0, and at time 1 for an object that moves (options after "motion" set the end transform, starting from the one before it)
+	double translation[2][3] = { { 0.0, 0.0, 0.0 } };
+	double rotation[2][3] = { { 0.0, 0.0, 0.0 } };
+	double scale[2][3] = { { 1.0, 1.0, 1.0 } };
+	int part = 0;
+	while (hasToken()) {
+		std::string option = nextWord("an object option");
+		if (option == "translate") nextNumbers(translation[part], 3, "the translation");
+		else if (option == "rotate") nextNumbers(rotation[part], 3, "the rotation");
+		else if (option == "scale") nextNumbers(scale[part], 3, "the scale");
+		else if (option == "motion") {
+			if (part != 0) fail("motion is given more than once");
+			part = 1;
+			for (int i = 0; i < 3; i++) {
+				translation[1][i] = translation[0][i];
+				rotation[1][i] = rotation[0][i];
+				scale[1][i] = scale[0][i];
+			}
+		}
+		else if ((m_currentPrototype >= 0) && ((option == "color") || (option == "material"))) fail("objects in a definition take their " + option + " from each instance");
+		else if (option == "color") nextNumbers(object.m_baseColor, 3, "the object color");
+		else if (option == "material") {
+			std::string name = nextWord("a material name");
+			auto material = m_materialNames.find(name);
+			if (material == m_materialNames.end()) fail("material '" + name + "' is not defined");
+			object.m_material = material->second;
+		}
+		else fail("unknown object option '" + option + "'");
+	}
+	// compute the transform now, so that loading the scene (and the cache) doesn't have to invert anything
+	storeTransform(translation[0], rotation[0], scale[0], "the object transform is singular", object.m_fwdtfm, object.m_bcktfm);
+	if (part == 1) {
+		// the scale is interpolated linearly, so it would pass through 0 if it changed sign
+		for (int i = 0; i < 3; i++) {
+			if (((scale[0][i] > 0.0) != (scale[1][i] > 0.0)) || (scale[1][i] == 0.0)) fail("the scale can't change sign or reach 0 during the motion");
+		}
+		object.m_moving = 1;
+	}
+	else {
+		for (int i = 0; i < 3; i++) {
+			translation[1][i] = translation[0][i];
+			rotation[1][i] = rotation[0][i];
+			scale[1][i] = scale[0][i];
+		}
+	}
+	std::memcpy(object.m_motionTranslation, translation, sizeof(translation));
+	std::memcpy(object.m_motionRotation, rotation, sizeof(rotation));
+	std::memcpy(object.m_motionScale, scale, sizeof(scale));
+	// objects in a definition belong to its prototype
+	if (m_currentPrototype >= 0) {
+		description.m_prototypeObjects.push_back(object);
+		description.m_prototypes[m_currentPrototype].m_numObjects++;
+	}
+	else description.m_objects.push_back(object);
+}
+
+// function to compute a transform and store the top three rows of it and its inverse
+void RT::sceneparser::storeTransform(const double* translation, const double* rotation, const double* scale, const char* singularMessage, double* fwdtfm, double* bcktfm) const {
+	RT::GTform transformMatrix;
+	try {
+		transformMatrix.setTransform(Vec3::fromArray(translation), Vec3::fromArray(rotation), Vec3::fromArray(scale));
+	}
+	catch (const std::invalid_argument&) {
+		fail(singularMessage);
+	}
+	Affine4 forward = transformMatrix.getForward();
+	Affine4 backward = transformMatrix.getBackward();
+	for (int row = 0; row < 3; row++) {
+		for (int col = 0; col < 4; col++) {
+			fwdtfm[(row * 4) + col] = forward.getElement(row, col);
+			bcktfm[(row * 4) + col] = backward.getElement(row, col);
+		}
+	}
+}
+
+// function to start a definition
+void RT::sceneparser::parseDefine(RT::scenedescription& description) {
+	if (m_currentPrototype >= 0) fail("definitions can't be nested");
+	std::string name = nextWord("a definition name");
+	if (m_prototypeNames.count(name) != 0) fail("definition '" + name + "' is already defined");
+	if (hasToken()) fail("unexpected '" + std::string(nextWord("")) + "' after the definition name");
+	m_currentPrototype = static_cast<int>(description.m_prototypes.size());
+	m_prototypeLine = m_lineNumber;
+	m_prototypeNames[name] = m_currentPrototype;
+	RT::prototypedesc prototype;
+	prototype.m_firstObject = static_cast<int>(description.m_prototypeObjects.size());
+	description.m_prototypes.push_back(prototype);
+}
+
+// function to end a definition
+void RT::sceneparser::parseEnd(RT::scenedescription& description) {
+	if (m_currentPrototype < 0) fail("end without define");
+	if (hasToken()) fail("unexpected '" + std::string(nextWord("")) + "' after end");
+	if (description.m_prototypes[m_currentPrototype].m_numObjects == 0) fail("definition has no objects");
+	m_currentPrototype = -1;
+}
+
+// function to parse a point light
+void RT::sceneparser::parsePointLight(RT::scenedescription& description) {
+	RT::lightdesc light;
+	while (hasToken()) {
+		std::string option = nextWord("a light option");
+		if (option == "position") nextNumbers(light.m_location, 3, "the light position");
+		else if (option == "color") nextNumbers(light.m_color, 3, "the light color");
+		else if (option == "intensity") light.m_intensity = nextNumber("the light intensity");
+		else fail("unknown light option '" + option + "'");
+	}
+	description.m_lights.push_back(light);
+}
+
+// functions to read the next token on the line
+bool RT::sceneparser::hasToken() const {
+	return m_nextToken < m_tokens.size();
+}
+
+const char* RT::sceneparser::nextWord(const char* expected) {
+	if (!hasToken()) fail(std::string("expected ") + expected);
+	return m_tokens[m_nextToken++];
+}
+
+double RT::sceneparser::nextNumber(const char* expected) {
+	const char* token = nextWord(expected);
+	char* end = nullptr;
+	double value = std::strtod(token, &end);
+	if ((end == token) || (*end != '\0')) fail(std::string("expected a number for ") + expected + ", found '" + token + "'");
+	return value;
+}
+
+void RT::sceneparser::nextNumbers(double* values, int count, const char* expected) {
+	for (int i = 0; i < count; i++) values[i] = nextNumber(expected);
+}
+
+// function to throw an error for the current line
+void RT::sceneparser::fail(const std::string& message) const {
+	throw std::runtime_error(m_fileName + ":" + std::to_string(m_lineNumber) + ": " + message);
+}
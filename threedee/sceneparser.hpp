@@ -0,0 +1,71 @@
+#ifndef SCENEPARSER_H
+#define SCENEPARSER_H
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "scenedescription.hpp"
+
+namespace RT {
+	// streaming parser for the text scene format
+	// the file is read through a linereader and parsed a line at a time, so memory use doesn't grow with the size of the file
+	//
+	// one statement per line, '#' starts a comment, the options after the keyword can come in any order:
+	//   camera [position x y z] [lookat x y z] [up x y z] [length l] [horzsize h] [aspect a] [aperture r] [focus d] [shutter open close]
+	//   material <name> [color r g b] [reflectivity r] [shininess s]
+	//   sphere|plane [translate x y z] [rotate x y z] [scale x y z] [color r g b] [material <name>] [motion [translate x y z] [rotate x y z] [scale x y z]]
+	//   mesh <file.obj> [translate x y z] [rotate x y z] [scale x y z] [color r g b] [material <name>] [motion ...]
+	//   define <name>, followed by objects (without color or material), then end
+	//   instance <name> [translate x y z] [rotate x y z] [scale x y z] [color r g b] [material <name>] [motion ...]
+	//   pointlight [position x y z] [color r g b] [intensity i]
+	// rotations are in radians and applied as in GTform::setTransform, materials must be defined before they are used
+	// an object with motion moves from its transform at time 0 to the one at time 1, made of the transform before "motion" changed by the options after it
+	// (the translation, rotation and scale are each interpolated linearly in between, so the scale can't change sign)
+	// (the camera's shutter interval is on the same scale, and the camera has a pinhole and its shutter at time 0 unless it is given an aperture or a shutter interval)
+	// mesh file names are relative to the directory of the scene file
+	// a definition is shared geometry: every instance places all of its objects with one transform, color and material
+	class sceneparser {
+		public:
+			// constructor
+			sceneparser();
+			// function to parse a scene file, throws std::runtime_error (with the file name and line number) on failure
+			void parse(const std::string& fileName, RT::scenedescription& description);
+		private:
+			// function to parse one line (modified in place)
+			void parseLine(char* line, RT::scenedescription& description);
+			// functions to parse each kind of statement
+			void parseCamera(RT::cameradesc& camera);
+			void parseMaterial(RT::scenedescription& description);
+			void parseObject(RT::objecttype type, RT::scenedescription& description);
+			void parseDefine(RT::scenedescription& description);
+			void parseEnd(RT::scenedescription& description);
+			void parsePointLight(RT::scenedescription& description);
+			// function to compute a transform from its parts and store the top three rows of it and its inverse, fails with singularMessage if it can't be inverted
+			void storeTransform(const double* translation, const double* rotation, const double* scale, const char* singularMessage, double* fwdtfm, double* bcktfm) const;
+			// functions to read the next token on the line
+			bool hasToken() const;
+			const char* nextWord(const char* expected);
+			double nextNumber(const char* expected);
+			void nextNumbers(double* values, int count, const char* expected);
+			// function to throw an error for the current line
+			[[noreturn]] void fail(const std::string& message) const;
+			// the file being parsed and the current line number
+			std::string m_fileName;
+			long long m_lineNumber;
+			// the tokens on the current line (null terminated in place in the line)
+			std::vector<char*> m_tokens;
+			size_t m_nextToken;
+			// material names and their index in the description
+			std::unordered_map<std::string, int> m_materialNames;
+			// prototype names and their index in the description
+			std::unordered_map<std::string, int> m_prototypeNames;
+			// the prototype being defined (-1 outside a definition), and the line it started on
+			int m_currentPrototype;
+			long long m_prototypeLine;
+			// mesh files and their index in the description
+			std::unordered_map<std::string, int> m_meshFiles;
+			// the directory of the scene file (with a trailing separator), for mesh file names
+			std::string m_directory;
+	};
+}
+
+#endif
@@ -0,0 +1,64 @@
+#include "sdldisplay.hpp"
+
+// default constructor
+sdldisplay::sdldisplay() {
+	m_xSize = 0;
+	m_ySize = 0;
+	m_pRenderer = NULL;
+	m_pTexture = NULL;
+}
+
+// destructor
+sdldisplay::~sdldisplay() {
+	// destroy only if it hasn't been destroyed yet
+	if (m_pTexture != NULL) SDL_DestroyTexture(m_pTexture);
+}
+
+// function to initialize
+void sdldisplay::initialize(const int xSize, const int ySize, SDL_Renderer* pRenderer) {
+	// store dimensions
+	m_xSize = xSize;
+	m_ySize = ySize;
+	// store the pointer to the renderer
+	m_pRenderer = pRenderer;
+	// initialize the texture
+	initTexture();
+}
+
+// function to generate the display
+void sdldisplay::display(image& inputImage, RT::threadpool* pThreadPool) {
+	// convert the image straight into the memory of the texture
+	void* pPixels;
+	int pitch;
+	if (SDL_LockTexture(m_pTexture, NULL, &pPixels, &pitch) != 0) return;
+	// the texture holds packed 32 bit pixels, which are BGRA in memory on little endian machines and RGBA on big endian ones
+	#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+		inputImage.convertTo8Bit(static_cast<unsigned char*>(pPixels), pitch, image::LAYOUT_RGBA8, pThreadPool);
+	#else
+		inputImage.convertTo8Bit(static_cast<unsigned char*>(pPixels), pitch, image::LAYOUT_BGRA8, pThreadPool);
+	#endif
+	SDL_UnlockTexture(m_pTexture);
+	// copy the texture to the renderer
+	SDL_Rect srcRect, bounds;
+	srcRect.x = 0;
+	srcRect.y = 0;
+	srcRect.w = m_xSize;
+	srcRect.h = m_ySize;
+	bounds = srcRect;
+	SDL_RenderCopy(m_pRenderer, m_pTexture, &srcRect, &bounds);
+}
+
+// function to initialize the texture
+void sdldisplay::initTexture() {
+	// delete any previously created texture
+	if (m_pTexture != NULL)
+		SDL_DestroyTexture(m_pTexture);
+	// create a streaming texture, so that it can be locked and written to directly
+	// packed as 0xAARRGGBB on little endian machines and 0xRRGGBBAA on big endian ones
+	#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+		Uint32 pixelFormat = SDL_PIXELFORMAT_RGBA8888;
+	#else
+		Uint32 pixelFormat = SDL_PIXELFORMAT_ARGB8888;
+	#endif
+	m_pTexture = SDL_CreateTexture(m_pRenderer, pixelFormat, SDL_TEXTUREACCESS_STREAMING, m_xSize, m_ySize);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#ifndef SDLDISPLAY_H
+#define SDLDISPLAY_H
+#include <SDL.h>
+#include "image.hpp"
+#include "threadpool.hpp"
+
+// shows an image in an SDL window (only used by the viewer, the renderer itself doesn't need SDL)
+class sdldisplay {
+public:
+	// constructor
+	sdldisplay();
+	// destructor
+	~sdldisplay();
+	// function to initialize
+	void initialize(const int xSize, const int ySize, SDL_Renderer* pRenderer);
+	// function to copy an image to the renderer (if a thread pool is given, the conversion is shared out between its threads)
+	void display(image& inputImage, RT::threadpool* pThreadPool = nullptr);
+
+private:
+	// SDL2 handling
+	void initTexture();
+	// store the dimensions of the texture
+	int m_xSize, m_ySize;
+	// SDL2 stuff
+	SDL_Renderer* m_pRenderer;
+	SDL_Texture* m_pTexture;
+};
+
+#endif
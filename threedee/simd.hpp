@@ -0,0 +1,171 @@
+#ifndef SIMD_H
+#define SIMD_H
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// pick the widest instruction set the compiler has been told it can use
+// (define RT_SIMD_SCALAR to force the portable fallback, e.g. to check results against it)
+#if !defined(RT_SIMD_SCALAR)
+#if defined(__AVX__)
+#define RT_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define RT_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+namespace RT {
+	// four doubles operated on together
+	// maps onto one AVX register, two SSE2 registers, or a plain array when neither is available
+	// comparisons return a mask with every bit of a lane set where the comparison holds, for use with select(), & and |
+	// min and max return their second argument when either argument is NaN (as the SSE/AVX instructions do)
+	class simd4d {
+		public:
+			// number of lanes
+			static constexpr int WIDTH = 4;
+			// constructors (the default leaves the lanes uninitialized)
+			simd4d() {}
+			explicit simd4d(double value);
+			// functions to load from and store to memory that is aligned to 32 bytes
+			static simd4d load(const double* data);
+			void store(double* data) const;
+			// function to return a bitmask with bit i set if lane i of a mask is set
+			int movemask() const;
+			// arithmetic
+			friend simd4d operator+ (const simd4d& lhs, const simd4d& rhs);
+			friend simd4d operator- (const simd4d& lhs, const simd4d& rhs);
+			friend simd4d operator* (const simd4d& lhs, const simd4d& rhs);
+			friend simd4d operator/ (const simd4d& lhs, const simd4d& rhs);
+			// math functions (static members, so that they don't hide the standard ones for doubles)
+			static simd4d sqrt(const simd4d& value);
+			static simd4d abs(const simd4d& value);
+			static simd4d min(const simd4d& lhs, const simd4d& rhs);
+			static simd4d max(const simd4d& lhs, const simd4d& rhs);
+			// comparisons (false for NaN)
+			friend simd4d operator< (const simd4d& lhs, const simd4d& rhs);
+			friend simd4d operator<= (const simd4d& lhs, const simd4d& rhs);
+			friend simd4d operator> (const simd4d& lhs, const simd4d& rhs);
+			friend simd4d operator>= (const simd4d& lhs, const simd4d& rhs);
+			// bitwise operations on masks
+			friend simd4d operator& (const simd4d& lhs, const simd4d& rhs);
+			friend simd4d operator| (const simd4d& lhs, const simd4d& rhs);
+			// function to pick lanes from ifTrue where the mask is set and from ifFalse elsewhere
+			static simd4d select(const simd4d& mask, const simd4d& ifTrue, const simd4d& ifFalse);
+		private:
+#if defined(RT_SIMD_AVX)
+			simd4d(__m256d v) : m_v(v) {}
+			__m256d m_v;
+#elif defined(RT_SIMD_SSE2)
+			simd4d(__m128d lo, __m128d hi) : m_lo(lo), m_hi(hi) {}
+			__m128d m_lo;
+			__m128d m_hi;
+#else
+			// function to build a mask lane
+			static double maskLane(bool value);
+			double m_v[4];
+#endif
+	};
+
+#if defined(RT_SIMD_AVX)
+	inline simd4d::simd4d(double value) : m_v(_mm256_set1_pd(value)) {}
+	inline simd4d simd4d::load(const double* data) { return simd4d(_mm256_load_pd(data)); }
+	inline void simd4d::store(double* data) const { _mm256_store_pd(data, m_v); }
+	inline int simd4d::movemask() const { return _mm256_movemask_pd(m_v); }
+	inline simd4d operator+ (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_add_pd(lhs.m_v, rhs.m_v)); }
+	inline simd4d operator- (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_sub_pd(lhs.m_v, rhs.m_v)); }
+	inline simd4d operator* (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_mul_pd(lhs.m_v, rhs.m_v)); }
+	inline simd4d operator/ (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_div_pd(lhs.m_v, rhs.m_v)); }
+	inline simd4d simd4d::sqrt(const simd4d& value) { return simd4d(_mm256_sqrt_pd(value.m_v)); }
+	inline simd4d simd4d::abs(const simd4d& value) { return simd4d(_mm256_andnot_pd(_mm256_set1_pd(-0.0), value.m_v)); }
+	inline simd4d simd4d::min(const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_min_pd(lhs.m_v, rhs.m_v)); }
+	inline simd4d simd4d::max(const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_max_pd(lhs.m_v, rhs.m_v)); }
+	inline simd4d operator< (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_cmp_pd(lhs.m_v, rhs.m_v, _CMP_LT_OQ)); }
+	inline simd4d operator<= (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_cmp_pd(lhs.m_v, rhs.m_v, _CMP_LE_OQ)); }
+	inline simd4d operator> (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_cmp_pd(lhs.m_v, rhs.m_v, _CMP_GT_OQ)); }
+	inline simd4d operator>= (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_cmp_pd(lhs.m_v, rhs.m_v, _CMP_GE_OQ)); }
+	inline simd4d operator& (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_and_pd(lhs.m_v, rhs.m_v)); }
+	inline simd4d operator| (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm256_or_pd(lhs.m_v, rhs.m_v)); }
+	inline simd4d simd4d::select(const simd4d& mask, const simd4d& ifTrue, const simd4d& ifFalse) { return simd4d(_mm256_blendv_pd(ifFalse.m_v, ifTrue.m_v, mask.m_v)); }
+#elif defined(RT_SIMD_SSE2)
+	inline simd4d::simd4d(double value) : m_lo(_mm_set1_pd(value)), m_hi(_mm_set1_pd(value)) {}
+	inline simd4d simd4d::load(const double* data) { return simd4d(_mm_load_pd(data), _mm_load_pd(data + 2)); }
+	inline void simd4d::store(double* data) const { _mm_store_pd(data, m_lo); _mm_store_pd(data + 2, m_hi); }
+	inline int simd4d::movemask() const { return _mm_movemask_pd(m_lo) | (_mm_movemask_pd(m_hi) << 2); }
+	inline simd4d operator+ (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_add_pd(lhs.m_lo, rhs.m_lo), _mm_add_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d operator- (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_sub_pd(lhs.m_lo, rhs.m_lo), _mm_sub_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d operator* (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_mul_pd(lhs.m_lo, rhs.m_lo), _mm_mul_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d operator/ (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_div_pd(lhs.m_lo, rhs.m_lo), _mm_div_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d simd4d::sqrt(const simd4d& value) { return simd4d(_mm_sqrt_pd(value.m_lo), _mm_sqrt_pd(value.m_hi)); }
+	inline simd4d simd4d::abs(const simd4d& value) { __m128d sign = _mm_set1_pd(-0.0); return simd4d(_mm_andnot_pd(sign, value.m_lo), _mm_andnot_pd(sign, value.m_hi)); }
+	inline simd4d simd4d::min(const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_min_pd(lhs.m_lo, rhs.m_lo), _mm_min_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d simd4d::max(const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_max_pd(lhs.m_lo, rhs.m_lo), _mm_max_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d operator< (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_cmplt_pd(lhs.m_lo, rhs.m_lo), _mm_cmplt_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d operator<= (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_cmple_pd(lhs.m_lo, rhs.m_lo), _mm_cmple_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d operator> (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_cmpgt_pd(lhs.m_lo, rhs.m_lo), _mm_cmpgt_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d operator>= (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_cmpge_pd(lhs.m_lo, rhs.m_lo), _mm_cmpge_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d operator& (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_and_pd(lhs.m_lo, rhs.m_lo), _mm_and_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d operator| (const simd4d& lhs, const simd4d& rhs) { return simd4d(_mm_or_pd(lhs.m_lo, rhs.m_lo), _mm_or_pd(lhs.m_hi, rhs.m_hi)); }
+	inline simd4d simd4d::select(const simd4d& mask, const simd4d& ifTrue, const simd4d& ifFalse) {
+		// SSE2 has no blend instruction, so combine (mask & ifTrue) | (~mask & ifFalse)
+		return simd4d(_mm_or_pd(_mm_and_pd(mask.m_lo, ifTrue.m_lo), _mm_andnot_pd(mask.m_lo, ifFalse.m_lo)), _mm_or_pd(_mm_and_pd(mask.m_hi, ifTrue.m_hi), _mm_andnot_pd(mask.m_hi, ifFalse.m_hi)));
+	}
+#else
+	inline double simd4d::maskLane(bool value) {
+		uint64_t bits = value ? ~static_cast<uint64_t>(0) : 0;
+		double lane;
+		std::memcpy(&lane, &bits, sizeof(lane));
+		return lane;
+	}
+	inline simd4d::simd4d(double value) { for (int i = 0; i < 4; i++) m_v[i] = value; }
+	inline simd4d simd4d::load(const double* data) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = data[i]; return result; }
+	inline void simd4d::store(double* data) const { for (int i = 0; i < 4; i++) data[i] = m_v[i]; }
+	inline int simd4d::movemask() const {
+		int result = 0;
+		for (int i = 0; i < 4; i++) result |= (std::signbit(m_v[i]) ? 1 : 0) << i;
+		return result;
+	}
+	inline simd4d operator+ (const simd4d& lhs, const simd4d& rhs) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = lhs.m_v[i] + rhs.m_v[i]; return result; }
+	inline simd4d operator- (const simd4d& lhs, const simd4d& rhs) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = lhs.m_v[i] - rhs.m_v[i]; return result; }
+	inline simd4d operator* (const simd4d& lhs, const simd4d& rhs) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = lhs.m_v[i] * rhs.m_v[i]; return result; }
+	inline simd4d operator/ (const simd4d& lhs, const simd4d& rhs) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = lhs.m_v[i] / rhs.m_v[i]; return result; }
+	inline simd4d simd4d::sqrt(const simd4d& value) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = std::sqrt(value.m_v[i]); return result; }
+	inline simd4d simd4d::abs(const simd4d& value) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = std::fabs(value.m_v[i]); return result; }
+	inline simd4d simd4d::min(const simd4d& lhs, const simd4d& rhs) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = (lhs.m_v[i] < rhs.m_v[i]) ? lhs.m_v[i] : rhs.m_v[i]; return result; }
+	inline simd4d simd4d::max(const simd4d& lhs, const simd4d& rhs) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = (lhs.m_v[i] > rhs.m_v[i]) ? lhs.m_v[i] : rhs.m_v[i]; return result; }
+	inline simd4d operator< (const simd4d& lhs, const simd4d& rhs) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = simd4d::maskLane(lhs.m_v[i] < rhs.m_v[i]); return result; }
+	inline simd4d operator<= (const simd4d& lhs, const simd4d& rhs) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = simd4d::maskLane(lhs.m_v[i] <= rhs.m_v[i]); return result; }
+	inline simd4d operator> (const simd4d& lhs, const simd4d& rhs) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = simd4d::maskLane(lhs.m_v[i] > rhs.m_v[i]); return result; }
+	inline simd4d operator>= (const simd4d& lhs, const simd4d& rhs) { simd4d result; for (int i = 0; i < 4; i++) result.m_v[i] = simd4d::maskLane(lhs.m_v[i] >= rhs.m_v[i]); return result; }
+	inline simd4d operator& (const simd4d& lhs, const simd4d& rhs) {
+		simd4d result;
+		for (int i = 0; i < 4; i++) {
+			uint64_t a, b;
+			std::memcpy(&a, &lhs.m_v[i], sizeof(a));
+			std::memcpy(&b, &rhs.m_v[i], sizeof(b));
+			a &= b;
+			std::memcpy(&result.m_v[i], &a, sizeof(a));
+		}
+		return result;
+	}
+	inline simd4d operator| (const simd4d& lhs, const simd4d& rhs) {
+		simd4d result;
+		for (int i = 0; i < 4; i++) {
+			uint64_t a, b;
+			std::memcpy(&a, &lhs.m_v[i], sizeof(a));
+			std::memcpy(&b, &rhs.m_v[i], sizeof(b));
+			a |= b;
+			std::memcpy(&result.m_v[i], &a, sizeof(a));
+		}
+		return result;
+	}
+	inline simd4d simd4d::select(const simd4d& mask, const simd4d& ifTrue, const simd4d& ifFalse) {
+		simd4d result;
+		for (int i = 0; i < 4; i++) result.m_v[i] = std::signbit(mask.m_v[i]) ? ifTrue.m_v[i] : ifFalse.m_v[i];
+		return result;
+	}
+#endif
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "simplematerial.hpp"
+#include "renderstats.hpp"
 
 RT::simplematerial::simplematerial() {
 
@@ -9,64 +10,40 @@ RT::simplematerial::~simplematerial() {
 }
 
 // function to return the color
-vector<double> RT::simplematerial::computeColor(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const vector<double>& intPoint, const vector<double>& localNormal, const RT::ray& cameraRay) {
+Vec3 RT::simplematerial::computeColor(const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& cameraRay, const RT::pathstate& pathState) {
 	// define the initial material colors
-	vector<double> matColor{ 3 };
-	vector<double> refColor{ 3 };
-	vector<double> difColor{ 3 };
-	vector<double> spcColor{ 3 };
+	RT_STAT_PHASE(PHASE_SHADE);
+	Vec3 matColor;
+	Vec3 refColor;
+	Vec3 difColor;
+	Vec3 spcColor;
 	// compute the diffuse component
-	difColor = computeDiffuseColor(objectList, lightList, currentObject, intPoint, localNormal, m_baseColor);
+	difColor = computeDiffuseColor(objectBVH, lightList, currentObject, intPoint, localNormal, m_baseColor, cameraRay.m_time);
 	// compute the reflection component
-	if (m_reflectivity > 0.0) refColor = computeReflectionColor(objectList, lightList, currentObject, intPoint, localNormal, cameraRay);
-	// combine reflection and diffuse components
-	matColor = (refColor * m_reflectivity) + (difColor * (1 - m_reflectivity));
+	if (m_reflectivity > 0.0) refColor = computeReflectionColor(objectBVH, lightList, currentObject, intPoint, localNormal, cameraRay, pathState.bounce(m_reflectivity));
 	// compute the specular component
-	if (m_shininess > 0.0) spcColor = computeSpecular(objectList, lightList, intPoint, localNormal, cameraRay);
-	// add the specular component to the final color
-	matColor = matColor + spcColor;
+	if (m_shininess > 0.0) spcColor = computeSpecular(objectBVH, lightList, intPoint, localNormal, cameraRay);
+	// combine the components into the final color
+	matColor = combineColor(difColor, refColor, spcColor);
 	return matColor;
 }
 
 // function to compute the specular highlights
-vector<double> RT::simplematerial::computeSpecular(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const vector<double>& intPoint, const vector<double>& localNormal, const RT::ray& cameraRay) {
-	vector<double> spcColor{ 3 };
-	double red = 0.0;
-	double green = 0.0;
-	double blue = 0.0;
+Vec3 RT::simplematerial::computeSpecular(const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& cameraRay) {
+	Vec3 spcColor;
+	RT::real red = 0.0;
+	RT::real green = 0.0;
+	RT::real blue = 0.0;
 	// loop through all of the lights in the scene
-	for (auto currentLight : lightList) {
-		// check for intersections with all objects in the scene
-		double intensity = 0.0;
-		// construct a vector pointing from the intersection point to the light
-		vector<double> lightDir = (currentLight->m_location - intPoint).normalized();
-		// compute a start point
-		vector<double> startPoint = intPoint + (lightDir * 0.001);
-		// construct a ray from the point of intersection to the light 
-		RT::ray lightRay(startPoint, startPoint + lightDir);
-		// loop though all objects in the scene to check if any obstruct light from this source
-		vector<double> poi{ 3 };
-		vector<double> poiNormal{ 3 };
-		vector<double> poiColor{ 3 };
-		bool validInt = false;
-		for (auto sceneObject : objectList) {
-			validInt = sceneObject->testIntersections(lightRay, poi, poiNormal, poiColor);
-			if (validInt) break;
-		}
-		// if no intersections were found, then proceed with computing the specular component
-		if (!validInt) {
-			// compute the reflection vector
-			vector<double> d = lightRay.m_lab;
-			vector<double> r = d - (2 * vector<double>::dot(d, localNormal) * localNormal);
-			r.normalize();
-			// compute the dot product
-			vector<double> v = cameraRay.m_lab;
-			v.normalize();
-			double dotProduct = vector<double>::dot(r, v);
-			// only proceed if the dot product is positive
-			if (dotProduct > 0.0) {
-				intensity = m_reflectivity * std::pow(dotProduct, m_shininess);
-			}
+	for (const std::shared_ptr<RT::lightbase>& currentLight : lightList) {
+		// compute the highlight and the ray from the point of intersection to the light
+		RT::ray lightRay;
+		RT::real intensity = computeSpecularIntensity(*currentLight, intPoint, localNormal, cameraRay, lightRay);
+		// check whether any object between the point and the light (t < 1) obstructs light from this source
+		if (intensity != 0.0) {
+			RT_STAT_COUNT(STAT_SHADOW_RAYS);
+			RT_STAT_PHASE(PHASE_TRACE);
+			if (objectBVH.occluded(lightRay, 1.0, nullptr)) intensity = 0.0;
 		}
 		red += currentLight->m_color.getElement(0) * intensity;
 		green += currentLight->m_color.getElement(1) * intensity;
@@ -76,4 +53,43 @@ vector<double> RT::simplematerial::computeSpecular(const std::vector<std::shared
 	spcColor.setElement(1, green);
 	spcColor.setElement(2, blue);
 	return spcColor;
-}
\ No newline at end of file
+}
+
+// function to return the parts of the color
+RT::shadingterms RT::simplematerial::getShadingTerms() const {
+	RT::shadingterms terms;
+	terms.m_diffuse = true;
+	terms.m_baseColor = m_baseColor;
+	terms.m_specular = m_shininess > 0.0;
+	terms.m_reflectivity = m_reflectivity;
+	return terms;
+}
+
+// function to return the specular intensity from a light if nothing blocks it
+RT::real RT::simplematerial::computeSpecularIntensity(const RT::lightbase& light, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& cameraRay, RT::ray& lightRay) const {
+	// construct a vector pointing from the intersection point to the light
+	Vec3 lightDir = (light.m_location - intPoint).normalized();
+	// compute a start point
+	Vec3 startPoint = intPoint + (lightDir * 0.001);
+	// construct a ray from the point of intersection to the light
+	lightRay = RT::ray(startPoint, light.m_location);
+	lightRay.m_time = cameraRay.m_time;
+	// compute the reflection vector
+	Vec3 d = lightRay.m_lab;
+	Vec3 r = d - (2 * Vec3::dot(d, localNormal) * localNormal);
+	r.normalize();
+	// compute the dot product
+	Vec3 v = cameraRay.m_lab;
+	v.normalize();
+	RT::real dotProduct = Vec3::dot(r, v);
+	// only proceed if the dot product is positive
+	if (dotProduct > 0.0) return m_reflectivity * std::pow(dotProduct, m_shininess);
+	return 0.0;
+}
+
+// function to combine the parts of the color
+Vec3 RT::simplematerial::combineColor(const Vec3& difColor, const Vec3& refColor, const Vec3& spcColor) const {
+	// combine reflection and diffuse components, then add the specular component
+	Vec3 matColor = (refColor * m_reflectivity) + (difColor * (1 - m_reflectivity));
+	return matColor + spcColor;
+}
@@ -9,13 +9,17 @@ namespace RT {
 			simplematerial();
 			virtual ~simplematerial() override;
 			// function to return the color
-			virtual vector<double> computeColor(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const vector<double>& intPoint, const vector<double>& localNormal, const RT::ray& cameraRay) override;
+			virtual Vec3 computeColor(const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const std::shared_ptr<RT::objectbase>& currentObject, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& cameraRay, const RT::pathstate& pathState) override;
 			// function to compute specular highlights
-			vector<double> computeSpecular(const std::vector<std::shared_ptr<RT::objectbase>>& objectList, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const vector<double>& intPoint, const vector<double>& localNormal, const RT::ray& cameraRay);
+			Vec3 computeSpecular(const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& cameraRay);
+			// functions that split computeColor into its parts
+			virtual RT::shadingterms getShadingTerms() const override;
+			virtual real computeSpecularIntensity(const RT::lightbase& light, const Vec3& intPoint, const Vec3& localNormal, const RT::ray& cameraRay, RT::ray& lightRay) const override;
+			virtual Vec3 combineColor(const Vec3& difColor, const Vec3& refColor, const Vec3& spcColor) const override;
 			// variables
-			vector<double> m_baseColor{ std::vector<double> {1.0, 0.0, 1.0} };
-			double m_reflectivity = 0.0;
-			double m_shininess = 0.0;
+			Vec3 m_baseColor{ 1.0, 0.0, 1.0 };
+			real m_reflectivity = 0.0;
+			real m_shininess = 0.0;
 	};
 }
 
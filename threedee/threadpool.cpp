@@ -0,0 +1,101 @@
+#include "threadpool.hpp"
+
+// constructor, starts the worker threads
+RT::threadpool::threadpool(int numThreads) {
+	if (numThreads <= 0) numThreads = static_cast<int>(std::thread::hardware_concurrency());
+	if (numThreads <= 0) numThreads = 1;
+	m_pTask = nullptr;
+	m_generation = 0;
+	m_activeWorkers = 0;
+	m_shutdown = false;
+	for (int i = 0; i < numThreads; i++) m_queues.push_back(std::unique_ptr<workqueue>(new workqueue()));
+	for (int i = 0; i < numThreads; i++) m_threads.push_back(std::thread(&RT::threadpool::workerLoop, this, i));
+}
+
+// destructor, stops and joins the worker threads
+RT::threadpool::~threadpool() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_startCondition.notify_all();
+	for (auto& worker : m_threads) worker.join();
+}
+
+// function to return the number of worker threads
+int RT::threadpool::getNumThreads() const {
+	return static_cast<int>(m_threads.size());
+}
+
+// function to run a batch of tasks
+void RT::threadpool::parallelFor(int numTasks, const std::function<void(int, int)>& task) {
+	if (numTasks <= 0) return;
+	// hand each worker a contiguous block of tasks, neighbouring tasks tend to touch the same data
+	int numThreads = getNumThreads();
+	for (int i = 0; i < numThreads; i++) {
+		std::lock_guard<std::mutex> lock(m_queues[i]->m_mutex);
+		int firstTask = static_cast<int>((static_cast<long long>(numTasks) * i) / numThreads);
+		int lastTask = static_cast<int>((static_cast<long long>(numTasks) * (i + 1)) / numThreads);
+		for (int taskIndex = firstTask; taskIndex < lastTask; taskIndex++) m_queues[i]->m_tasks.push_back(taskIndex);
+	}
+	// wake the workers and wait for them to run out of work
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_pTask = &task;
+	m_activeWorkers = numThreads;
+	m_generation++;
+	m_startCondition.notify_all();
+	m_doneCondition.wait(lock, [this] { return m_activeWorkers == 0; });
+	m_pTask = nullptr;
+}
+
+// the function run by each worker thread
+void RT::threadpool::workerLoop(int threadIndex) {
+	int lastGeneration = 0;
+	while (true) {
+		const std::function<void(int, int)>* pTask;
+		{
+			// wait for a new batch (or for the pool to shut down)
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_startCondition.wait(lock, [this, lastGeneration] { return m_shutdown || (m_generation != lastGeneration); });
+			if (m_shutdown) return;
+			lastGeneration = m_generation;
+			pTask = m_pTask;
+		}
+		// run tasks until none are left anywhere
+		int taskIndex;
+		while (getTask(threadIndex, taskIndex)) (*pTask)(taskIndex, threadIndex);
+		// report that this worker has finished
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_activeWorkers--;
+			if (m_activeWorkers == 0) m_doneCondition.notify_all();
+		}
+	}
+}
+
+// function to fetch the next task for a worker
+bool RT::threadpool::getTask(int threadIndex, int& taskIndex) {
+	// take from the back of our own queue
+	{
+		workqueue& ownQueue = *m_queues[threadIndex];
+		std::lock_guard<std::mutex> lock(ownQueue.m_mutex);
+		if (!ownQueue.m_tasks.empty()) {
+			taskIndex = ownQueue.m_tasks.back();
+			ownQueue.m_tasks.pop_back();
+			return true;
+		}
+	}
+	// steal from the front of the other queues, starting with our neighbour
+	int numThreads = getNumThreads();
+	for (int offset = 1; offset < numThreads; offset++) {
+		workqueue& victimQueue = *m_queues[(threadIndex + offset) % numThreads];
+		std::lock_guard<std::mutex> lock(victimQueue.m_mutex);
+		if (!victimQueue.m_tasks.empty()) {
+			taskIndex = victimQueue.m_tasks.front();
+			victimQueue.m_tasks.pop_front();
+			return true;
+		}
+	}
+	// no work is ever added while a batch runs, so empty queues mean we're done
+	return false;
+}
@@ -0,0 +1,46 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace RT {
+	// fixed-size pool of worker threads that run a batch of indexed tasks
+	// each worker has its own queue, takes work from the back of it, and steals from the front of the others once it runs dry
+	class threadpool {
+		public:
+			// constructor and destructor (numThreads <= 0 uses one thread per hardware thread)
+			threadpool(int numThreads);
+			~threadpool();
+			// function to return the number of worker threads
+			int getNumThreads() const;
+			// function to run task(taskIndex, threadIndex) for every taskIndex in [0, numTasks), returns once all have finished
+			void parallelFor(int numTasks, const std::function<void(int, int)>& task);
+		private:
+			// a queue of task indices owned by one worker
+			struct workqueue {
+				std::mutex m_mutex;
+				std::deque<int> m_tasks;
+			};
+			// the function run by each worker thread
+			void workerLoop(int threadIndex);
+			// function to fetch the next task for a worker (own queue first, then stealing), returns false when there is no work left
+			bool getTask(int threadIndex, int& taskIndex);
+			std::vector<std::thread> m_threads;
+			std::vector<std::unique_ptr<workqueue>> m_queues;
+			// state shared between the caller and the workers
+			std::mutex m_mutex;
+			std::condition_variable m_startCondition;
+			std::condition_variable m_doneCondition;
+			const std::function<void(int, int)>* m_pTask;
+			int m_generation;
+			int m_activeWorkers;
+			bool m_shutdown;
+	};
+}
+
+#endif
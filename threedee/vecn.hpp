@@ -0,0 +1,234 @@
+#ifndef VECN_H
+#define VECN_H
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+#include "precision.hpp"
+
+// fixed-size vector with its dimension known at compile time
+// the elements live inline (no heap allocation), so temporaries on the hot path are free to create and copy
+template <class T, int N>
+class vecn {
+	public:
+		// default constructor, all elements set to zero
+		constexpr vecn();
+		// constructors with the elements specified directly (3 and 4 dimensional vectors)
+		constexpr vecn(T x, T y, T z);
+		constexpr vecn(T x, T y, T z, T w);
+		// function to return the number of dimensions
+		static constexpr int getNumDims();
+		// functions to handle elements of the vector
+		constexpr T getElement(int index) const;
+		constexpr void setElement(int index, T value);
+		constexpr T& operator[] (int index);
+		constexpr const T& operator[] (int index) const;
+		// function to return the length of the vector
+		T norm() const;
+		// function to return the squared length of the vector
+		constexpr T normSquared() const;
+		// function to return a normalized copy of the vector
+		vecn<T, N> normalized() const;
+		// function to normalize the vector in place
+		void normalize();
+		// overloaded operators
+		constexpr vecn<T, N> operator+ (const vecn<T, N>& rhs) const;
+		constexpr vecn<T, N> operator- (const vecn<T, N>& rhs) const;
+		constexpr vecn<T, N> operator- () const;
+		constexpr vecn<T, N> operator* (const T& rhs) const;
+		constexpr vecn<T, N>& operator+= (const vecn<T, N>& rhs);
+		constexpr vecn<T, N>& operator-= (const vecn<T, N>& rhs);
+		constexpr vecn<T, N>& operator*= (const T& rhs);
+		// friend function
+		template <class U, int M> friend constexpr vecn<U, M> operator* (const U& lhs, const vecn<U, M>& rhs);
+		// static functions
+		static constexpr T dot(const vecn<T, N>& a, const vecn<T, N>& b);
+		static constexpr vecn<T, N> cross(const vecn<T, N>& a, const vecn<T, N>& b);
+		// element-by-element product (used for combining colors)
+		static constexpr vecn<T, N> hadamard(const vecn<T, N>& a, const vecn<T, N>& b);
+		// function to return the reciprocal of each element (used for ray directions in slab tests)
+		constexpr vecn<T, N> reciprocal() const;
+		// function to build a vector from an array of N values of another scalar type (such as the doubles of a scene description)
+		template <class U>
+		static constexpr vecn<T, N> fromArray(const U* values);
+	private:
+		T m_data[N];
+};
+
+// the vector types used throughout the renderer
+typedef vecn<RT::real, 3> Vec3;
+typedef vecn<RT::real, 4> Vec4;
+
+// default constructor
+template <class T, int N>
+constexpr vecn<T, N>::vecn() : m_data{} {
+
+}
+
+// constructors with the elements specified directly
+template <class T, int N>
+constexpr vecn<T, N>::vecn(T x, T y, T z) : m_data{ x, y, z } {
+	static_assert(N == 3, "this constructor is only defined for three-dimensional vectors");
+}
+
+template <class T, int N>
+constexpr vecn<T, N>::vecn(T x, T y, T z, T w) : m_data{ x, y, z, w } {
+	static_assert(N == 4, "this constructor is only defined for four-dimensional vectors");
+}
+
+// function to return the number of dimensions
+template <class T, int N>
+constexpr int vecn<T, N>::getNumDims() {
+	return N;
+}
+
+// functions to handle elements of the vector
+// note: these are unchecked, the dimension is fixed at compile time
+template <class T, int N>
+constexpr T vecn<T, N>::getElement(int index) const {
+	return m_data[index];
+}
+
+template <class T, int N>
+constexpr void vecn<T, N>::setElement(int index, T value) {
+	m_data[index] = value;
+}
+
+template <class T, int N>
+constexpr T& vecn<T, N>::operator[] (int index) {
+	return m_data[index];
+}
+
+template <class T, int N>
+constexpr const T& vecn<T, N>::operator[] (int index) const {
+	return m_data[index];
+}
+
+// function to return the length of the vector (known as the 'norm')
+template <class T, int N>
+T vecn<T, N>::norm() const {
+	return sqrt(normSquared());
+}
+
+// function to return the squared length of the vector (avoids the square root when only comparing lengths)
+template <class T, int N>
+constexpr T vecn<T, N>::normSquared() const {
+	return dot(*this, *this);
+}
+
+// function to return a normalized copy of the vector
+template <class T, int N>
+vecn<T, N> vecn<T, N>::normalized() const {
+	vecn<T, N> result = *this;
+	result.normalize();
+	return result;
+}
+
+// function to normalize the vector in place
+template <class T, int N>
+void vecn<T, N>::normalize() {
+	// compute the reciprocal of the vector norm once and scale each element by it
+	T invNorm = static_cast<T>(1.0) / norm();
+	for (int i = 0; i < N; i++) m_data[i] *= invNorm;
+}
+
+// overloaded operators
+template <class T, int N>
+constexpr vecn<T, N> vecn<T, N>::operator+ (const vecn<T, N>& rhs) const {
+	vecn<T, N> result;
+	for (int i = 0; i < N; i++) result.m_data[i] = m_data[i] + rhs.m_data[i];
+	return result;
+}
+
+template <class T, int N>
+constexpr vecn<T, N> vecn<T, N>::operator- (const vecn<T, N>& rhs) const {
+	vecn<T, N> result;
+	for (int i = 0; i < N; i++) result.m_data[i] = m_data[i] - rhs.m_data[i];
+	return result;
+}
+
+template <class T, int N>
+constexpr vecn<T, N> vecn<T, N>::operator- () const {
+	vecn<T, N> result;
+	for (int i = 0; i < N; i++) result.m_data[i] = -m_data[i];
+	return result;
+}
+
+template <class T, int N>
+constexpr vecn<T, N> vecn<T, N>::operator* (const T& rhs) const {
+	// perform scalar multiplication
+	vecn<T, N> result;
+	for (int i = 0; i < N; i++) result.m_data[i] = m_data[i] * rhs;
+	return result;
+}
+
+template <class T, int N>
+constexpr vecn<T, N>& vecn<T, N>::operator+= (const vecn<T, N>& rhs) {
+	for (int i = 0; i < N; i++) m_data[i] += rhs.m_data[i];
+	return *this;
+}
+
+template <class T, int N>
+constexpr vecn<T, N>& vecn<T, N>::operator-= (const vecn<T, N>& rhs) {
+	for (int i = 0; i < N; i++) m_data[i] -= rhs.m_data[i];
+	return *this;
+}
+
+template <class T, int N>
+constexpr vecn<T, N>& vecn<T, N>::operator*= (const T& rhs) {
+	for (int i = 0; i < N; i++) m_data[i] *= rhs;
+	return *this;
+}
+
+// friend function
+template <class T, int N>
+constexpr vecn<T, N> operator* (const T& lhs, const vecn<T, N>& rhs) {
+	// perform scalar multiplication
+	vecn<T, N> result;
+	for (int i = 0; i < N; i++) result.m_data[i] = lhs * rhs.m_data[i];
+	return result;
+}
+
+// static functions
+template <class T, int N>
+constexpr T vecn<T, N>::dot(const vecn<T, N>& a, const vecn<T, N>& b) {
+	T cumulativeSum = static_cast<T>(0.0);
+	for (int i = 0; i < N; i++) cumulativeSum += a.m_data[i] * b.m_data[i];
+	return cumulativeSum;
+}
+
+template <class T, int N>
+constexpr vecn<T, N> vecn<T, N>::cross(const vecn<T, N>& a, const vecn<T, N>& b) {
+	// as with vector<T>, the cross product is only considered for three dimensions
+	static_assert(N == 3, "The cross product can only be computed for three-dimensional vectors.");
+	vecn<T, N> result;
+	result.m_data[0] = (a.m_data[1] * b.m_data[2]) - (a.m_data[2] * b.m_data[1]);
+	result.m_data[1] = -((a.m_data[0] * b.m_data[2]) - (a.m_data[2] * b.m_data[0]));
+	result.m_data[2] = (a.m_data[0] * b.m_data[1]) - (a.m_data[1] * b.m_data[0]);
+	return result;
+}
+
+template <class T, int N>
+constexpr vecn<T, N> vecn<T, N>::hadamard(const vecn<T, N>& a, const vecn<T, N>& b) {
+	vecn<T, N> result;
+	for (int i = 0; i < N; i++) result.m_data[i] = a.m_data[i] * b.m_data[i];
+	return result;
+}
+
+// function to return the reciprocal of each element
+template <class T, int N>
+constexpr vecn<T, N> vecn<T, N>::reciprocal() const {
+	vecn<T, N> result;
+	for (int i = 0; i < N; i++) result.m_data[i] = static_cast<T>(1) / m_data[i];
+	return result;
+}
+
+// function to build a vector from an array of another scalar type
+template <class T, int N>
+template <class U>
+constexpr vecn<T, N> vecn<T, N>::fromArray(const U* values) {
+	vecn<T, N> result;
+	for (int i = 0; i < N; i++) result.m_data[i] = static_cast<T>(values[i]);
+	return result;
+}
+
+#endif
@@ -0,0 +1,312 @@
+#include "wavefront.hpp"
+#include <algorithm>
+#include "image.hpp"
+#include "materialbase.hpp"
+#include "raypacket.hpp"
+#include "renderstats.hpp"
+
+// functions for the ray queue
+void RT::rayqueue::clear() {
+	m_point1X.clear();
+	m_point1Y.clear();
+	m_point1Z.clear();
+	m_point2X.clear();
+	m_point2Y.clear();
+	m_point2Z.clear();
+	m_pixel.clear();
+	m_parent.clear();
+	m_depth.clear();
+	m_throughput.clear();
+	m_skipObject.clear();
+}
+
+void RT::rayqueue::push(const RT::ray& newRay, int pixel, int parent, int depth, double throughput, const RT::objectbase* skipObject) {
+	m_point1X.push_back(newRay.m_point1[0]);
+	m_point1Y.push_back(newRay.m_point1[1]);
+	m_point1Z.push_back(newRay.m_point1[2]);
+	m_point2X.push_back(newRay.m_point2[0]);
+	m_point2Y.push_back(newRay.m_point2[1]);
+	m_point2Z.push_back(newRay.m_point2[2]);
+	m_pixel.push_back(pixel);
+	m_parent.push_back(parent);
+	m_depth.push_back(depth);
+	m_throughput.push_back(throughput);
+	m_skipObject.push_back(skipObject);
+}
+
+RT::ray RT::rayqueue::getRay(int i) const {
+	return RT::ray(Vec3{ m_point1X[i], m_point1Y[i], m_point1Z[i] }, Vec3{ m_point2X[i], m_point2Y[i], m_point2Z[i] });
+}
+
+int RT::rayqueue::size() const {
+	return static_cast<int>(m_pixel.size());
+}
+
+// functions for the hit queue
+void RT::hitqueue::clear() {
+	m_ray.clear();
+	m_object.clear();
+	m_pointX.clear();
+	m_pointY.clear();
+	m_pointZ.clear();
+	m_normalX.clear();
+	m_normalY.clear();
+	m_normalZ.clear();
+}
+
+void RT::hitqueue::push(int rayIndex, RT::objectbase* object, const Vec3& intPoint, const Vec3& localNormal) {
+	m_ray.push_back(rayIndex);
+	m_object.push_back(object);
+	m_pointX.push_back(intPoint[0]);
+	m_pointY.push_back(intPoint[1]);
+	m_pointZ.push_back(intPoint[2]);
+	m_normalX.push_back(localNormal[0]);
+	m_normalY.push_back(localNormal[1]);
+	m_normalZ.push_back(localNormal[2]);
+}
+
+Vec3 RT::hitqueue::getPoint(int i) const {
+	return Vec3{ m_pointX[i], m_pointY[i], m_pointZ[i] };
+}
+
+Vec3 RT::hitqueue::getNormal(int i) const {
+	return Vec3{ m_normalX[i], m_normalY[i], m_normalZ[i] };
+}
+
+int RT::hitqueue::size() const {
+	return static_cast<int>(m_ray.size());
+}
+
+// functions for the shadow queue
+void RT::shadowqueue::clear() {
+	m_point1X.clear();
+	m_point1Y.clear();
+	m_point1Z.clear();
+	m_point2X.clear();
+	m_point2Y.clear();
+	m_point2Z.clear();
+	m_vertex.clear();
+	m_term.clear();
+	m_skipHit.clear();
+	m_red.clear();
+	m_green.clear();
+	m_blue.clear();
+}
+
+void RT::shadowqueue::push(const RT::ray& lightRay, int vertex, shadowterm term, int skipHit, const Vec3& color) {
+	m_point1X.push_back(lightRay.m_point1[0]);
+	m_point1Y.push_back(lightRay.m_point1[1]);
+	m_point1Z.push_back(lightRay.m_point1[2]);
+	m_point2X.push_back(lightRay.m_point2[0]);
+	m_point2Y.push_back(lightRay.m_point2[1]);
+	m_point2Z.push_back(lightRay.m_point2[2]);
+	m_vertex.push_back(vertex);
+	m_term.push_back(term);
+	m_skipHit.push_back(skipHit);
+	m_red.push_back(color[0]);
+	m_green.push_back(color[1]);
+	m_blue.push_back(color[2]);
+}
+
+RT::ray RT::shadowqueue::getRay(int i) const {
+	return RT::ray(Vec3{ m_point1X[i], m_point1Y[i], m_point1Z[i] }, Vec3{ m_point2X[i], m_point2Y[i], m_point2Z[i] });
+}
+
+int RT::shadowqueue::size() const {
+	return static_cast<int>(m_vertex.size());
+}
+
+// constructor
+RT::wavefront::wavefront() {
+
+}
+
+// function to render a tile
+void RT::wavefront::renderTile(const RT::camera& sceneCamera, const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const RT::renderconfig& config, int x0, int y0, int x1, int y1, double xFact, double yFact, float* tileBuffer) {
+	m_vertices.clear();
+	generate(sceneCamera, x0, y0, x1, y1, xFact, yFact);
+	// each pass is one bounce, until no path has a ray left to follow
+	bool cameraRays = true;
+	while (m_rays.size() > 0) {
+		intersect(objectBVH, cameraRays);
+		shade(lightList, config);
+		shadow(objectBVH);
+		std::swap(m_rays, m_nextRays);
+		cameraRays = false;
+	}
+	combine(tileBuffer);
+}
+
+// function to queue a camera ray for each pixel of the tile
+void RT::wavefront::generate(const RT::camera& sceneCamera, int x0, int y0, int x1, int y1, double xFact, double yFact) {
+	m_rays.clear();
+	RT_STAT_ADD(STAT_CAMERA_RAYS, (x1 - x0) * (y1 - y0));
+	// the rays come out in the order of the pixels of the tile, so ray i belongs to pixel i
+	sceneCamera.generateRays(x0, y0, x1, y1, 1, xFact, yFact, nullptr, m_cameraRays);
+	for (int i = 0; i < m_cameraRays.size(); i++) m_rays.push(m_cameraRays.getRay(i), i, -1, 0, 1.0, nullptr);
+}
+
+// function to find the closest hit of every queued ray
+void RT::wavefront::intersect(const RT::bvh& objectBVH, bool cameraRays) {
+	RT_STAT_PHASE(PHASE_TRACE);
+	m_hits.clear();
+	int numRays = m_rays.size();
+	Vec3 closestIntPoint;
+	Vec3 closestLocalNormal;
+	Vec3 closestLocalColor;
+	if (cameraRays) {
+		// camera rays don't leave from an object, so they go through the packet kernels straight from the queue
+		const std::vector<std::shared_ptr<RT::objectbase>>& objectList = objectBVH.getObjectList();
+		RT::raypacket rays;
+		RT::packethit hits;
+		for (int first = 0; first < numRays; first += RT::PACKET_SIZE) {
+			int count = std::min(RT::PACKET_SIZE, numRays - first);
+			// unused lanes repeat the first ray
+			for (int lane = 0; lane < RT::PACKET_SIZE; lane++) {
+				int i = first + ((lane < count) ? lane : 0);
+				rays.m_originX[lane] = m_rays.m_point1X[i];
+				rays.m_originY[lane] = m_rays.m_point1Y[i];
+				rays.m_originZ[lane] = m_rays.m_point1Z[i];
+				rays.m_dirX[lane] = m_rays.m_point2X[i] - m_rays.m_point1X[i];
+				rays.m_dirY[lane] = m_rays.m_point2Y[i] - m_rays.m_point1Y[i];
+				rays.m_dirZ[lane] = m_rays.m_point2Z[i] - m_rays.m_point1Z[i];
+				rays.m_invDirX[lane] = 1.0 / rays.m_dirX[lane];
+				rays.m_invDirY[lane] = 1.0 / rays.m_dirY[lane];
+				rays.m_invDirZ[lane] = 1.0 / rays.m_dirZ[lane];
+			}
+			rays.m_numRays = count;
+			int hitMask = objectBVH.castPacket(rays, hits);
+			// compute the intersection details for the closest object only
+			for (int lane = 0; lane < count; lane++) {
+				if (!(hitMask & (1 << lane))) continue;
+				RT::ray cameraRay = m_rays.getRay(first + lane);
+				int closestIndex = hits.m_index[lane];
+				if (!objectList[closestIndex]->testIntersections(cameraRay, closestIntPoint, closestLocalNormal, closestLocalColor)) {
+					// the packet and scalar tests can disagree for rays that only graze an object, let the scalar path decide those
+					closestIndex = objectBVH.castRay(cameraRay, nullptr, closestIntPoint, closestLocalNormal, closestLocalColor);
+					if (closestIndex < 0) continue;
+				}
+				m_hits.push(first + lane, objectList[closestIndex].get(), closestIntPoint, closestLocalNormal);
+			}
+		}
+	}
+	else {
+		// reflection rays skip the object they leave from, if they can't hit it again
+		for (int i = 0; i < numRays; i++) {
+			int closestIndex = objectBVH.castRay(m_rays.getRay(i), m_rays.m_skipObject[i], closestIntPoint, closestLocalNormal, closestLocalColor);
+			if (closestIndex >= 0) m_hits.push(i, objectBVH.getObjectList()[closestIndex].get(), closestIntPoint, closestLocalNormal);
+		}
+	}
+}
+
+// function to start the shading of every hit, queueing its shadow rays and reflection ray
+void RT::wavefront::shade(const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const RT::renderconfig& config) {
+	RT_STAT_PHASE(PHASE_SHADE);
+	m_nextRays.clear();
+	m_shadows.clear();
+	int numHits = m_hits.size();
+	for (int h = 0; h < numHits; h++) {
+		int rayIndex = m_hits.m_ray[h];
+		const RT::objectbase* currentObject = m_hits.m_object[h];
+		Vec3 intPoint = m_hits.getPoint(h);
+		Vec3 localNormal = m_hits.getNormal(h);
+		RT::ray incidentRay = m_rays.getRay(rayIndex);
+		// objects without a material are only lit diffusely, in their own color
+		RT::pathvertex vertex;
+		vertex.m_parent = m_rays.m_parent[rayIndex];
+		vertex.m_pixel = m_rays.m_pixel[rayIndex];
+		vertex.m_illumFound = false;
+		RT::shadingterms terms;
+		if (currentObject->m_hasMaterial) {
+			vertex.m_pMaterial = currentObject->m_pMaterial.get();
+			terms = vertex.m_pMaterial->getShadingTerms();
+		}
+		else {
+			vertex.m_pMaterial = nullptr;
+			terms.m_diffuse = true;
+			terms.m_baseColor = currentObject->m_baseColor;
+		}
+		vertex.m_baseColor = terms.m_baseColor;
+		int vertexIndex = static_cast<int>(m_vertices.size());
+		m_vertices.push_back(vertex);
+		// a shadow ray for each light that would light the point (see materialbase::computeDiffuseColor)
+		if (terms.m_diffuse) {
+			for (const std::shared_ptr<RT::lightbase>& currentLight : lightList) {
+				RT::ray lightRay;
+				Vec3 color;
+				RT::real intensity;
+				if (!currentLight->computeUnshadowedIllumination(intPoint, localNormal, lightRay, color, intensity)) continue;
+				lightRay = RT::ray(currentObject->getRayOrigin(intPoint, localNormal, lightRay.m_lab), lightRay.m_point2);
+				m_shadows.push(lightRay, vertexIndex, RT::shadowqueue::SHADOW_DIFFUSE, h, Vec3{ color.getElement(0) * intensity, color.getElement(1) * intensity, color.getElement(2) * intensity });
+			}
+		}
+		// and for each light that would give a highlight (see simplematerial::computeSpecular)
+		if (terms.m_specular) {
+			for (const std::shared_ptr<RT::lightbase>& currentLight : lightList) {
+				RT::ray lightRay;
+				RT::real intensity = vertex.m_pMaterial->computeSpecularIntensity(*currentLight, intPoint, localNormal, incidentRay, lightRay);
+				if (intensity == 0.0) continue;
+				m_shadows.push(lightRay, vertexIndex, RT::shadowqueue::SHADOW_SPECULAR, -1, Vec3{ currentLight->m_color.getElement(0) * intensity, currentLight->m_color.getElement(1) * intensity, currentLight->m_color.getElement(2) * intensity });
+			}
+		}
+		// the reflection ray, if the path is still worth following (see materialbase::computeReflectionColor)
+		if (terms.m_reflectivity > 0.0) {
+			RT::pathstate pathState;
+			pathState.m_depth = m_rays.m_depth[rayIndex];
+			pathState.m_maxDepth = config.m_maxDepth;
+			pathState.m_throughput = m_rays.m_throughput[rayIndex];
+			pathState.m_minThroughput = config.m_minThroughput;
+			RT::pathstate reflectedPath = pathState.bounce(terms.m_reflectivity);
+			if (reflectedPath.isAlive()) {
+				RT_STAT_COUNT(STAT_REFLECTION_RAYS);
+				Vec3 d = incidentRay.m_lab;
+				Vec3 reflectionVector = d - (2 * Vec3::dot(d, localNormal) * localNormal);
+				Vec3 reflectionOrigin = currentObject->getRayOrigin(intPoint, localNormal, reflectionVector);
+				m_nextRays.push(RT::ray(reflectionOrigin, reflectionOrigin + reflectionVector), vertex.m_pixel, vertexIndex, reflectedPath.m_depth, reflectedPath.m_throughput, currentObject);
+			}
+		}
+	}
+}
+
+// function to trace the queued shadow rays, adding the light of those that aren't blocked to their vertex
+void RT::wavefront::shadow(const RT::bvh& objectBVH) {
+	RT_STAT_PHASE(PHASE_TRACE);
+	int numShadows = m_shadows.size();
+	RT_STAT_ADD(STAT_SHADOW_RAYS, numShadows);
+	// the rays of each vertex are in the order of the lights, so the light adds up in the same order as in the recursive integrator
+	for (int i = 0; i < numShadows; i++) {
+		int skipHit = m_shadows.m_skipHit[i];
+		if (objectBVH.occluded(m_shadows.getRay(i), 1.0, (skipHit >= 0) ? m_hits.m_object[skipHit] : nullptr)) continue;
+		RT::pathvertex& vertex = m_vertices[m_shadows.m_vertex[i]];
+		Vec3 color{ m_shadows.m_red[i], m_shadows.m_green[i], m_shadows.m_blue[i] };
+		if (m_shadows.m_term[i] == RT::shadowqueue::SHADOW_DIFFUSE) {
+			vertex.m_illumFound = true;
+			vertex.m_lightSum += color;
+		}
+		else vertex.m_spcColor += color;
+	}
+}
+
+// function to combine the parts of every vertex's color, from the deepest bounce up, and write the pixels
+void RT::wavefront::combine(float* tileBuffer) {
+	RT_STAT_PHASE(PHASE_SHADE);
+	// a reflection's vertex always comes after the vertex it leaves from
+	for (int v = static_cast<int>(m_vertices.size()) - 1; v >= 0; v--) {
+		const RT::pathvertex& vertex = m_vertices[v];
+		Vec3 matColor;
+		if (vertex.m_illumFound) {
+			matColor.setElement(0, vertex.m_lightSum.getElement(0) * vertex.m_baseColor.getElement(0));
+			matColor.setElement(1, vertex.m_lightSum.getElement(1) * vertex.m_baseColor.getElement(1));
+			matColor.setElement(2, vertex.m_lightSum.getElement(2) * vertex.m_baseColor.getElement(2));
+		}
+		if (vertex.m_pMaterial != nullptr) matColor = vertex.m_pMaterial->combineColor(matColor, vertex.m_refColor, vertex.m_spcColor);
+		if (vertex.m_parent >= 0) {
+			m_vertices[vertex.m_parent].m_refColor = matColor;
+			continue;
+		}
+		float* pPixel = tileBuffer + (vertex.m_pixel * image::NUM_CHANNELS);
+		pPixel[0] = static_cast<float>(matColor.getElement(0));
+		pPixel[1] = static_cast<float>(matColor.getElement(1));
+		pPixel[2] = static_cast<float>(matColor.getElement(2));
+	}
+}
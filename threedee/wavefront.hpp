@@ -0,0 +1,118 @@
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+#include <memory>
+#include <vector>
+#include "vecn.hpp"
+#include "camera.hpp"
+#include "bvh.hpp"
+#include "lightbase.hpp"
+#include "renderconfig.hpp"
+
+namespace RT {
+	// rays waiting to be intersected with the scene, stored as a structure of arrays
+	// each ray runs from point 1 to point 2 like RT::ray, and carries the path it belongs to
+	struct rayqueue {
+		// function to empty the queue (keeping its storage)
+		void clear();
+		// function to add a ray, parent is the vertex whose reflection it is (-1 for a camera ray)
+		void push(const RT::ray& newRay, int pixel, int parent, int depth, double throughput, const RT::objectbase* skipObject);
+		// function to return ray i
+		RT::ray getRay(int i) const;
+		int size() const;
+		// variables
+		std::vector<real> m_point1X, m_point1Y, m_point1Z;
+		std::vector<real> m_point2X, m_point2Y, m_point2Z;
+		std::vector<int> m_pixel;
+		std::vector<int> m_parent;
+		std::vector<int> m_depth;
+		std::vector<double> m_throughput;
+		// the object the ray leaves from, which it may not be able to hit (null for camera rays)
+		// plain pointers (the scene owns the objects for as long as the tile is rendered), so queueing a ray doesn't touch a reference count
+		std::vector<const RT::objectbase*> m_skipObject;
+	};
+
+	// the closest hit found for each ray that hit something, stored as a structure of arrays
+	struct hitqueue {
+		// function to empty the queue (keeping its storage)
+		void clear();
+		// function to add the hit of ray rayIndex (in the ray queue)
+		void push(int rayIndex, RT::objectbase* object, const Vec3& intPoint, const Vec3& localNormal);
+		// functions to return the point and normal of hit i
+		Vec3 getPoint(int i) const;
+		Vec3 getNormal(int i) const;
+		int size() const;
+		// variables
+		std::vector<int> m_ray;
+		std::vector<RT::objectbase*> m_object; // owned by the scene, as for rayqueue::m_skipObject
+		std::vector<real> m_pointX, m_pointY, m_pointZ;
+		std::vector<real> m_normalX, m_normalY, m_normalZ;
+	};
+
+	// shadow rays, each one bringing a contribution to a vertex if nothing blocks it before point 2
+	struct shadowqueue {
+		// the part of the vertex's color that a shadow ray contributes to
+		enum shadowterm { SHADOW_DIFFUSE = 0, SHADOW_SPECULAR = 1 };
+		// function to empty the queue (keeping its storage)
+		void clear();
+		// function to add a shadow ray that brings color to the given term of a vertex
+		void push(const RT::ray& lightRay, int vertex, shadowterm term, int skipHit, const Vec3& color);
+		// function to return ray i
+		RT::ray getRay(int i) const;
+		int size() const;
+		// variables
+		std::vector<real> m_point1X, m_point1Y, m_point1Z;
+		std::vector<real> m_point2X, m_point2Y, m_point2Z;
+		std::vector<int> m_vertex;
+		std::vector<int> m_term;
+		// the hit the ray leaves from, whose object it can't hit (-1 if it can hit anything)
+		std::vector<int> m_skipHit;
+		std::vector<real> m_red, m_green, m_blue;
+	};
+
+	// a point where a path hit the scene, holding the parts of its color until they are combined
+	struct pathvertex {
+		// the vertex whose reflection this is (-1 for the hit of a camera ray), and the pixel in the tile
+		int m_parent;
+		int m_pixel;
+		// the material of the object hit (null for objects without one, which are only lit diffusely)
+		const RT::materialbase* m_pMaterial;
+		Vec3 m_baseColor;
+		// the light arriving from the lights that aren't blocked
+		bool m_illumFound;
+		Vec3 m_lightSum;
+		Vec3 m_spcColor;
+		// the color arriving along the reflection ray
+		Vec3 m_refColor;
+	};
+
+	// breadth-first evaluation of the camera rays of a tile
+	// rather than following each path to its end before starting the next, every ray of a bounce goes through one stage at a time:
+	// generate (camera rays), intersect, shade (which queues shadow and reflection rays), shadow, and then the next bounce
+	// the parts of each vertex's color are combined from the deepest bounce up, in the same order as the recursive computeColor,
+	// so the image is exactly the same as the recursive integrator's
+	// the queues are kept from one tile to the next, so their memory is allocated once for the tile size
+	class wavefront {
+		public:
+			// constructor
+			wavefront();
+			// function to render the pixels [x0, x1) x [y0, y1) into tileBuffer (image::NUM_CHANNELS floats per pixel, pixels that see nothing are left alone)
+			void renderTile(const RT::camera& sceneCamera, const RT::bvh& objectBVH, const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const RT::renderconfig& config, int x0, int y0, int x1, int y1, double xFact, double yFact, float* tileBuffer);
+		private:
+			// the stages
+			void generate(const RT::camera& sceneCamera, int x0, int y0, int x1, int y1, double xFact, double yFact);
+			void intersect(const RT::bvh& objectBVH, bool cameraRays);
+			void shade(const std::vector<std::shared_ptr<RT::lightbase>>& lightList, const RT::renderconfig& config);
+			void shadow(const RT::bvh& objectBVH);
+			void combine(float* tileBuffer);
+			// the rays of the current and the next bounce
+			RT::rayqueue m_rays;
+			RT::rayqueue m_nextRays;
+			RT::hitqueue m_hits;
+			RT::shadowqueue m_shadows;
+			std::vector<RT::pathvertex> m_vertices;
+			// the camera rays of the tile
+			RT::camerarays m_cameraRays;
+	};
+}
+
+#endif